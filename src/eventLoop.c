@@ -0,0 +1,598 @@
+/**
+ * @file eventLoop.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of Event Loop, single threaded alternative to
+ * main/sender/receiver threads
+ *
+ * Messages are processed by the same functions as in threaded variant,
+ * however nothing has to wait on conditional variables, event loop only
+ * waits for next event on epoll.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+// sigprocmask(), CLOCK_REALTIME, u_int8_t
+#define _DEFAULT_SOURCE
+
+#include "errno.h"
+#include "signal.h"
+#include "sys/epoll.h"
+#include "sys/timerfd.h"
+#include "sys/signalfd.h"
+
+#include "eventLoop.h"
+#include "sessionGroup.h"
+#include "protocolReceiver.h"
+#include "protocolSender.h"
+
+/**
+ * @brief Adds file descriptor to the epoll interest list
+ *
+ * @param loop Pointer to the event loop
+ * @param fd File descriptor to be watched
+ * @param source Identification of file descriptor
+ * @return int Return value of epoll_ctl()
+ */
+int eventLoopWatch(EventLoop* loop, int fd, evt_t source)
+{
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = EVENT_DATA(loop->sessionId, source);
+
+    return epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, fd, &event);
+}
+
+/**
+ * @brief Creates event loop, blocks SIGINT so it is only received through
+ * signalfd and stores event loop in program interface
+ *
+ * @param progInt Pointer to the program interface
+ * @return EventLoop* Created event loop
+ */
+EventLoop* eventLoopInit(ProgramInterface* progInt)
+{
+    EventLoop* loop = (EventLoop*) malloc(sizeof(EventLoop));
+    if(loop == NULL)
+    {
+        errHandling("Failed to allocate memory for EventLoop", err_MEMORY_FAIL);
+    }
+
+    loop->stdinPolled = true;
+    loop->stdinWatched = true;
+    loop->stdinEof = false;
+    loop->stdinProcessed = 0;
+    bufferInit(&(loop->stdinPending));
+    bufferResize(&(loop->stdinPending), STDIN_READ_SIZE);
+    loop->group = NULL;
+    loop->sessionId = 0;
+    loop->waitingForConfirm = false;
+
+    // SIGINT will be received as event instead of interrupting program
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    if(sigprocmask(SIG_BLOCK, &mask, NULL) != 0)
+    {
+        errHandling("sigprocmask() failed", err_NETWORK_INIT);
+    }
+
+    loop->epollFd = epoll_create1(0);
+    loop->timerFd = timerfd_create(CLOCK_REALTIME, 0);
+    loop->signalFd = signalfd(-1, &mask, 0);
+    progInt->cleanUp->eventLoop = loop;
+
+    if(loop->epollFd < 0 || loop->timerFd < 0 || loop->signalFd < 0)
+    {
+        errHandling("Failed to create event loop file descriptors", err_NETWORK_INIT);
+    }
+
+    // session group has no socket of its own, sockets of sessions are
+    // watched by eventLoopInitSession()
+    if( (progInt->netConfig->openedSocket >= 0 &&
+        eventLoopWatch(loop, progInt->netConfig->openedSocket, evt_SOCKET) != 0) ||
+        eventLoopWatch(loop, loop->timerFd, evt_TIMER) != 0 ||
+        eventLoopWatch(loop, loop->signalFd, evt_SIGNAL) != 0)
+    {
+        errHandling("epoll_ctl() failed", err_NETWORK_INIT);
+    }
+
+    if(eventLoopWatch(loop, STDIN_FILENO, evt_STDIN) != 0)
+    {
+        // regular files cannot be watched by epoll, they are always readable
+        if(errno != EPERM)
+        {
+            errHandling("epoll_ctl() failed for stdin", err_NETWORK_INIT);
+        }
+        loop->stdinPolled = false;
+        loop->stdinWatched = false;
+    }
+
+    // set max size messages from server
+    bufferResize(&(progInt->cleanUp->serverResponse), MAX_SERVER_MESSAGE_LEN);
+
+    // all datagrams waiting on socket are received at once
+    if(progInt->netConfig->protocol == prot_UDP)
+    {
+        progInt->cleanUp->recvBatch = datagramBatchCreate();
+    }
+
+    return loop;
+}
+
+/**
+ * @brief Creates event loop of one session in session group, session uses
+ * descriptors of the group and only its socket is added to group epoll
+ *
+ * @param progInt Pointer to the program interface of session
+ * @param group Pointer to the session group
+ * @param control Event loop of group holding shared descriptors
+ * @param sessionId Index of session in group
+ * @return EventLoop* Created event loop
+ */
+EventLoop* eventLoopInitSession(ProgramInterface* progInt, struct SessionGroup* group,
+    EventLoop* control, size_t sessionId)
+{
+    EventLoop* loop = (EventLoop*) malloc(sizeof(EventLoop));
+    if(loop == NULL)
+    {
+        errHandling("Failed to allocate memory for EventLoop", err_MEMORY_FAIL);
+    }
+
+    loop->epollFd = control->epollFd;
+    loop->timerFd = control->timerFd;
+    loop->signalFd = control->signalFd;
+    // input of session is filled by group
+    loop->stdinPolled = false;
+    loop->stdinWatched = false;
+    loop->stdinEof = false;
+    loop->stdinProcessed = 0;
+    bufferInit(&(loop->stdinPending));
+    loop->group = group;
+    loop->sessionId = sessionId;
+    loop->waitingForConfirm = false;
+    progInt->cleanUp->eventLoop = loop;
+
+    if(eventLoopWatch(loop, progInt->netConfig->openedSocket, evt_SOCKET) != 0)
+    {
+        errHandling("epoll_ctl() failed", err_NETWORK_INIT);
+    }
+
+    // set max size messages from server
+    bufferResize(&(progInt->cleanUp->serverResponse), MAX_SERVER_MESSAGE_LEN);
+
+    return loop;
+}
+
+/**
+ * @brief Closes file descriptors and frees event loop
+ *
+ * @param loop Pointer to the event loop
+ */
+void eventLoopDestroy(EventLoop* loop)
+{
+    // descriptors of session are owned by group
+    if(loop->group == NULL)
+    {
+        close(loop->epollFd);
+        close(loop->timerFd);
+        close(loop->signalFd);
+    }
+    bufferDestroy(&(loop->stdinPending));
+    free(loop);
+}
+
+// ----------------------------------------------------------------------------
+// User input
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Returns true if next user input can be processed, this replaces
+ * waiting of main thread for message to be processed/confirmed
+ *
+ * @param progInt Pointer to the program interface
+ */
+bool eventLoopInputAllowed(ProgramInterface* progInt)
+{
+    fsm_t state = getProgramState(progInt);
+    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
+
+    // pipelined input waits only for room in pipeline
+    uint16_t pipelineDepth = progInt->netConfig->pipelineDepth;
+    if(pipelineDepth > 0)
+    {
+        if(state >= fsm_EMPTY_Q_BYE) { return false; }
+
+        queueLock(sendingQueue);
+        bool hasRoom = queuePendingLength(sendingQueue) < pipelineDepth;
+        queueUnlock(sendingQueue);
+        return hasRoom;
+    }
+
+    if(state != fsm_START && state != fsm_OPEN) { return false; }
+
+    queueLock(sendingQueue);
+
+    // state changing message was not processed yet
+    bool allowed = true;
+    for(Message* msg = queueGetMessage(sendingQueue); msg != NULL; msg = msg->behindMe)
+    {
+        if(isBarrierMessage(msg)) { allowed = false; break; }
+    }
+
+    // there must be room in the sending window for next message
+    UDP_VARIANT
+        if(queueLength(sendingQueue) >= progInt->netConfig->udpWindow) { allowed = false; }
+    TCP_VARIANT
+        if(!queueIsEmpty(sendingQueue)) { allowed = false; }
+    END_VARIANTS
+
+    queueUnlock(sendingQueue);
+    return allowed;
+}
+
+/**
+ * @brief Moves unprocessed user input to the start of buffer and makes sure
+ * there is space for atleast len more bytes
+ *
+ * @param loop Pointer to the event loop
+ * @param len Number of bytes that will be added
+ */
+void eventLoopReserveInput(EventLoop* loop, size_t len)
+{
+    Buffer* pending = &(loop->stdinPending);
+
+    // move unprocessed bytes to the start of buffer
+    size_t unprocessed = pending->used - loop->stdinProcessed;
+    if(loop->stdinProcessed > 0)
+    {
+        memmove(pending->data, pending->data + loop->stdinProcessed, unprocessed);
+    }
+    pending->used = unprocessed;
+    loop->stdinProcessed = 0;
+
+    size_t newSize = (pending->allocated > 0) ? pending->allocated : INITIAL_BUFFER_SIZE;
+    while(newSize - pending->used < len) { newSize *= 2; }
+    if(newSize != pending->allocated)
+    {
+        bufferResize(pending, newSize);
+    }
+}
+
+/**
+ * @brief Appends bytes to pending user input of event loop
+ *
+ * @param loop Pointer to the event loop
+ * @param data Bytes to be appended
+ * @param len Number of bytes
+ */
+void eventLoopAppendInput(EventLoop* loop, const char* data, size_t len)
+{
+    Buffer* pending = &(loop->stdinPending);
+    eventLoopReserveInput(loop, len);
+
+    memcpy(pending->data + pending->used, data, len);
+    pending->used += len;
+}
+
+/**
+ * @brief Reads available bytes from stdin into pending user input
+ *
+ * @param loop Pointer to the event loop
+ */
+void eventLoopReadStdin(EventLoop* loop)
+{
+    Buffer* pending = &(loop->stdinPending);
+    eventLoopReserveInput(loop, STDIN_READ_SIZE);
+
+    ssize_t bytesRead = read(STDIN_FILENO, pending->data + pending->used,
+        pending->allocated - pending->used);
+
+    if(bytesRead > 0)
+    {
+        pending->used += bytesRead;
+    }
+    else if(bytesRead == 0 || (errno != EINTR && errno != EAGAIN))
+    {
+        loop->stdinEof = true;
+    }
+}
+
+/**
+ * @brief Takes one line of pending user input in same format as 
+ * loadBufferFromStdin() does. Last line doesn't have to be ended with new
+ * line if stdin was closed.
+ *
+ * @warning Line points into pending user input, it is valid only until
+ * more input is read or appended
+ *
+ * @param loop Pointer to the event loop
+ * @param clientInput Output line
+ * @return true Line was found
+ * @return false There is no complete line in pending input
+ */
+bool eventLoopGetLine(EventLoop* loop, Buffer* clientInput)
+{
+    return bufferTakeLine(&(loop->stdinPending), &(loop->stdinProcessed),
+        loop->stdinEof, clientInput);
+}
+
+// ----------------------------------------------------------------------------
+// Sending, receiving and signals
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Sends messages that are allowed by current state of program,
+ * resends unconfirmed ones and sets retransmission timer to the nearest
+ * retransmission
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopSend(ProgramInterface* progInt)
+{
+    EventLoop* loop = progInt->cleanUp->eventLoop;
+    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
+
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    bool waitingForConfirm = false;
+
+    queueLock(sendingQueue);
+
+    // confirms of received messages go first, before any resending
+    sendControlMessages(sendingQueue, progInt);
+
+    UDP_VARIANT
+        // if BYE was not confirmed and popped, program state was changed
+        // to END, there is nothing more to send
+        if(filterResentMessages(sendingQueue, progInt))
+        {
+            flushSendedMessages(progInt);
+            queueUnlock(sendingQueue);
+            return;
+        }
+    END_VARIANTS
+
+    fillSendingWindow(sendingQueue, progInt);
+    flushSendedMessages(progInt);
+
+    // if queue is empty and state is empty queue and bye, end
+    fsm_t state = getProgramState(progInt);
+    if(queueIsEmpty(sendingQueue) && (state == fsm_EMPTY_Q_BYE || state == fsm_SIGINT_BYE))
+    {
+        setProgramState(progInt, fsm_END);
+    }
+
+    UDP_VARIANT
+        waitingForConfirm = getNearestRetransmit(sendingQueue, &(timer.it_value));
+    END_VARIANTS
+
+    queueUnlock(sendingQueue);
+
+    loop->waitingForConfirm = waitingForConfirm;
+    loop->retransmitAt = timer.it_value;
+
+    if(loop->group != NULL)
+    {
+        // timer is shared by all sessions in group
+        sessionGroupScheduleRetransmit(loop->group, loop);
+        return;
+    }
+
+    // zero value disarms timer
+    timerfd_settime(loop->timerFd, TFD_TIMER_ABSTIME, &timer, NULL);
+}
+
+/**
+ * @brief Receives message(s) from server that are ready on socket
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopReceive(ProgramInterface* progInt)
+{
+    ProtocolBlocks pBlocks;
+    ssize_t bytesRx;
+
+    UDP_VARIANT
+        bytesRx = receiveDatagramUDP(progInt, &pBlocks,
+            progInt->cleanUp->confirmedMessages,
+            &(progInt->cleanUp->protocolToSendedByReceiver));
+    TCP_VARIANT
+        bytesRx = receiveStreamTCP(progInt, &pBlocks,
+            progInt->cleanUp->confirmedMessages,
+            &(progInt->cleanUp->protocolToSendedByReceiver));
+        // level triggered epoll would keep reporting closed socket (reset 
+        // connection is reported as closed by next read), only this session 
+        // ends, other sessions in group keep running
+        if(bytesRx == 0)
+        {
+            serverClosedConnection(progInt);
+        }
+    END_VARIANTS
+}
+
+/**
+ * @brief Empties sending queue and sends BYE, program ends after BYE is
+ * sended (and confirmed in UDP)
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopSigintBye(ProgramInterface* progInt)
+{
+    // second SIGINT while bye is being sended is ignored
+    if(getProgramState(progInt) >= fsm_SIGINT_BYE) { return; }
+
+    // set program state to SIGINT_BYE, no more input will be processed
+    setProgramState(progInt, fsm_SIGINT_BYE);
+
+    queueLock(progInt->threads->sendingQueue);
+    queuePopAllMessages(progInt->threads->sendingQueue);
+    queueUnlock(progInt->threads->sendingQueue);
+
+    // send bye to the server
+    sendBye(progInt);
+}
+
+/**
+ * @brief Handles SIGINT received through signalfd same way as sigintHandler()
+ * does, however waiting for BYE to be sended is done by event loop
+ *
+ * @param progInt Pointer to the program interface
+ * @param loop Pointer to the event loop
+ */
+void eventLoopSigint(ProgramInterface* progInt, EventLoop* loop)
+{
+    struct signalfd_siginfo info;
+    if(read(loop->signalFd, &info, sizeof(info)) != sizeof(info)) { return; }
+
+    eventLoopSigintBye(progInt);
+}
+
+// ----------------------------------------------------------------------------
+// Event loop
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Waits for events and handles them
+ *
+ * @param progInt Pointer to the program interface
+ * @param loop Pointer to the event loop
+ * @param wantsInput Whenever user input should be read
+ */
+void eventLoopDispatch(ProgramInterface* progInt, EventLoop* loop, bool wantsInput)
+{
+    // add/remove stdin from interest list, so level triggered epoll
+    // doesn't wake up loop when input cannot be processed
+    if(loop->stdinPolled && loop->stdinWatched != wantsInput)
+    {
+        struct epoll_event event;
+        event.events = wantsInput ? EPOLLIN : 0;
+        event.data.u64 = EVENT_DATA(loop->sessionId, evt_STDIN);
+        epoll_ctl(loop->epollFd, EPOLL_CTL_MOD, STDIN_FILENO, &event);
+        loop->stdinWatched = wantsInput;
+    }
+
+    // regular file on stdin is always readable, only check other events
+    int timeout = (wantsInput && !loop->stdinPolled) ? 0 : -1;
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int eventsCount = epoll_wait(loop->epollFd, events, MAX_EPOLL_EVENTS, timeout);
+    if(eventsCount < 0 && errno != EINTR)
+    {
+        errHandling("epoll_wait() failed", err_COMMUNICATION);
+    }
+
+    for(int i = 0; i < eventsCount; i++)
+    {
+        switch(EVENT_SOURCE(events[i].data.u64))
+        {
+        case evt_STDIN:
+            eventLoopReadStdin(loop);
+            break;
+        case evt_SOCKET:
+            eventLoopReceive(progInt);
+            break;
+        case evt_TIMER:;
+            uint64_t expirations;
+            if(read(loop->timerFd, &expirations, sizeof(expirations)) < 0) {}
+            break;
+        case evt_SIGNAL:
+            eventLoopSigint(progInt, loop);
+            break;
+        }
+    }
+
+    if(wantsInput && !loop->stdinPolled)
+    {
+        eventLoopReadStdin(loop);
+    }
+
+    // react to changes made by received messages, timeouts and signals
+    eventLoopSend(progInt);
+}
+
+/**
+ * @brief Processes pending user input for as long as it is allowed by
+ * current state of program
+ *
+ * @param progInt Pointer to the program interface
+ * @param loop Pointer to the event loop
+ */
+void eventLoopHandleInput(ProgramInterface* progInt, EventLoop* loop)
+{
+    Buffer clientInput;
+    ProtocolBlocks pBlocks;
+
+    while(eventLoopInputAllowed(progInt))
+    {
+        if(eventLoopGetLine(loop, &clientInput))
+        {
+            if(queueUserInput(progInt, &clientInput, &pBlocks))
+            {
+                eventLoopSend(progInt);
+            }
+            else if(pBlocks.type == cmd_EXIT)
+            {
+                // pipelined input was ended by /exit, rest of input is ignored
+                loop->stdinEof = true;
+                loop->stdinProcessed = loop->stdinPending.used;
+            }
+        }
+        else
+        {
+            // all input was processed, send bye and exit after messages 
+            // queued by pipelined input
+            if(loop->stdinEof && isPipelineDrained(progInt))
+            {
+                setProgramState(progInt, fsm_EMPTY_Q_BYE);
+                sendBye(progInt);
+                eventLoopSend(progInt);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Runs whole communication in current thread until program
+ * reaches END state
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopRun(ProgramInterface* progInt)
+{
+    EventLoop* loop = eventLoopInit(progInt);
+
+    while(getProgramState(progInt) != fsm_END)
+    {
+        eventLoopHandleInput(progInt, loop);
+        if(getProgramState(progInt) == fsm_END) { break; }
+
+        bool wantsInput = !loop->stdinEof && eventLoopInputAllowed(progInt);
+        eventLoopDispatch(progInt, loop, wantsInput);
+    }
+
+    debugPrint(stdout, "DEBUG: Event loop ended\n");
+}
+
+/**
+ * @brief Processes only server messages and timeouts until program reaches
+ * END state, used for sending last messages (ERR, BYE) before exiting
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopDrain(ProgramInterface* progInt)
+{
+    EventLoop* loop = progInt->cleanUp->eventLoop;
+
+    eventLoopSend(progInt);
+
+    // epoll of group reports events of other sessions as well, messages
+    // that were already sended are all that can be done
+    if(loop->group != NULL) { return; }
+
+    while(getProgramState(progInt) != fsm_END)
+    {
+        eventLoopDispatch(progInt, loop, false);
+    }
+}
@@ -0,0 +1,203 @@
+/**
+ * @file eventLoop.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Header file for Event Loop, single threaded alternative to
+ * main/sender/receiver threads
+ *
+ * Event Loop waits on one epoll instance for user input (stdin), server
+ * messages (socket), retransmission timeouts (timerfd) and SIGINT
+ * (signalfd) and drives the same FSM as threads do.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H 1
+
+#include "libs/ipk24protocol.h"
+
+// number of bytes read from stdin at once
+#define STDIN_READ_SIZE 4096
+// maximal number of events returned by one epoll wait
+#define MAX_EPOLL_EVENTS 8
+
+// epoll event data holds index of session and source of event
+#define EVENT_DATA(session, source) (((uint64_t) (session) << 32) | (source))
+#define EVENT_SESSION(data) ((size_t) ((data) >> 32))
+#define EVENT_SOURCE(data) ((evt_t) ((data) & 0xFFFFFFFF))
+
+/**
+ * @brief Identification of file descriptor that invoked epoll event
+ */
+typedef enum EventSource {
+    evt_STDIN,
+    evt_SOCKET,
+    evt_TIMER,
+    evt_SIGNAL,
+} evt_t;
+
+/**
+ * @brief Structure holding file descriptors watched by event loop and
+ * user input that was read but not processed yet
+ */
+typedef struct EventLoop {
+    int epollFd;
+    int timerFd; // retransmission timer of the nearest unconfirmed message
+    int signalFd; // SIGINT
+    bool stdinPolled; // false if stdin is regular file, it is always readable
+    bool stdinWatched; // stdin is currently in epoll interest list
+    bool stdinEof; // no more user input will come
+    Buffer stdinPending; // bytes read from stdin that were not processed yet
+    size_t stdinProcessed; // number of processed bytes in stdinPending
+
+    // descriptors are owned by session group, NULL if program has only 
+    // one session
+    struct SessionGroup* group;
+    size_t sessionId; // index of session in group
+    bool waitingForConfirm; // retransmitAt is valid
+    struct timespec retransmitAt; // nearest retransmission of this session
+} EventLoop;
+
+/**
+ * @brief Converts line of user input into an protocol message
+ * and adds it to the sending queue
+ *
+ * @param progInt Pointer to the program interface
+ * @param clientInput Line of user input
+ * @param pBlocks ProtocolBlocks to which user input will be separated
+ * @return true Message was added to the sending queue
+ * @return false Input was local only, message couldn't be assembled or 
+ * input was ended by /exit in pipelined mode
+ */
+bool queueUserInput(ProgramInterface* progInt, Buffer* clientInput, ProtocolBlocks* pBlocks);
+
+/**
+ * @brief Returns true if all user messages queued by pipelined input were
+ * processed, so program can start ending. Always true if input is not 
+ * pipelined.
+ *
+ * @param progInt Pointer to the program interface
+ */
+bool isPipelineDrained(ProgramInterface* progInt);
+
+/**
+ * @brief Adds file descriptor to the epoll interest list
+ *
+ * @param loop Pointer to the event loop
+ * @param fd File descriptor to be watched
+ * @param source Identification of file descriptor
+ * @return int Return value of epoll_ctl()
+ */
+int eventLoopWatch(EventLoop* loop, int fd, evt_t source);
+
+/**
+ * @brief Creates event loop, blocks SIGINT so it is only received through
+ * signalfd and stores event loop in program interface
+ *
+ * @param progInt Pointer to the program interface
+ * @return EventLoop* Created event loop
+ */
+EventLoop* eventLoopInit(ProgramInterface* progInt);
+
+/**
+ * @brief Creates event loop of one session in session group, session uses
+ * descriptors of the group and only its socket is added to group epoll
+ *
+ * @param progInt Pointer to the program interface of session
+ * @param group Pointer to the session group
+ * @param control Event loop of group holding shared descriptors
+ * @param sessionId Index of session in group
+ * @return EventLoop* Created event loop
+ */
+EventLoop* eventLoopInitSession(ProgramInterface* progInt, struct SessionGroup* group,
+    EventLoop* control, size_t sessionId);
+
+/**
+ * @brief Reads available bytes from stdin into pending user input
+ *
+ * @param loop Pointer to the event loop
+ */
+void eventLoopReadStdin(EventLoop* loop);
+
+/**
+ * @brief Appends bytes to pending user input of event loop
+ *
+ * @param loop Pointer to the event loop
+ * @param data Bytes to be appended
+ * @param len Number of bytes
+ */
+void eventLoopAppendInput(EventLoop* loop, const char* data, size_t len);
+
+/**
+ * @brief Takes one line of pending user input in same format as 
+ * loadBufferFromStdin() does. Last line doesn't have to be ended with new
+ * line if stdin was closed.
+ *
+ * @warning Line points into pending user input, it is valid only until
+ * more input is read or appended
+ *
+ * @param loop Pointer to the event loop
+ * @param clientInput Output line
+ * @return true Line was found
+ * @return false There is no complete line in pending input
+ */
+bool eventLoopGetLine(EventLoop* loop, Buffer* clientInput);
+
+/**
+ * @brief Processes pending user input for as long as it is allowed by
+ * current state of program
+ *
+ * @param progInt Pointer to the program interface
+ * @param loop Pointer to the event loop
+ */
+void eventLoopHandleInput(ProgramInterface* progInt, EventLoop* loop);
+
+/**
+ * @brief Sends messages that are allowed by current state of program,
+ * resends unconfirmed ones and sets retransmission timer to the nearest
+ * retransmission
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopSend(ProgramInterface* progInt);
+
+/**
+ * @brief Receives message(s) from server that are ready on socket
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopReceive(ProgramInterface* progInt);
+
+/**
+ * @brief Empties sending queue and sends BYE, program ends after BYE is
+ * sended (and confirmed in UDP)
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopSigintBye(ProgramInterface* progInt);
+
+/**
+ * @brief Runs whole communication in current thread until program
+ * reaches END state
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopRun(ProgramInterface* progInt);
+
+/**
+ * @brief Processes only server messages and timeouts until program reaches
+ * END state, used for sending last messages (ERR, BYE) before exiting
+ *
+ * @param progInt Pointer to the program interface
+ */
+void eventLoopDrain(ProgramInterface* progInt);
+
+/**
+ * @brief Closes file descriptors and frees event loop
+ *
+ * @param loop Pointer to the event loop
+ */
+void eventLoopDestroy(EventLoop* loop);
+
+#endif /*EVENT_LOOP_H*/
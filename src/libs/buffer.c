@@ -11,6 +11,8 @@
  * 
  */
 
+#include "errno.h"
+
 #include "buffer.h"
 
 /**
@@ -122,6 +124,182 @@ size_t loadBufferFromStdin(Buffer* buffer, bool* eofDetected)
     return i;
 }
 
+// ----------------------------------------------------------------------------
+// Line reader
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Takes next line from unprocessed part of pending bytes. Line is
+ * ended by new line or same control characters as in isEndingCharacter(),
+ * ending character is replaced by '\0' so line can be used as string.
+ * 
+ * @warning Line points into pending buffer, it is valid only until pending
+ * buffer is modified
+ * 
+ * @param pending Buffer holding bytes that were read
+ * @param processed Number of already processed bytes in pending, moved 
+ * behind returned line
+ * @param eof If true, bytes after last ending character are returned as 
+ * line too
+ * @param line Output line, its data points into pending, allocated is 0
+ * @return true Line was found
+ * @return false There is no complete line in pending bytes
+ */
+bool bufferTakeLine(Buffer* pending, size_t* processed, bool eof, Buffer* line)
+{
+    size_t unprocessed = pending->used - *processed;
+    if(unprocessed == 0) { return false; }
+
+    char* start = pending->data + *processed;
+    char* end = memchr(start, '\n', unprocessed);
+    size_t lineLen = (end != NULL) ? (size_t) (end - start) : unprocessed;
+
+    // 3 = Ctrl-D, 4 = Ctrl-C, these are searched for only inside of line
+    for(char control = 3; control <= 4; control++)
+    {
+        char* found = memchr(start, control, lineLen);
+        if(found != NULL)
+        {
+            end = found;
+            lineLen = end - start;
+        }
+    }
+
+    if(end != NULL)
+    {
+        *processed += lineLen + 1;
+    }
+    else if(eof)
+    {
+        // last line is not ended, make space for '\0'
+        if(pending->used == pending->allocated)
+        {
+            bufferResize(pending, pending->allocated + 1);
+            start = pending->data + *processed;
+        }
+        *processed += lineLen;
+    }
+    else
+    {
+        return false;
+    }
+
+    start[lineLen] = '\0';
+    line->data = start;
+    line->used = lineLen;
+    line->allocated = 0;
+
+    return true;
+}
+
+/**
+ * @brief Initializes line reader reading from file descriptor fd
+ * 
+ * @param reader Pointer to the line reader
+ * @param fd File descriptor from which lines will be read
+ */
+void lineReaderInit(LineReader* reader, int fd)
+{
+    reader->fd = fd;
+    reader->processed = 0;
+    reader->eof = false;
+    bufferInit(&(reader->pending));
+}
+
+/**
+ * @brief Moves unprocessed bytes to the start of reader buffer and reads
+ * next chunk behind them, buffer is doubled if unprocessed bytes fill it
+ * 
+ * @param reader Pointer to the line reader
+ */
+void lineReaderFill(LineReader* reader)
+{
+    Buffer* pending = &(reader->pending);
+
+    size_t unprocessed = pending->used - reader->processed;
+    if(reader->processed > 0)
+    {
+        memmove(pending->data, pending->data + reader->processed, unprocessed);
+    }
+    pending->used = unprocessed;
+    reader->processed = 0;
+
+    if(pending->allocated == 0)
+    {
+        bufferResize(pending, LINE_READER_CHUNK_SIZE);
+    }
+    else if(pending->used == pending->allocated)
+    {
+        bufferResize(pending, pending->allocated * 2);
+    }
+
+    ssize_t bytesRead;
+    do {
+        bytesRead = read(reader->fd, pending->data + pending->used,
+            pending->allocated - pending->used);
+    } while(bytesRead < 0 && errno == EINTR);
+
+    if(bytesRead > 0)
+    {
+        pending->used += bytesRead;
+    }
+    else
+    {
+        reader->eof = true;
+    }
+}
+
+/**
+ * @brief Returns next line from reader, reads next chunk from file 
+ * descriptor if there is no complete line. Line is returned in same format
+ * as loadBufferFromStdin() does, without ending character and ended by '\0'.
+ * 
+ * @warning Line points into reader, it is valid only until next call
+ * 
+ * @param reader Pointer to the line reader
+ * @param line Output line, its data points into reader, allocated is 0
+ * @param eofDetected Set to true if there are no more lines after this one
+ */
+void lineReaderNext(LineReader* reader, Buffer* line, bool* eofDetected)
+{
+    Buffer* pending = &(reader->pending);
+
+    while(!bufferTakeLine(pending, &(reader->processed), reader->eof, line))
+    {
+        if(reader->eof)
+        {
+            // input was ended by ending character, return empty line
+            pending->used = 0;
+            reader->processed = 0;
+            pending->data[0] = '\0';
+
+            line->data = pending->data;
+            line->used = 0;
+            line->allocated = 0;
+            *eofDetected = true;
+            return;
+        }
+
+        lineReaderFill(reader);
+    }
+
+    if(reader->eof && reader->processed == pending->used)
+    {
+        *eofDetected = true;
+    }
+}
+
+/**
+ * @brief Destroys line reader and frees memory
+ * 
+ * @param reader Pointer to the line reader
+ */
+void lineReaderDestroy(LineReader* reader)
+{
+    bufferDestroy(&(reader->pending));
+    bufferInit(&(reader->pending));
+}
+
 /**
  * @brief Prints buffer characters byte by byte from start to used
  * 
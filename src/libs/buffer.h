@@ -20,6 +20,8 @@
 #include "utils.h"
 
 #define INITIAL_BUFFER_SIZE 256
+// number of bytes read from stdin by line reader at once
+#define LINE_READER_CHUNK_SIZE 65536
 
 /**
  * @brief Buffer is an structure for defining byte arrays (char arrays / string)
@@ -33,6 +35,17 @@ typedef struct Buffer
     size_t used;
 } Buffer;
 
+/**
+ * @brief LineReader reads input in large chunks and splits them into lines
+ * without copying them
+ */
+typedef struct LineReader
+{
+    int fd; // file descriptor from which lines are read
+    Buffer pending; // bytes read from fd, lines are returned as views into it
+    size_t processed; // number of bytes in pending that were returned as lines
+    bool eof; // fd has no more bytes
+} LineReader;
 
 /**
  * @brief Sets default values to the buffer
@@ -73,6 +86,53 @@ void bufferCopy(Buffer* dst, Buffer* src);
  */
 size_t loadBufferFromStdin(Buffer* buffer, bool* eofDetected);
 
+/**
+ * @brief Takes next line from unprocessed part of pending bytes. Line is
+ * ended by new line or same control characters as in isEndingCharacter(),
+ * ending character is replaced by '\0' so line can be used as string.
+ * 
+ * @warning Line points into pending buffer, it is valid only until pending
+ * buffer is modified
+ * 
+ * @param pending Buffer holding bytes that were read
+ * @param processed Number of already processed bytes in pending, moved 
+ * behind returned line
+ * @param eof If true, bytes after last ending character are returned as 
+ * line too
+ * @param line Output line, its data points into pending, allocated is 0
+ * @return true Line was found
+ * @return false There is no complete line in pending bytes
+ */
+bool bufferTakeLine(Buffer* pending, size_t* processed, bool eof, Buffer* line);
+
+/**
+ * @brief Initializes line reader reading from file descriptor fd
+ * 
+ * @param reader Pointer to the line reader
+ * @param fd File descriptor from which lines will be read
+ */
+void lineReaderInit(LineReader* reader, int fd);
+
+/**
+ * @brief Returns next line from reader, reads next chunk from file 
+ * descriptor if there is no complete line. Line is returned in same format
+ * as loadBufferFromStdin() does, without ending character and ended by '\0'.
+ * 
+ * @warning Line points into reader, it is valid only until next call
+ * 
+ * @param reader Pointer to the line reader
+ * @param line Output line, its data points into reader, allocated is 0
+ * @param eofDetected Set to true if there are no more lines after this one
+ */
+void lineReaderNext(LineReader* reader, Buffer* line, bool* eofDetected);
+
+/**
+ * @brief Destroys line reader and frees memory
+ * 
+ * @param reader Pointer to the line reader
+ */
+void lineReaderDestroy(LineReader* reader);
+
 /**
  * @brief Prints buffer characters byte by byte from start to used
  * 
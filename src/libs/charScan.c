@@ -0,0 +1,350 @@
+/**
+ * @file charScan.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of CharScanner, scalar, SSE2 and AVX2 primitives
+ * for searching delimiters in received messages and user input, and table
+ * of classes of characters
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stdint.h"
+
+#include "charScan.h"
+
+#ifdef CHAR_SCAN_X86
+    #include "immintrin.h"
+#endif
+
+// ----------------------------------------------------------------------------
+//  Character classes
+// ----------------------------------------------------------------------------
+
+#ifdef DEBUG // allow "." in credentials in debug mode
+    #define CHAR_CLASS_DEBUG_DOT(c) ((c) == '.')
+#else
+    #define CHAR_CLASS_DEBUG_DOT(c) 0
+#endif
+
+#define CHAR_CLASS_OF(c) (                                                  \
+    ((((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') ||          \
+        ((c) >= '0' && (c) <= '9') || (c) == '-' || CHAR_CLASS_DEBUG_DOT(c)) \
+        ? CHAR_CLASS_CREDENTIALS : 0) |                                     \
+    (((c) >= 0x21 && (c) <= 0x7E) ? CHAR_CLASS_NAME : 0) |                  \
+    (((c) >= 0x20 && (c) <= 0x7E) ? CHAR_CLASS_MESSAGE : 0))
+
+#define CHAR_CLASS_4(c) CHAR_CLASS_OF(c), CHAR_CLASS_OF(c + 1), \
+    CHAR_CLASS_OF(c + 2), CHAR_CLASS_OF(c + 3)
+#define CHAR_CLASS_16(c) CHAR_CLASS_4(c), CHAR_CLASS_4(c + 4), \
+    CHAR_CLASS_4(c + 8), CHAR_CLASS_4(c + 12)
+#define CHAR_CLASS_64(c) CHAR_CLASS_16(c), CHAR_CLASS_16(c + 16), \
+    CHAR_CLASS_16(c + 32), CHAR_CLASS_16(c + 48)
+
+// table is computed by compiler
+const unsigned char charClasses[256] = {
+    CHAR_CLASS_64(0), CHAR_CLASS_64(64), CHAR_CLASS_64(128), CHAR_CLASS_64(192)
+};
+
+/**
+ * @brief Returns index of first character of string that does not belong 
+ * to the class, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @param charClass One of CHAR_CLASS_* 
+ * @return size_t Index of found character
+ */
+size_t charScanFindNotInClass(const char* string, size_t len, unsigned char charClass)
+{
+    const unsigned char* bytes = (const unsigned char*) string;
+    size_t index = 0;
+
+    // classes of 8 characters are combined without branching, only block 
+    // with invalid character is searched character by character
+    for(; index + 8 <= len; index += 8)
+    {
+        unsigned char common = charClass;
+        for(int i = 0; i < 8; i++)
+        {
+            common &= charClasses[bytes[index + i]];
+        }
+        if(common == 0) { break; }
+    }
+
+    while(index < len && (charClasses[bytes[index]] & charClass) != 0)
+    {
+        index++;
+    }
+    return index;
+}
+
+// ----------------------------------------------------------------------------
+//  Scalar implementation
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Returns index of first blank character or end of line
+ * (' ', '\t', '\0', '\n', '\r') in string, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @return size_t Index of found character
+ */
+size_t charScanFindBlankScalar(const char* string, size_t len)
+{
+    size_t index = 0;
+    for(; index < len; index++)
+    {
+        if( string[index] == ' ' || string[index] == '\t' ||
+            string[index] == '\0' || string[index] == '\n' ||
+            string[index] == '\r')
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Returns index of first end of line ('\0', '\n', '\r') in string,
+ * or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @return size_t Index of found character
+ */
+size_t charScanFindNewLineScalar(const char* string, size_t len)
+{
+    size_t index = 0;
+    for(; index < len; index++)
+    {
+        if(string[index] == '\0' || string[index] == '\n' || string[index] == '\r')
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Returns index of first character that is not blank (' ', '\t')
+ * in string, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @return size_t Index of found character
+ */
+size_t charScanSkipBlankScalar(const char* string, size_t len)
+{
+    size_t index = 0;
+    for(; index < len; index++)
+    {
+        if(! (string[index] == ' ' || string[index] == '\t'))
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Returns index of first '\0' in string, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @return size_t Index of found character
+ */
+size_t charScanFindZeroScalar(const char* string, size_t len)
+{
+    size_t index = 0;
+    for(; index < len; index++)
+    {
+        if(string[index] == '\0')
+        {
+            break;
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Returns index of first character that is not printable (outside 
+ * of 0x20-0x7E) in string, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @return size_t Index of found character
+ */
+size_t charScanFindNotPrintableScalar(const char* string, size_t len)
+{
+    return charScanFindNotInClass(string, len, CHAR_CLASS_MESSAGE);
+}
+
+const CharScanner charScannerScalar = {
+    .name = "scalar",
+    .findBlank = charScanFindBlankScalar,
+    .findNewLine = charScanFindNewLineScalar,
+    .skipBlank = charScanSkipBlankScalar,
+    .findZero = charScanFindZeroScalar,
+    .findNotPrintable = charScanFindNotPrintableScalar,
+};
+
+CharScanner charScanner = {
+    .name = "scalar",
+    .findBlank = charScanFindBlankScalar,
+    .findNewLine = charScanFindNewLineScalar,
+    .skipBlank = charScanSkipBlankScalar,
+    .findZero = charScanFindZeroScalar,
+    .findNotPrintable = charScanFindNotPrintableScalar,
+};
+
+#ifdef CHAR_SCAN_X86
+
+// ----------------------------------------------------------------------------
+//  Vector implementations
+// ----------------------------------------------------------------------------
+
+// Vector implementations read string by aligned chunks, aligned load never
+// crosses page boundary so bytes before string and behind found character
+// can be read without fault, they are masked out of the result. Such reads
+// are reported by AddressSanitizer, therefore it is disabled for them.
+
+/**
+ * @brief Defines function that searches string by aligned chunks of width
+ * bytes, mask(chunk) must return bit mask of matching bytes in chunk
+ */
+#define CHAR_SCAN_VECTOR_FUNCTION(name, targetName, vector, width, load, mask)  \
+    __attribute__((target(targetName), no_sanitize_address))                \
+    size_t name(const char* string, size_t len)                             \
+    {                                                                       \
+        if(len == 0) { return 0; }                                          \
+                                                                            \
+        size_t shift = (uintptr_t) string & (width - 1);                    \
+        const char* chunk = (const char*)                                   \
+            ((uintptr_t) string & ~((uintptr_t) width - 1));                \
+                                                                            \
+        /* bits of bytes in front of string are shifted out */              \
+        uint32_t found = (uint32_t) mask(load((const vector*) chunk)) >> shift; \
+        size_t index = 0;                                                   \
+        while(found == 0)                                                   \
+        {                                                                   \
+            chunk += width;                                                 \
+            index = (size_t) (chunk - string);                              \
+            if(index >= len) { return len; }                                \
+            found = (uint32_t) mask(load((const vector*) chunk));           \
+        }                                                                   \
+                                                                            \
+        index += (size_t) __builtin_ctz(found);                             \
+        return (index < len) ? index : len;                                 \
+    }
+
+#define CHAR_SCAN_SSE2_EQ(chunk, c) _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c))
+
+#define CHAR_SCAN_SSE2_MASK_BLANK(chunk) _mm_movemask_epi8(_mm_or_si128( \
+    _mm_or_si128(CHAR_SCAN_SSE2_EQ(chunk, ' '), CHAR_SCAN_SSE2_EQ(chunk, '\t')), \
+    _mm_or_si128(_mm_or_si128(CHAR_SCAN_SSE2_EQ(chunk, '\0'), \
+        CHAR_SCAN_SSE2_EQ(chunk, '\n')), CHAR_SCAN_SSE2_EQ(chunk, '\r'))))
+
+#define CHAR_SCAN_SSE2_MASK_NEW_LINE(chunk) _mm_movemask_epi8(_mm_or_si128( \
+    _mm_or_si128(CHAR_SCAN_SSE2_EQ(chunk, '\0'), CHAR_SCAN_SSE2_EQ(chunk, '\n')), \
+    CHAR_SCAN_SSE2_EQ(chunk, '\r')))
+
+#define CHAR_SCAN_SSE2_MASK_NOT_BLANK(chunk) (0xFFFF ^ _mm_movemask_epi8( \
+    _mm_or_si128(CHAR_SCAN_SSE2_EQ(chunk, ' '), CHAR_SCAN_SSE2_EQ(chunk, '\t'))))
+
+#define CHAR_SCAN_SSE2_MASK_ZERO(chunk) _mm_movemask_epi8(CHAR_SCAN_SSE2_EQ(chunk, '\0'))
+
+// signed comparison, characters >= 0x80 are negative and so below 0x20 too
+#define CHAR_SCAN_SSE2_MASK_NOT_PRINTABLE(chunk) _mm_movemask_epi8(_mm_or_si128( \
+    _mm_cmplt_epi8(chunk, _mm_set1_epi8(0x20)), CHAR_SCAN_SSE2_EQ(chunk, 0x7F)))
+
+#define CHAR_SCAN_AVX2_EQ(chunk, c) _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(c))
+
+#define CHAR_SCAN_AVX2_MASK_BLANK(chunk) _mm256_movemask_epi8(_mm256_or_si256( \
+    _mm256_or_si256(CHAR_SCAN_AVX2_EQ(chunk, ' '), CHAR_SCAN_AVX2_EQ(chunk, '\t')), \
+    _mm256_or_si256(_mm256_or_si256(CHAR_SCAN_AVX2_EQ(chunk, '\0'), \
+        CHAR_SCAN_AVX2_EQ(chunk, '\n')), CHAR_SCAN_AVX2_EQ(chunk, '\r'))))
+
+#define CHAR_SCAN_AVX2_MASK_NEW_LINE(chunk) _mm256_movemask_epi8(_mm256_or_si256( \
+    _mm256_or_si256(CHAR_SCAN_AVX2_EQ(chunk, '\0'), CHAR_SCAN_AVX2_EQ(chunk, '\n')), \
+    CHAR_SCAN_AVX2_EQ(chunk, '\r')))
+
+#define CHAR_SCAN_AVX2_MASK_NOT_BLANK(chunk) (~(uint32_t) _mm256_movemask_epi8( \
+    _mm256_or_si256(CHAR_SCAN_AVX2_EQ(chunk, ' '), CHAR_SCAN_AVX2_EQ(chunk, '\t'))))
+
+#define CHAR_SCAN_AVX2_MASK_ZERO(chunk) _mm256_movemask_epi8(CHAR_SCAN_AVX2_EQ(chunk, '\0'))
+
+#define CHAR_SCAN_AVX2_MASK_NOT_PRINTABLE(chunk) _mm256_movemask_epi8(_mm256_or_si256( \
+    _mm256_cmpgt_epi8(_mm256_set1_epi8(0x20), chunk), CHAR_SCAN_AVX2_EQ(chunk, 0x7F)))
+
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindBlankSse2, "sse2", __m128i, 16, _mm_load_si128, CHAR_SCAN_SSE2_MASK_BLANK)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindNewLineSse2, "sse2", __m128i, 16, _mm_load_si128, CHAR_SCAN_SSE2_MASK_NEW_LINE)
+CHAR_SCAN_VECTOR_FUNCTION(charScanSkipBlankSse2, "sse2", __m128i, 16, _mm_load_si128, CHAR_SCAN_SSE2_MASK_NOT_BLANK)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindZeroSse2, "sse2", __m128i, 16, _mm_load_si128, CHAR_SCAN_SSE2_MASK_ZERO)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindNotPrintableSse2, "sse2", __m128i, 16, _mm_load_si128, CHAR_SCAN_SSE2_MASK_NOT_PRINTABLE)
+
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindBlankAvx2, "avx2", __m256i, 32, _mm256_load_si256, CHAR_SCAN_AVX2_MASK_BLANK)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindNewLineAvx2, "avx2", __m256i, 32, _mm256_load_si256, CHAR_SCAN_AVX2_MASK_NEW_LINE)
+CHAR_SCAN_VECTOR_FUNCTION(charScanSkipBlankAvx2, "avx2", __m256i, 32, _mm256_load_si256, CHAR_SCAN_AVX2_MASK_NOT_BLANK)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindZeroAvx2, "avx2", __m256i, 32, _mm256_load_si256, CHAR_SCAN_AVX2_MASK_ZERO)
+CHAR_SCAN_VECTOR_FUNCTION(charScanFindNotPrintableAvx2, "avx2", __m256i, 32, _mm256_load_si256, CHAR_SCAN_AVX2_MASK_NOT_PRINTABLE)
+
+const CharScanner charScannerSse2 = {
+    .name = "sse2",
+    .findBlank = charScanFindBlankSse2,
+    .findNewLine = charScanFindNewLineSse2,
+    .skipBlank = charScanSkipBlankSse2,
+    .findZero = charScanFindZeroSse2,
+    .findNotPrintable = charScanFindNotPrintableSse2,
+};
+
+const CharScanner charScannerAvx2 = {
+    .name = "avx2",
+    .findBlank = charScanFindBlankAvx2,
+    .findNewLine = charScanFindNewLineAvx2,
+    .skipBlank = charScanSkipBlankAvx2,
+    .findZero = charScanFindZeroAvx2,
+    .findNotPrintable = charScanFindNotPrintableAvx2,
+};
+
+#endif /*CHAR_SCAN_X86*/
+
+// ----------------------------------------------------------------------------
+//  Dispatch
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Returns true if implementation can be used on this CPU
+ *
+ * @param scanner Pointer to the implementation
+ * @return true Implementation is supported
+ * @return false Implementation uses instructions not supported by CPU
+ */
+bool charScanSupported(const CharScanner* scanner)
+{
+    if(scanner == &charScannerScalar) { return true; }
+
+#ifdef CHAR_SCAN_X86
+    // cpuid is queried once and cached by compiler runtime
+    __builtin_cpu_init();
+    if(scanner == &charScannerSse2) { return __builtin_cpu_supports("sse2"); }
+    if(scanner == &charScannerAvx2) { return __builtin_cpu_supports("avx2"); }
+#endif
+
+    return false;
+}
+
+/**
+ * @brief Picks the fastest implementation supported by CPU, should be
+ * called once at the start of the program before any other thread exists
+ */
+void charScanInit()
+{
+#ifdef CHAR_SCAN_X86
+    if(charScanSupported(&charScannerAvx2)) { charScanner = charScannerAvx2; return; }
+    if(charScanSupported(&charScannerSse2)) { charScanner = charScannerSse2; return; }
+#endif
+
+    charScanner = charScannerScalar;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file charScan.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Declaration of CharScanner, primitives for searching delimiters in
+ * received messages and user input, and of classes of characters allowed 
+ * in parameters of messages
+ *
+ * Every primitive has scalar implementation, that is used as fallback and
+ * reference, and on x86 also SSE2 and AVX2 implementations. Implementation
+ * is picked once at the start of the program by charScanInit() according
+ * to the instructions supported by CPU.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CHAR_SCAN_H
+#define CHAR_SCAN_H 1
+
+#include "stddef.h"
+#include "stdbool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define CHAR_SCAN_X86 1
+#endif
+
+// Classes of characters allowed in parameters of IPK24CHAT, bits of charClasses
+#define CHAR_CLASS_CREDENTIALS 0x01 // Username, ChannelID, Secret: [A-Za-z0-9-]
+#define CHAR_CLASS_NAME 0x02 // DisplayName: 0x21-0x7E
+#define CHAR_CLASS_MESSAGE 0x04 // MessageContent: 0x20-0x7E
+
+// classes of every character, indexed by unsigned char
+extern const unsigned char charClasses[256];
+
+/**
+ * @brief Set of searching primitives, every primitive searches string
+ * in range [0, len) and returns index of first matching character or len
+ * if there is none
+ */
+typedef struct CharScanner {
+    const char* name; // name of implementation
+    // first blank character or end of line (' ', '\t', '\0', '\n', '\r')
+    size_t (*findBlank)(const char* string, size_t len);
+    // first end of line ('\0', '\n', '\r')
+    size_t (*findNewLine)(const char* string, size_t len);
+    // first character that is not blank (' ', '\t')
+    size_t (*skipBlank)(const char* string, size_t len);
+    // first '\0'
+    size_t (*findZero)(const char* string, size_t len);
+    // first character that is not printable (outside of 0x20-0x7E)
+    size_t (*findNotPrintable)(const char* string, size_t len);
+} CharScanner;
+
+// implementation used by program, scalar until charScanInit() is called
+extern CharScanner charScanner;
+
+// byte by byte implementation, reference for other implementations
+extern const CharScanner charScannerScalar;
+
+#ifdef CHAR_SCAN_X86
+    extern const CharScanner charScannerSse2;
+    extern const CharScanner charScannerAvx2;
+#endif
+
+/**
+ * @brief Returns index of first character of string that does not belong 
+ * to the class, or len if there is none
+ *
+ * @param string String to be searched in
+ * @param len Number of characters that can be searched
+ * @param charClass One of CHAR_CLASS_* 
+ * @return size_t Index of found character
+ */
+size_t charScanFindNotInClass(const char* string, size_t len, unsigned char charClass);
+
+/**
+ * @brief Picks the fastest implementation supported by CPU, should be
+ * called once at the start of the program before any other thread exists
+ */
+void charScanInit();
+
+/**
+ * @brief Returns true if implementation can be used on this CPU
+ *
+ * @param scanner Pointer to the implementation
+ * @return true Implementation is supported
+ * @return false Implementation uses instructions not supported by CPU
+ */
+bool charScanSupported(const CharScanner* scanner);
+
+#endif /*CHAR_SCAN_H*/
@@ -33,6 +33,7 @@ void programInterfaceInit(ProgramInterface* pI)
         err_MEMORY_FAIL);
 
     threads->fsmState = fsm_START;
+    threads->wakeFd = -1;
     pI->threads = threads;
     //-------------------------------------------------------------------------
     // queue of outcoming (user sent) messages
@@ -43,46 +44,22 @@ void programInterfaceInit(ProgramInterface* pI)
 
     pI->threads->sendingQueue = sendingQueue;
     //-------------------------------------------------------------------------
-    // initialize mutexes and conditions for thread communication
-    
-    pthread_cond_t* conditions[3]; 
-    for(short i = 0; i < 3; i++)
-    {
-       conditions[i] = (pthread_cond_t*) malloc(sizeof(pthread_cond_t));
-    }
-    IF_NULL_ERR(conditions, "Failed to allocate memory for thread conditions", 
-        err_MEMORY_FAIL);
+    // initialize mutexes and notifiers for thread communication
 
-    pthread_cond_init(conditions[0], NULL);
-    pthread_cond_init(conditions[1], NULL);
-    pthread_cond_init(conditions[2], NULL);
-
-    pthread_mutex_t* mutexes[5];
-    for(short i = 0; i < 5; i++)
+    pthread_mutex_t* mutexes[2];
+    for(short i = 0; i < 2; i++)
     {
         mutexes[i] = (pthread_mutex_t*) malloc(sizeof(pthread_mutex_t));
-        IF_NULL_ERR(mutexes, "Failed to allocate memory for thread mutexes", 
+        IF_NULL_ERR(mutexes[i], "Failed to allocate memory for thread mutexes", 
             err_MEMORY_FAIL);
+        pthread_mutex_init(mutexes[i], NULL);
     }
 
-    pthread_mutex_init(mutexes[0], NULL);
-    pthread_mutex_init(mutexes[1], NULL);
-    pthread_mutex_init(mutexes[2], NULL);
-    pthread_mutex_init(mutexes[3], NULL);
-    pthread_mutex_init(mutexes[4], NULL);
-
-
-    pI->threads->senderEmptyQueueCond = conditions[0];
-    pI->threads->senderEmptyQueueMutex = mutexes[0];
+    pI->threads->fsmMutex = mutexes[0];
+    pI->threads->stdoutMutex = mutexes[1];
 
-    pI->threads->rec2SenderCond = conditions[1];
-    pI->threads->rec2SenderMutex = mutexes[1];
-
-    pI->threads->mainCond = conditions[2];
-    pI->threads->mainMutex = mutexes[2];
-
-    pI->threads->fsmMutex = mutexes[3];
-    pI->threads->stdoutMutex = mutexes[4];
+    notifierInit(&(pI->threads->senderNotifier));
+    notifierInit(&(pI->threads->mainNotifier));
 
     //-------------------------------------------------------------------------
     // NetworkConfig
@@ -103,8 +80,15 @@ void programInterfaceInit(ProgramInterface* pI)
         "Details", err_MEMORY_FAIL);
 
     comDetails->msgCounter = 0;
+    rttEstimatorInit(&(comDetails->rtt));
+    // sessions started at the same time must not draw same delays
+    struct timespec seed;
+    clock_gettime(CLOCK_MONOTONIC, &seed);
+    retrySchedulerInit(&(comDetails->retry), 
+        ((uint64_t) seed.tv_sec << 32) ^ (uint64_t) seed.tv_nsec ^ (uintptr_t) comDetails);
     // initalize buffers
     bufferInit(&(comDetails->displayName));
+    bufferInit(&(comDetails->messagePrefix));
     bufferInit(&(comDetails->channelID));
 
     pI->comDetails = comDetails;
@@ -116,19 +100,32 @@ void programInterfaceInit(ProgramInterface* pI)
     IF_NULL_ERR(comDetails, "Failed to allocate memory for CleanUp", err_MEMORY_FAIL);
 
     bufferInit(&(cleanUp->clientInput));
+    lineReaderInit(&(cleanUp->stdinReader), STDIN_FILENO);
     bufferInit(&(cleanUp->protocolToSendedByMain));
     bufferInit(&(cleanUp->protocolToSendedByReceiver));
     bufferInit(&(cleanUp->protocolToSendedBySender));
+    bufferInit(&(cleanUp->senderOutbox));
     bufferInit(&(cleanUp->serverResponse));
+    ringBufferInit(&(cleanUp->serverStream));
 
-    MessageQueue* confirmedMessages = (MessageQueue*) malloc(sizeof(MessageQueue));
-    IF_NULL_ERR(comDetails, "Failed to allocate memory for "
-        "CleanUp.MessageQueue", err_MEMORY_FAIL);
-    queueInit(confirmedMessages);
-
-    cleanUp->confirmedMessages = confirmedMessages;
+    // set is created only for UDP when protocol is known
+    cleanUp->confirmedMessages = NULL;
+    cleanUp->eventLoop = NULL;
+    cleanUp->sendRing = NULL;
+    cleanUp->recvRing = NULL;
+    cleanUp->sendBatch = NULL;
+    cleanUp->recvBatch = NULL;
 
     pI->cleanUp = cleanUp;
+
+    //-------------------------------------------------------------------------
+    // Statistics
+    //-------------------------------------------------------------------------
+    Statistics* stats = (Statistics*) malloc(sizeof(Statistics));
+    IF_NULL_ERR(stats, "Failed to allocate memory for Statistics", err_MEMORY_FAIL);
+    statisticsInit(stats);
+
+    pI->stats = stats;
 }
 
 /**
@@ -143,18 +140,36 @@ void programInterfaceDestroy(ProgramInterface* pI)
     //-------------------------------------------------------------------------
 
     bufferDestroy(&(pI->cleanUp->clientInput));
+    lineReaderDestroy(&(pI->cleanUp->stdinReader));
     bufferDestroy(&(pI->cleanUp->protocolToSendedByMain));
     bufferDestroy(&(pI->cleanUp->protocolToSendedByReceiver));
     bufferDestroy(&(pI->cleanUp->protocolToSendedBySender));
+    bufferDestroy(&(pI->cleanUp->senderOutbox));
     bufferDestroy(&(pI->cleanUp->serverResponse));
-    queueDestroy(pI->cleanUp->confirmedMessages);
+    ringBufferDestroy(&(pI->cleanUp->serverStream));
+    free(pI->cleanUp->confirmedMessages);
+    if(pI->cleanUp->eventLoop != NULL)
+    {
+        eventLoopDestroy(pI->cleanUp->eventLoop);
+    }
+    ioRingDestroy(pI->cleanUp->sendRing);
+    ioRingDestroy(pI->cleanUp->recvRing);
+    datagramBatchDestroy(pI->cleanUp->sendBatch);
+    datagramBatchDestroy(pI->cleanUp->recvBatch);
     free(pI->cleanUp);
 
+    //-------------------------------------------------------------------------
+    // Statistics
+    //-------------------------------------------------------------------------
+
+    free(pI->stats);
+
     //-------------------------------------------------------------------------
     // CommunicationDetails
     //-------------------------------------------------------------------------
 
     bufferDestroy(&(pI->comDetails->displayName));
+    bufferDestroy(&(pI->comDetails->messagePrefix));
     bufferDestroy(&(pI->comDetails->channelID));
     free(pI->comDetails);
 
@@ -173,23 +188,13 @@ void programInterfaceDestroy(ProgramInterface* pI)
     free(pI->threads->fsmMutex);
     free(pI->threads->stdoutMutex);
 
-    pthread_mutex_destroy(pI->threads->mainMutex);
-    pthread_cond_destroy(pI->threads->mainCond);
-    free(pI->threads->mainMutex);
-    free(pI->threads->mainCond);
-
-    pthread_mutex_destroy(pI->threads->rec2SenderMutex);
-    pthread_cond_destroy(pI->threads->rec2SenderCond);
-    free(pI->threads->rec2SenderMutex);
-    free(pI->threads->rec2SenderCond);
-
-    pthread_mutex_destroy(pI->threads->senderEmptyQueueMutex);
-    pthread_cond_destroy(pI->threads->senderEmptyQueueCond);
-    free(pI->threads->senderEmptyQueueMutex);
-    free(pI->threads->senderEmptyQueueCond);
+    notifierDestroy(&(pI->threads->senderNotifier));
+    notifierDestroy(&(pI->threads->mainNotifier));
 
     queueDestroy(pI->threads->sendingQueue);
 
+    if(pI->threads->wakeFd >= 0) { close(pI->threads->wakeFd); }
+
     free(pI->threads);
 
     // ------------------------------------------------------------------------
@@ -207,7 +212,7 @@ void sigintHandler(int num) {
     // set program state to SIGINT_BYE, which will lead to main thread to exit
     setProgramState(globalProgInt, fsm_SIGINT_BYE);
     // signal main thread to wake up if suspended
-    pthread_cond_signal(globalProgInt->threads->mainCond);
+    notifierNotify(&(globalProgInt->threads->mainNotifier));
 
     queueLock(globalProgInt->threads->sendingQueue);
     queuePopAllMessages(globalProgInt->threads->sendingQueue);
@@ -215,12 +220,16 @@ void sigintHandler(int num) {
 
     // send bye to the server
     sendBye(globalProgInt);
-    // singal other threads to wake up if suspended
-    pthread_cond_signal(globalProgInt->threads->senderEmptyQueueCond);
-    pthread_cond_signal(globalProgInt->threads->rec2SenderCond);
+    // singal sender to wake up if suspended
+    notifierNotify(&(globalProgInt->threads->senderNotifier));
 
-    // wait on mainMutex, sender will singal that it sended last BYE and exited
-    pthread_cond_wait(globalProgInt->threads->mainCond, globalProgInt->threads->mainMutex);
+    // wait until sender sended last BYE and ended program
+    Notifier* mainNotifier = &(globalProgInt->threads->mainNotifier);
+    uint64_t seen = notifierSequence(mainNotifier);
+    while(getProgramState(globalProgInt) != fsm_END)
+    {
+        seen = notifierWait(mainNotifier, seen, NULL);
+    }
 
     // close socket
     shutdown(globalProgInt->netConfig->openedSocket, SHUT_RDWR);
@@ -14,6 +14,7 @@
 
 #include "../protocolReceiver.h"
 #include "../protocolSender.h"
+#include "../eventLoop.h"
 
 /**
  * @brief Initializes allocated structures in program interface
@@ -0,0 +1,196 @@
+/**
+ * @file datagramBatch.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of DatagramBatch, sending and receiving of multiple
+ * UDP datagrams with one system call (sendmmsg()/recvmmsg())
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+// sendmmsg(), recvmmsg(), struct mmsghdr
+#define _GNU_SOURCE
+
+#include "errno.h"
+
+#include "datagramBatch.h"
+
+/**
+ * @brief Structure holding headers and data of datagrams in batch
+ */
+struct DatagramBatch {
+    // datagrams to be sended, data are copied because messages can be
+    // deleted from queue before batch is sended
+    unsigned sendCount;
+    struct mmsghdr sendHeaders[DATAGRAM_BATCH_SIZE];
+    struct iovec sendIovs[DATAGRAM_BATCH_SIZE];
+    struct sockaddr_storage sendAddresses[DATAGRAM_BATCH_SIZE];
+    char sendData[DATAGRAM_BATCH_SIZE][DATAGRAM_BATCH_SLOT_SIZE];
+
+    // received datagrams
+    struct mmsghdr recvHeaders[DATAGRAM_BATCH_SIZE];
+    struct iovec recvIovs[DATAGRAM_BATCH_SIZE];
+    struct sockaddr_storage recvAddresses[DATAGRAM_BATCH_SIZE];
+    char recvData[DATAGRAM_BATCH_SIZE][DATAGRAM_BATCH_SLOT_SIZE];
+};
+
+/**
+ * @brief Creates new batch
+ *
+ * @return DatagramBatch* Created batch or NULL if allocation failed
+ */
+DatagramBatch* datagramBatchCreate()
+{
+    DatagramBatch* batch = (DatagramBatch*) calloc(1, sizeof(DatagramBatch));
+    if(batch == NULL) { return NULL; }
+
+    // receiving headers point to the same buffers every time
+    for(int i = 0; i < DATAGRAM_BATCH_SIZE; i++)
+    {
+        batch->recvIovs[i].iov_base = batch->recvData[i];
+        batch->recvIovs[i].iov_len = DATAGRAM_BATCH_SLOT_SIZE;
+
+        batch->recvHeaders[i].msg_hdr.msg_iov = &(batch->recvIovs[i]);
+        batch->recvHeaders[i].msg_hdr.msg_iovlen = 1;
+        batch->recvHeaders[i].msg_hdr.msg_name = &(batch->recvAddresses[i]);
+    }
+
+    return batch;
+}
+
+/**
+ * @brief Destroys batch
+ *
+ * @param batch Pointer to the batch, can be NULL
+ */
+void datagramBatchDestroy(DatagramBatch* batch)
+{
+    free(batch);
+}
+
+// ----------------------------------------------------------------------------
+// Sending
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Copies datagram into batch, datagram is sended by
+ * datagramBatchFlushSends(). If batch is full, it is flushed first.
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket through which batch is sended
+ * @param data Datagram to be sended
+ * @param len Length of datagram
+ * @param address Address of receiver
+ * @param addressLen Length of address
+ * @return true Datagram was added to the batch
+ * @return false Datagram is too big, it must be sended separately
+ */
+bool datagramBatchPrepareSend(DatagramBatch* batch, int socket, const char* data,
+    size_t len, struct sockaddr* address, socklen_t addressLen)
+{
+    if(len > DATAGRAM_BATCH_SLOT_SIZE || addressLen > sizeof(struct sockaddr_storage))
+    {
+        return false;
+    }
+
+    // batch is full, send it
+    if(batch->sendCount == DATAGRAM_BATCH_SIZE && datagramBatchFlushSends(batch, socket) != 0)
+    {
+        errHandling("Sending bytes was not successful", err_COMMUNICATION);
+    }
+
+    unsigned slot = batch->sendCount;
+    memcpy(batch->sendData[slot], data, len);
+    memcpy(&(batch->sendAddresses[slot]), address, addressLen);
+
+    batch->sendIovs[slot].iov_base = batch->sendData[slot];
+    batch->sendIovs[slot].iov_len = len;
+
+    struct msghdr* header = &(batch->sendHeaders[slot].msg_hdr);
+    memset(header, 0, sizeof(struct msghdr));
+    header->msg_name = &(batch->sendAddresses[slot]);
+    header->msg_namelen = addressLen;
+    header->msg_iov = &(batch->sendIovs[slot]);
+    header->msg_iovlen = 1;
+
+    batch->sendCount += 1;
+    return true;
+}
+
+/**
+ * @brief Sends all datagrams in batch with sendmmsg()
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket through which batch is sended
+ * @return int 0 on success, -1 if sending failed
+ */
+int datagramBatchFlushSends(DatagramBatch* batch, int socket)
+{
+    unsigned sended = 0;
+    while(sended < batch->sendCount)
+    {
+        // sendmmsg() can send only part of batch
+        int res = sendmmsg(socket, &(batch->sendHeaders[sended]), batch->sendCount - sended, 0);
+        if(res < 0)
+        {
+            if(errno == EINTR) { continue; }
+            batch->sendCount = 0;
+            return -1;
+        }
+        sended += res;
+    }
+
+    batch->sendCount = 0;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Receiving
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Waits for first datagram and receives all datagrams that are 
+ * already waiting on socket, up to DATAGRAM_BATCH_SIZE
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket from which datagrams are received
+ * @return int Number of received datagrams, negative value if nothing was
+ * received
+ */
+int datagramBatchReceive(DatagramBatch* batch, int socket)
+{
+    for(int i = 0; i < DATAGRAM_BATCH_SIZE; i++)
+    {
+        batch->recvHeaders[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    return recvmmsg(socket, batch->recvHeaders, DATAGRAM_BATCH_SIZE, MSG_WAITFORONE, NULL);
+}
+
+/**
+ * @brief Returns datagram received by last datagramBatchReceive()
+ *
+ * @param batch Pointer to the batch
+ * @param index Index of datagram
+ * @param len Output length of datagram
+ * @param address Output address of sender, can be NULL
+ * @param addressLen Size of address on input, length of sender address
+ * on output
+ * @return char* Pointer to the datagram data
+ */
+char* datagramBatchGetReceived(DatagramBatch* batch, int index, size_t* len,
+    struct sockaddr* address, socklen_t* addressLen)
+{
+    struct mmsghdr* header = &(batch->recvHeaders[index]);
+    *len = header->msg_len;
+
+    if(address != NULL && header->msg_hdr.msg_namelen > 0)
+    {
+        socklen_t nameLen = header->msg_hdr.msg_namelen < *addressLen ?
+            header->msg_hdr.msg_namelen : *addressLen;
+        memcpy(address, &(batch->recvAddresses[index]), nameLen);
+        *addressLen = nameLen;
+    }
+
+    return batch->recvData[index];
+}
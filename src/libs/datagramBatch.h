@@ -0,0 +1,94 @@
+/**
+ * @file datagramBatch.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for DatagramBatch, sending
+ * and receiving of multiple UDP datagrams with one system call
+ * (sendmmsg()/recvmmsg())
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DATAGRAM_BATCH_H
+#define DATAGRAM_BATCH_H 1
+
+#include "sys/socket.h"
+
+#include "utils.h"
+
+// maximal number of datagrams sended or received with one system call
+#define DATAGRAM_BATCH_SIZE 16
+// maximal size of one datagram in batch
+#define DATAGRAM_BATCH_SLOT_SIZE 1500
+
+/**
+ * @brief DatagramBatch holds datagrams that will be sended or that were
+ * received with one system call, one batch is meant to be used by one thread
+ */
+typedef struct DatagramBatch DatagramBatch;
+
+/**
+ * @brief Creates new batch
+ *
+ * @return DatagramBatch* Created batch or NULL if allocation failed
+ */
+DatagramBatch* datagramBatchCreate();
+
+/**
+ * @brief Destroys batch
+ *
+ * @param batch Pointer to the batch, can be NULL
+ */
+void datagramBatchDestroy(DatagramBatch* batch);
+
+/**
+ * @brief Copies datagram into batch, datagram is sended by
+ * datagramBatchFlushSends(). If batch is full, it is flushed first.
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket through which batch is sended
+ * @param data Datagram to be sended
+ * @param len Length of datagram
+ * @param address Address of receiver
+ * @param addressLen Length of address
+ * @return true Datagram was added to the batch
+ * @return false Datagram is too big, it must be sended separately
+ */
+bool datagramBatchPrepareSend(DatagramBatch* batch, int socket, const char* data,
+    size_t len, struct sockaddr* address, socklen_t addressLen);
+
+/**
+ * @brief Sends all datagrams in batch with sendmmsg()
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket through which batch is sended
+ * @return int 0 on success, -1 if sending failed
+ */
+int datagramBatchFlushSends(DatagramBatch* batch, int socket);
+
+/**
+ * @brief Waits for first datagram and receives all datagrams that are 
+ * already waiting on socket, up to DATAGRAM_BATCH_SIZE
+ *
+ * @param batch Pointer to the batch
+ * @param socket Socket from which datagrams are received
+ * @return int Number of received datagrams, negative value if nothing was
+ * received
+ */
+int datagramBatchReceive(DatagramBatch* batch, int socket);
+
+/**
+ * @brief Returns datagram received by last datagramBatchReceive()
+ *
+ * @param batch Pointer to the batch
+ * @param index Index of datagram
+ * @param len Output length of datagram
+ * @param address Output address of sender, can be NULL
+ * @param addressLen Size of address on input, length of sender address
+ * on output
+ * @return char* Pointer to the datagram data
+ */
+char* datagramBatchGetReceived(DatagramBatch* batch, int index, size_t* len,
+    struct sockaddr* address, socklen_t* addressLen);
+
+#endif /*DATAGRAM_BATCH_H*/
@@ -0,0 +1,228 @@
+/**
+ * @file deadlineHeap.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of DeadlineHeap, binary min-heap of IDs ordered by
+ * their deadlines
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stdlib.h"
+#include "deadlineHeap.h"
+
+/**
+ * @brief Initializes empty heap for IDs from 0 to capacity - 1
+ *
+ * @param heap Pointer to the heap
+ * @param capacity Number of IDs
+ * @return true Heap was initialized
+ * @return false Allocation failed
+ */
+bool deadlineHeapInit(DeadlineHeap* heap, size_t capacity)
+{
+    heap->items = (size_t*) malloc(capacity * sizeof(size_t));
+    heap->deadlines = (struct timespec*) malloc(capacity * sizeof(struct timespec));
+    // position equal to capacity marks ID that is not in heap
+    heap->positions = (size_t*) malloc(capacity * sizeof(size_t));
+    heap->len = 0;
+    heap->capacity = capacity;
+
+    if(heap->items == NULL || heap->deadlines == NULL || heap->positions == NULL)
+    {
+        deadlineHeapDestroy(heap);
+        return false;
+    }
+
+    for(size_t i = 0; i < capacity; i++)
+    {
+        heap->positions[i] = capacity;
+    }
+    return true;
+}
+
+/**
+ * @brief Frees memory of heap
+ *
+ * @param heap Pointer to the heap
+ */
+void deadlineHeapDestroy(DeadlineHeap* heap)
+{
+    free(heap->items);
+    free(heap->deadlines);
+    free(heap->positions);
+    heap->items = NULL;
+    heap->deadlines = NULL;
+    heap->positions = NULL;
+    heap->len = 0;
+}
+
+/**
+ * @brief Returns true if deadline of ID at position a is earlier than
+ * deadline of ID at position b
+ *
+ * @param heap Pointer to the heap
+ * @param a Position in heap
+ * @param b Position in heap
+ * @return true Deadline at a is earlier
+ */
+bool deadlineHeapEarlier(DeadlineHeap* heap, size_t a, size_t b)
+{
+    struct timespec* first = &(heap->deadlines[heap->items[a]]);
+    struct timespec* second = &(heap->deadlines[heap->items[b]]);
+
+    return first->tv_sec < second->tv_sec ||
+        (first->tv_sec == second->tv_sec && first->tv_nsec < second->tv_nsec);
+}
+
+/**
+ * @brief Swaps IDs at two positions of heap
+ *
+ * @param heap Pointer to the heap
+ * @param a Position in heap
+ * @param b Position in heap
+ */
+void deadlineHeapSwap(DeadlineHeap* heap, size_t a, size_t b)
+{
+    size_t id = heap->items[a];
+    heap->items[a] = heap->items[b];
+    heap->items[b] = id;
+
+    heap->positions[heap->items[a]] = a;
+    heap->positions[heap->items[b]] = b;
+}
+
+/**
+ * @brief Moves ID at position towards top of heap while its deadline is
+ * earlier than deadline of its parent
+ *
+ * @param heap Pointer to the heap
+ * @param position Position in heap
+ */
+void deadlineHeapSiftUp(DeadlineHeap* heap, size_t position)
+{
+    while(position > 0)
+    {
+        size_t parent = (position - 1) / 2;
+        if(!deadlineHeapEarlier(heap, position, parent)) { break; }
+
+        deadlineHeapSwap(heap, position, parent);
+        position = parent;
+    }
+}
+
+/**
+ * @brief Moves ID at position towards bottom of heap while deadline of any
+ * of its children is earlier
+ *
+ * @param heap Pointer to the heap
+ * @param position Position in heap
+ */
+void deadlineHeapSiftDown(DeadlineHeap* heap, size_t position)
+{
+    while(true)
+    {
+        size_t earliest = position;
+        size_t left = 2 * position + 1;
+        size_t right = left + 1;
+
+        if(left < heap->len && deadlineHeapEarlier(heap, left, earliest)) { earliest = left; }
+        if(right < heap->len && deadlineHeapEarlier(heap, right, earliest)) { earliest = right; }
+        if(earliest == position) { break; }
+
+        deadlineHeapSwap(heap, position, earliest);
+        position = earliest;
+    }
+}
+
+/**
+ * @brief Adds ID to heap or changes its deadline if it is already in heap
+ *
+ * @param heap Pointer to the heap
+ * @param id ID smaller than capacity of heap
+ * @param deadline New deadline of ID
+ */
+void deadlineHeapSet(DeadlineHeap* heap, size_t id, struct timespec deadline)
+{
+    heap->deadlines[id] = deadline;
+
+    size_t position = heap->positions[id];
+    if(position >= heap->len)
+    {
+        position = heap->len;
+        heap->items[position] = id;
+        heap->positions[id] = position;
+        heap->len += 1;
+    }
+
+    // deadline could move both ways
+    deadlineHeapSiftUp(heap, position);
+    deadlineHeapSiftDown(heap, heap->positions[id]);
+}
+
+/**
+ * @brief Removes ID from heap, nothing is done if ID is not in heap
+ *
+ * @param heap Pointer to the heap
+ * @param id ID smaller than capacity of heap
+ */
+void deadlineHeapRemove(DeadlineHeap* heap, size_t id)
+{
+    size_t position = heap->positions[id];
+    if(position >= heap->len) { return; }
+
+    // last ID takes place of removed one
+    heap->len -= 1;
+    heap->positions[id] = heap->capacity;
+    if(position == heap->len) { return; }
+
+    size_t moved = heap->items[heap->len];
+    heap->items[position] = moved;
+    heap->positions[moved] = position;
+
+    // deadline of moved ID could be earlier or later than removed one
+    deadlineHeapSiftUp(heap, position);
+    deadlineHeapSiftDown(heap, heap->positions[moved]);
+}
+
+/**
+ * @brief Returns the earliest deadline in heap
+ *
+ * @param heap Pointer to the heap
+ * @param deadline Output of the earliest deadline
+ * @return true Heap is not empty, deadline was set
+ * @return false Heap is empty
+ */
+bool deadlineHeapPeek(DeadlineHeap* heap, struct timespec* deadline)
+{
+    if(heap->len == 0) { return false; }
+
+    *deadline = heap->deadlines[heap->items[0]];
+    return true;
+}
+
+/**
+ * @brief Removes ID with the earliest deadline from heap if its deadline
+ * is not later than now
+ *
+ * @param heap Pointer to the heap
+ * @param now Current time
+ * @param id Output of removed ID
+ * @return true ID was removed
+ * @return false Heap is empty or no deadline expired
+ */
+bool deadlineHeapPopExpired(DeadlineHeap* heap, struct timespec now, size_t* id)
+{
+    if(heap->len == 0) { return false; }
+
+    struct timespec* earliest = &(heap->deadlines[heap->items[0]]);
+    if(earliest->tv_sec > now.tv_sec ||
+        (earliest->tv_sec == now.tv_sec && earliest->tv_nsec > now.tv_nsec))
+    {
+        return false;
+    }
+
+    *id = heap->items[0];
+    deadlineHeapRemove(heap, *id);
+    return true;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file deadlineHeap.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for DeadlineHeap, binary
+ * min-heap of IDs ordered by their deadlines
+ *
+ * Every ID from 0 to capacity - 1 is at most once in heap, position of ID in
+ * heap is stored so its deadline can be changed or it can be removed in
+ * logarithmic time. Used by session group, so only sessions whose
+ * retransmission is due are touched when shared timer expires.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DEADLINE_HEAP_H
+#define DEADLINE_HEAP_H 1
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "time.h"
+
+/**
+ * @brief Binary min-heap of IDs, the earliest deadline is on top
+ */
+typedef struct DeadlineHeap {
+    size_t* items; // IDs in heap order
+    size_t* positions; // position of ID in items, len or more if ID is not in heap
+    struct timespec* deadlines; // deadline of ID, valid only if ID is in heap
+    size_t len; // number of IDs in heap
+    size_t capacity; // number of IDs
+} DeadlineHeap;
+
+/**
+ * @brief Initializes empty heap for IDs from 0 to capacity - 1
+ *
+ * @param heap Pointer to the heap
+ * @param capacity Number of IDs
+ * @return true Heap was initialized
+ * @return false Allocation failed
+ */
+bool deadlineHeapInit(DeadlineHeap* heap, size_t capacity);
+
+/**
+ * @brief Frees memory of heap
+ *
+ * @param heap Pointer to the heap
+ */
+void deadlineHeapDestroy(DeadlineHeap* heap);
+
+/**
+ * @brief Adds ID to heap or changes its deadline if it is already in heap
+ *
+ * @param heap Pointer to the heap
+ * @param id ID smaller than capacity of heap
+ * @param deadline New deadline of ID
+ */
+void deadlineHeapSet(DeadlineHeap* heap, size_t id, struct timespec deadline);
+
+/**
+ * @brief Removes ID from heap, nothing is done if ID is not in heap
+ *
+ * @param heap Pointer to the heap
+ * @param id ID smaller than capacity of heap
+ */
+void deadlineHeapRemove(DeadlineHeap* heap, size_t id);
+
+/**
+ * @brief Returns the earliest deadline in heap
+ *
+ * @param heap Pointer to the heap
+ * @param deadline Output of the earliest deadline
+ * @return true Heap is not empty, deadline was set
+ * @return false Heap is empty
+ */
+bool deadlineHeapPeek(DeadlineHeap* heap, struct timespec* deadline);
+
+/**
+ * @brief Removes ID with the earliest deadline from heap if its deadline
+ * is not later than now
+ *
+ * @param heap Pointer to the heap
+ * @param now Current time
+ * @param id Output of removed ID
+ * @return true ID was removed
+ * @return false Heap is empty or no deadline expired
+ */
+bool deadlineHeapPopExpired(DeadlineHeap* heap, struct timespec now, size_t* id);
+
+#endif /*DEADLINE_HEAP_H*/
@@ -0,0 +1,563 @@
+/**
+ * @file ioRing.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of IoRing, optional io_uring backend for sending and
+ * receiving messages
+ *
+ * io_uring is used directly through system calls, rings shared with kernel
+ * are mapped into memory and accessed with acquire/release atomics.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+// struct msghdr, MAP_ANONYMOUS, syscall()
+#define _DEFAULT_SOURCE
+
+#include "ioRing.h"
+
+#ifdef IO_URING
+
+#include "errno.h"
+#include "sys/mman.h"
+#include "sys/syscall.h"
+#include "linux/io_uring.h"
+#include "poll.h"
+
+#define LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+
+// id of group of provided buffers
+#define IO_RING_BUFFER_GROUP 0
+// user data of completion of poll on wake descriptor, receives have 0
+#define IO_RING_WAKE_DATA 1
+
+/**
+ * @brief Structure holding memory shared with kernel and messages that
+ * are being sended or received
+ */
+struct IoRing {
+    int fd;
+
+    // submission queue
+    void* sqRing;
+    size_t sqRingSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+
+    // completion queue
+    void* cqRing;
+    size_t cqRingSize;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+
+    // prepared sends, message data are copied because they can be deleted
+    // from queue before they are sended
+    unsigned sendsPrepared;
+    struct msghdr sendHeaders[IO_RING_ENTRIES];
+    struct iovec sendIovs[IO_RING_ENTRIES];
+    struct sockaddr_storage sendAddresses[IO_RING_ENTRIES];
+    char sendData[IO_RING_ENTRIES][IO_RING_SEND_SLOT_SIZE];
+
+    // provided buffers for multishot receiving
+    struct io_uring_buf_ring* bufRing;
+    size_t bufRingSize;
+    char* recvBuffers;
+    struct msghdr recvHeader; // only size of address is used by kernel
+    bool recvArmed; // multishot recvmsg is active
+    bool wakeArmed; // poll on wake descriptor is active
+    int recvBufferId; // buffer of last received message, -1 if none
+};
+
+// ----------------------------------------------------------------------------
+// System calls
+// ----------------------------------------------------------------------------
+
+int ioRingSetup(unsigned entries, struct io_uring_params* params)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioRingEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+    void* arg, size_t argSize)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize);
+}
+
+int ioRingRegister(int fd, unsigned opcode, void* arg, unsigned argCount)
+{
+    return (int) syscall(__NR_io_uring_register, fd, opcode, arg, argCount);
+}
+
+// ----------------------------------------------------------------------------
+// Queues
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Returns next free submission queue entry, it is passed to kernel
+ * after ioRingCommitSqe() is called
+ */
+struct io_uring_sqe* ioRingGetSqe(IoRing* ring)
+{
+    unsigned tail = *(ring->sqTail);
+    unsigned index = tail & *(ring->sqMask);
+
+    struct io_uring_sqe* sqe = &(ring->sqes[index]);
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sqArray[index] = index;
+
+    return sqe;
+}
+
+/**
+ * @brief Makes last entry returned by ioRingGetSqe() visible to kernel
+ */
+void ioRingCommitSqe(IoRing* ring)
+{
+    STORE_RELEASE(ring->sqTail, *(ring->sqTail) + 1);
+}
+
+/**
+ * @brief Returns oldest unprocessed completion or NULL if there is none
+ */
+struct io_uring_cqe* ioRingPeekCqe(IoRing* ring)
+{
+    unsigned head = *(ring->cqHead);
+    if(head == LOAD_ACQUIRE(ring->cqTail)) { return NULL; }
+
+    return &(ring->cqes[head & *(ring->cqMask)]);
+}
+
+/**
+ * @brief Marks oldest completion as processed
+ */
+void ioRingSeenCqe(IoRing* ring)
+{
+    STORE_RELEASE(ring->cqHead, *(ring->cqHead) + 1);
+}
+
+/**
+ * @brief Gives provided buffer to the kernel so it can be used for receiving
+ */
+void ioRingProvideBuffer(IoRing* ring, unsigned short bufferId)
+{
+    unsigned short tail = ring->bufRing->tail;
+    struct io_uring_buf* buf = &(ring->bufRing->bufs[tail & (IO_RING_RECV_BUFFERS - 1)]);
+
+    buf->addr = (unsigned long) (ring->recvBuffers + bufferId * IO_RING_RECV_BUFFER_SIZE);
+    buf->len = IO_RING_RECV_BUFFER_SIZE;
+    buf->bid = bufferId;
+
+    STORE_RELEASE(&(ring->bufRing->tail), (unsigned short) (tail + 1));
+}
+
+// ----------------------------------------------------------------------------
+// Creation
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Registers provided buffer ring that is used for multishot receiving
+ *
+ * @return true Success
+ * @return false Kernel doesn't support provided buffer rings
+ */
+bool ioRingSetupReceiving(IoRing* ring)
+{
+    ring->bufRingSize = IO_RING_RECV_BUFFERS * sizeof(struct io_uring_buf);
+    ring->bufRing = mmap(NULL, ring->bufRingSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ring->bufRing == MAP_FAILED) { ring->bufRing = NULL; return false; }
+
+    ring->recvBuffers = (char*) malloc(IO_RING_RECV_BUFFERS * IO_RING_RECV_BUFFER_SIZE);
+    if(ring->recvBuffers == NULL) { return false; }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long) ring->bufRing;
+    reg.ring_entries = IO_RING_RECV_BUFFERS;
+    reg.bgid = IO_RING_BUFFER_GROUP;
+
+    if(ioRingRegister(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        return false;
+    }
+
+    for(unsigned short i = 0; i < IO_RING_RECV_BUFFERS; i++)
+    {
+        ioRingProvideBuffer(ring, i);
+    }
+
+    // kernel stores sender address in front of message, its size is
+    // given by the header
+    memset(&(ring->recvHeader), 0, sizeof(struct msghdr));
+    ring->recvHeader.msg_namelen = sizeof(struct sockaddr_storage);
+
+    return true;
+}
+
+/**
+ * @brief Creates new io_uring instance
+ *
+ * @param receiving If true, provided buffer ring for receiving is registered
+ * @return IoRing* Created ring or NULL if io_uring is not available
+ */
+IoRing* ioRingCreate(bool receiving)
+{
+    IoRing* ring = (IoRing*) calloc(1, sizeof(IoRing));
+    if(ring == NULL) { return NULL; }
+    ring->recvBufferId = -1;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = ioRingSetup(IO_RING_ENTRIES, &params);
+    if(ring->fd < 0 || !(params.features & IORING_FEAT_EXT_ARG))
+    {
+        if(ring->fd >= 0) { close(ring->fd); }
+        free(ring);
+        return NULL;
+    }
+
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+    if(ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        if(ring->sqRing == MAP_FAILED) { ring->sqRing = NULL; }
+        if(ring->cqRing == MAP_FAILED) { ring->cqRing = NULL; }
+        if(ring->sqes == MAP_FAILED) { ring->sqes = NULL; }
+        ioRingDestroy(ring);
+        return NULL;
+    }
+
+    char* sq = (char*) ring->sqRing;
+    ring->sqHead = (unsigned*) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned*) (sq + params.sq_off.tail);
+    ring->sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*) (sq + params.sq_off.array);
+
+    char* cq = (char*) ring->cqRing;
+    ring->cqHead = (unsigned*) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned*) (cq + params.cq_off.tail);
+    ring->cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+    if(receiving && !ioRingSetupReceiving(ring))
+    {
+        ioRingDestroy(ring);
+        return NULL;
+    }
+
+    return ring;
+}
+
+/**
+ * @brief Destroys ring and frees its resources
+ *
+ * @param ring Pointer to the ring, can be NULL
+ */
+void ioRingDestroy(IoRing* ring)
+{
+    if(ring == NULL) { return; }
+
+    // closing ring cancels armed multishot receive as well
+    close(ring->fd);
+
+    if(ring->sqRing != NULL) { munmap(ring->sqRing, ring->sqRingSize); }
+    if(ring->cqRing != NULL) { munmap(ring->cqRing, ring->cqRingSize); }
+    if(ring->sqes != NULL) { munmap(ring->sqes, ring->sqesSize); }
+    if(ring->bufRing != NULL) { munmap(ring->bufRing, ring->bufRingSize); }
+    free(ring->recvBuffers);
+    free(ring);
+}
+
+// ----------------------------------------------------------------------------
+// Sending
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Copies message into ring and prepares its sending, message is
+ * sended by ioRingFlushSends()
+ *
+ * @param ring Pointer to the ring
+ * @param socket Socket through which message will be sended
+ * @param data Message to be sended
+ * @param len Length of message
+ * @param address Address of receiver
+ * @param addressLen Length of address
+ * @return true Message was prepared
+ * @return false Message is too big, it must be sended without ring
+ */
+bool ioRingPrepareSend(IoRing* ring, int socket, const char* data, size_t len,
+    struct sockaddr* address, socklen_t addressLen)
+{
+    if(len > IO_RING_SEND_SLOT_SIZE || addressLen > sizeof(struct sockaddr_storage))
+    {
+        return false;
+    }
+
+    // batch is full, send it
+    if(ring->sendsPrepared == IO_RING_ENTRIES && ioRingFlushSends(ring) != 0)
+    {
+        errHandling("Sending bytes was not successful", err_COMMUNICATION);
+    }
+
+    unsigned slot = ring->sendsPrepared;
+    memcpy(ring->sendData[slot], data, len);
+    memcpy(&(ring->sendAddresses[slot]), address, addressLen);
+
+    ring->sendIovs[slot].iov_base = ring->sendData[slot];
+    ring->sendIovs[slot].iov_len = len;
+
+    struct msghdr* header = &(ring->sendHeaders[slot]);
+    memset(header, 0, sizeof(struct msghdr));
+    header->msg_name = &(ring->sendAddresses[slot]);
+    header->msg_namelen = addressLen;
+    header->msg_iov = &(ring->sendIovs[slot]);
+    header->msg_iovlen = 1;
+
+    struct io_uring_sqe* sqe = ioRingGetSqe(ring);
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = socket;
+    sqe->addr = (unsigned long) header;
+    sqe->len = 1;
+    sqe->user_data = slot;
+    ioRingCommitSqe(ring);
+
+    ring->sendsPrepared += 1;
+    return true;
+}
+
+/**
+ * @brief Submits all prepared messages with one system call and waits until
+ * they are sended. Messages are sended in same order as they were prepared.
+ *
+ * @param ring Pointer to the ring
+ * @return int 0 on success, negative errno of first failed send otherwise
+ */
+int ioRingFlushSends(IoRing* ring)
+{
+    unsigned prepared = ring->sendsPrepared;
+    if(prepared == 0) { return 0; }
+
+    // link sends so they are executed in order even if some of them
+    // has to wait for free space in socket
+    for(unsigned i = 1; i < prepared; i++)
+    {
+        unsigned index = (*(ring->sqTail) - prepared + i - 1) & *(ring->sqMask);
+        ring->sqes[index].flags |= IOSQE_IO_LINK;
+    }
+
+    int result = 0;
+    unsigned submitted = 0;
+    unsigned completed = 0;
+    while(completed < prepared)
+    {
+        int res = ioRingEnter(ring->fd, prepared - submitted, prepared - completed,
+            IORING_ENTER_GETEVENTS, NULL, 0);
+        if(res < 0 && errno != EINTR) { result = -errno; break; }
+        if(res > 0) { submitted += res; }
+
+        struct io_uring_cqe* cqe;
+        while((cqe = ioRingPeekCqe(ring)) != NULL)
+        {
+            if(cqe->res < 0 && result == 0) { result = cqe->res; }
+            ioRingSeenCqe(ring);
+            completed += 1;
+        }
+    }
+
+    ring->sendsPrepared = 0;
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Receiving
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Starts multishot recvmsg, one request receives messages until
+ * provided buffers run out
+ */
+void ioRingArmReceive(IoRing* ring, int socket)
+{
+    struct io_uring_sqe* sqe = ioRingGetSqe(ring);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket;
+    sqe->addr = (unsigned long) &(ring->recvHeader);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IO_RING_BUFFER_GROUP;
+    ioRingCommitSqe(ring);
+
+    ring->recvArmed = true;
+}
+
+/**
+ * @brief Starts poll on wake descriptor, its completion interrupts waiting 
+ * for received message
+ */
+void ioRingArmWake(IoRing* ring, int wakeFd)
+{
+    struct io_uring_sqe* sqe = ioRingGetSqe(ring);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeFd;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = IO_RING_WAKE_DATA;
+    ioRingCommitSqe(ring);
+
+    ring->wakeArmed = true;
+}
+
+/**
+ * @brief Waits for next received message. Message stays in provided buffer
+ * until ioRingReleaseReceived() is called.
+ *
+ * @param ring Pointer to the ring
+ * @param socket Socket on which messages are received
+ * @param data Output pointer to the received message
+ * @param address Output address of sender, can be NULL
+ * @param addressLen Size of address on input, length of sender address
+ * on output
+ * @param wakeFd Descriptor that interrupts waiting when it becomes readable,
+ * -1 if waiting can't be interrupted
+ * @return ssize_t Length of message, 0 if connection was closed, negative
+ * value if nothing was received (waiting was interrupted)
+ */
+ssize_t ioRingReceive(IoRing* ring, int socket, char** data,
+    struct sockaddr* address, socklen_t* addressLen, int wakeFd)
+{
+    unsigned toSubmit = 0;
+    if(!ring->recvArmed)
+    {
+        ioRingArmReceive(ring, socket);
+        toSubmit += 1;
+    }
+    if(!ring->wakeArmed && wakeFd >= 0)
+    {
+        ioRingArmWake(ring, wakeFd);
+        toSubmit += 1;
+    }
+
+    struct io_uring_cqe* cqe = ioRingPeekCqe(ring);
+    if(cqe == NULL)
+    {
+        ioRingEnter(ring->fd, toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        cqe = ioRingPeekCqe(ring);
+        // waiting was interrupted by signal
+        if(cqe == NULL) { return -1; }
+    }
+
+    int res = cqe->res;
+    unsigned flags = cqe->flags;
+    uint64_t userData = cqe->user_data;
+    ioRingSeenCqe(ring);
+
+    // wake descriptor became readable
+    if(userData == IO_RING_WAKE_DATA)
+    {
+        ring->wakeArmed = false;
+        return -1;
+    }
+
+    // multishot receive ended (no free buffers, error), it has to be armed again
+    if(!(flags & IORING_CQE_F_MORE)) { ring->recvArmed = false; }
+
+    if(!(flags & IORING_CQE_F_BUFFER))
+    {
+        // ran out of buffers, messages will be received after rearming
+        return res == 0 ? 0 : -1;
+    }
+
+    ring->recvBufferId = flags >> IORING_CQE_BUFFER_SHIFT;
+    char* buffer = ring->recvBuffers + ring->recvBufferId * IO_RING_RECV_BUFFER_SIZE;
+
+    // buffer: header, address (size from recvHeader), message
+    struct io_uring_recvmsg_out* out = (struct io_uring_recvmsg_out*) buffer;
+    char* name = buffer + sizeof(struct io_uring_recvmsg_out);
+    char* payload = name + ring->recvHeader.msg_namelen;
+    size_t maxPayload = res - (payload - buffer);
+
+    if(address != NULL && out->namelen > 0)
+    {
+        socklen_t nameLen = out->namelen < *addressLen ? out->namelen : *addressLen;
+        memcpy(address, name, nameLen);
+        *addressLen = nameLen;
+    }
+
+    *data = payload;
+    return out->payloadlen < maxPayload ? out->payloadlen : maxPayload;
+}
+
+/**
+ * @brief Returns buffer of last received message back to kernel
+ *
+ * @param ring Pointer to the ring
+ */
+void ioRingReleaseReceived(IoRing* ring)
+{
+    if(ring->recvBufferId < 0) { return; }
+
+    ioRingProvideBuffer(ring, (unsigned short) ring->recvBufferId);
+    ring->recvBufferId = -1;
+}
+
+#else /*IO_URING*/
+
+// ----------------------------------------------------------------------------
+// Program was compiled without io_uring, sendto() and recvfrom() are used
+// ----------------------------------------------------------------------------
+
+IoRing* ioRingCreate(bool receiving)
+{
+    if(receiving) {} // anti-error--compiler
+    return NULL;
+}
+
+void ioRingDestroy(IoRing* ring)
+{
+    if(ring) {} // anti-error--compiler
+}
+
+bool ioRingPrepareSend(IoRing* ring, int socket, const char* data, size_t len,
+    struct sockaddr* address, socklen_t addressLen)
+{
+    if(ring || socket || data || len || address || addressLen) {} // anti-error--compiler
+    return false;
+}
+
+int ioRingFlushSends(IoRing* ring)
+{
+    if(ring) {} // anti-error--compiler
+    return 0;
+}
+
+ssize_t ioRingReceive(IoRing* ring, int socket, char** data,
+    struct sockaddr* address, socklen_t* addressLen, int wakeFd)
+{
+    if(ring || socket || data || address || addressLen || wakeFd) {} // anti-error--compiler
+    return -1;
+}
+
+void ioRingReleaseReceived(IoRing* ring)
+{
+    if(ring) {} // anti-error--compiler
+}
+
+#endif /*IO_URING*/
@@ -0,0 +1,104 @@
+/**
+ * @file ioRing.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for IoRing, optional
+ * io_uring backend for sending and receiving messages
+ *
+ * Backend is compiled only with IO_URING defined (make IO=uring), otherwise
+ * ioRingCreate() always fails and program uses sendto()/recvfrom(). Program
+ * falls back to them as well if kernel doesn't support needed features.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef IO_RING_H
+#define IO_RING_H 1
+
+#include "sys/socket.h"
+
+#include "utils.h"
+
+// number of submission queue entries, maximal number of sends in one batch
+#define IO_RING_ENTRIES 32
+// maximal size of message that can be sended in batch, bigger messages
+// are sended right away
+#define IO_RING_SEND_SLOT_SIZE 2048
+// number of buffers provided to kernel for receiving, must be power of 2
+#define IO_RING_RECV_BUFFERS 64
+// size of one provided buffer (header + address + message)
+#define IO_RING_RECV_BUFFER_SIZE 2048
+
+/**
+ * @brief IoRing is io_uring instance used by one thread, either for batched
+ * sending of messages or for receiving messages with multishot recvmsg into
+ * provided buffer ring
+ */
+typedef struct IoRing IoRing;
+
+/**
+ * @brief Creates new io_uring instance
+ *
+ * @param receiving If true, provided buffer ring for receiving is registered
+ * @return IoRing* Created ring or NULL if io_uring is not available
+ */
+IoRing* ioRingCreate(bool receiving);
+
+/**
+ * @brief Destroys ring and frees its resources
+ *
+ * @param ring Pointer to the ring, can be NULL
+ */
+void ioRingDestroy(IoRing* ring);
+
+/**
+ * @brief Copies message into ring and prepares its sending, message is
+ * sended by ioRingFlushSends()
+ *
+ * @param ring Pointer to the ring
+ * @param socket Socket through which message will be sended
+ * @param data Message to be sended
+ * @param len Length of message
+ * @param address Address of receiver
+ * @param addressLen Length of address
+ * @return true Message was prepared
+ * @return false Message is too big, it must be sended without ring
+ */
+bool ioRingPrepareSend(IoRing* ring, int socket, const char* data, size_t len,
+    struct sockaddr* address, socklen_t addressLen);
+
+/**
+ * @brief Submits all prepared messages with one system call and waits until
+ * they are sended. Messages are sended in same order as they were prepared.
+ *
+ * @param ring Pointer to the ring
+ * @return int 0 on success, negative errno of first failed send otherwise
+ */
+int ioRingFlushSends(IoRing* ring);
+
+/**
+ * @brief Waits for next received message. Message stays in provided buffer
+ * until ioRingReleaseReceived() is called.
+ *
+ * @param ring Pointer to the ring
+ * @param socket Socket on which messages are received
+ * @param data Output pointer to the received message
+ * @param address Output address of sender, can be NULL
+ * @param addressLen Size of address on input, length of sender address
+ * on output
+ * @param wakeFd Descriptor that interrupts waiting when it becomes readable,
+ * -1 if waiting can't be interrupted
+ * @return ssize_t Length of message, 0 if connection was closed, negative
+ * value if nothing was received (waiting was interrupted)
+ */
+ssize_t ioRingReceive(IoRing* ring, int socket, char** data,
+    struct sockaddr* address, socklen_t* addressLen, int wakeFd);
+
+/**
+ * @brief Returns buffer of last received message back to kernel
+ *
+ * @param ring Pointer to the ring
+ */
+void ioRingReleaseReceived(IoRing* ring);
+
+#endif /*IO_RING_H*/
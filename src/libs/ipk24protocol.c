@@ -11,6 +11,7 @@
  */
 
 #include "ipk24protocol.h"
+#include "charScan.h"
 
 // ----------------------------------------------------------------------------
 //
@@ -27,6 +28,7 @@ void resetProtocolBlocks(ProtocolBlocks* pBlocks)
     pBlocks->first.start = NULL;     pBlocks->first.len = 0;
     pBlocks->second.start = NULL;    pBlocks->second.len = 0;
     pBlocks->third.start = NULL;     pBlocks->third.len = 0;
+    pBlocks->parseError = NULL;      pBlocks->parseErrorAt = 0;
 }
 
 #define ADD_BLOCK_TO_BUFFER(dst, src)           \
@@ -41,6 +43,85 @@ void resetProtocolBlocks(ProtocolBlocks* pBlocks)
     stringReplace(&(dst), src.data, src.used);  \
     ptrPos += src.used;                         \
 
+/**
+ * @brief Assembles MSG or ERR in UDP format, display name is stored with its
+ * '\0' so message is copied as type, MessageID, prefix and contents
+ * 
+ * @param pBlocks Blocks with command type and message contents
+ * @param buffer Output buffer to be trasmited to the server
+ * @param progInt Pointer to ProgramInterface
+ * 
+ * @return Returns true if buffer can be sended to the server
+ */
+bool assembleMessageUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterface* progInt)
+{
+    Buffer* displayName = &(progInt->comDetails->displayName);
+    // check if displayname is stored
+    if(displayName->data == NULL)
+    { 
+        safePrintStderr("System: ChannelID not provided, cannot rename!"
+            "(Did you use /auth before this commands?). Use /help for help.\n");
+        return false;
+    }
+
+    BytesBlock* contents = &(pBlocks->cmd_msg_MsgContents);
+    // type, MessageID (set by sender), DisplayName, 0, MessageContents, 0
+    size_t prefixLen = displayName->used + 1;
+    size_t used = 3 + prefixLen + contents->len + 1;
+    bufferResize(buffer, used);
+
+    pBlocks->type = (uchar2CommandType(pBlocks->type) == cmd_MSG) ? msg_MSG : msg_ERR;
+    buffer->data[0] = (char) pBlocks->type;
+    memcpy(&(buffer->data[3]), displayName->data, prefixLen);
+    memcpy(&(buffer->data[3 + prefixLen]), contents->start, contents->len);
+    buffer->data[used - 1] = '\0';
+    buffer->used = used;
+
+    return true;
+}
+
+/**
+ * @brief Assembles MSG or ERR in TCP format from prefix
+ * "MSG FROM {DisplayName} IS " pre-encoded by setDisplayName() and contents
+ * 
+ * @param pBlocks Blocks with command type and message contents
+ * @param buffer Output buffer to be trasmited to the server
+ * @param progInt Pointer to ProgramInterface
+ * 
+ * @return Returns true if buffer can be sended to the server
+ */
+bool assembleMessageTCP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterface* progInt)
+{
+    Buffer* prefix = &(progInt->comDetails->messagePrefix);
+    // check if displayname is stored
+    if(prefix->data == NULL)
+    { 
+        safePrintStderr("System: ChannelID not provided, cannot rename!"
+            "(Did you use /auth before this commands?). Use /help for help.\n");
+        return false;
+    }
+
+    BytesBlock* contents = &(pBlocks->cmd_msg_MsgContents);
+    size_t used = prefix->used + contents->len + 2;
+    bufferResize(buffer, used);
+
+    memcpy(buffer->data, prefix->data, prefix->used);
+    if(uchar2CommandType(pBlocks->type) == cmd_MSG)
+    {
+        pBlocks->type = msg_MSG;
+    }
+    else
+    {
+        memcpy(buffer->data, "ERR", sizeof("ERR") - 1);
+        pBlocks->type = msg_ERR;
+    }
+    memcpy(&(buffer->data[prefix->used]), contents->start, contents->len);
+    memcpy(&(buffer->data[used - 2]), "\r\n", 2);
+    buffer->used = used;
+
+    return true;
+}
+
 /**
  * @brief Assembles protocol from commands and command type into a buffer
  * 
@@ -53,6 +134,12 @@ void resetProtocolBlocks(ProtocolBlocks* pBlocks)
  */
 bool assembleProtocolUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterface* progInt)
 {
+    cmd_t type = uchar2CommandType(pBlocks->type);
+    // messages are most common, they are assembled from stored prefix
+    if(type == cmd_MSG || type == cmd_ERR)
+    {
+        return assembleMessageUDP(pBlocks, buffer, progInt);
+    }
 
     // calculate expected size and resize buffer accordingly, +10 is overhead for zeroing bytes, msgID, type etc...
     size_t expectedSize = pBlocks->zeroth.len + pBlocks->first.len
@@ -64,7 +151,6 @@ bool assembleProtocolUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
     // resize buffer to needed size
     bufferResize(buffer, expectedSize);
 
-    cmd_t type = uchar2CommandType(pBlocks->type);
     // Set correct message type to buffer, also filter commands that shouldn't be send
     switch (type)
     {
@@ -73,15 +159,6 @@ bool assembleProtocolUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
         // add to expected size
         expectedSize += progInt->comDetails->channelID.used;
         break;
-    case cmd_ERR: 
-        buffer->data[0] = (unsigned char) msg_ERR; 
-        expectedSize += progInt->comDetails->displayName.used;
-        break;
-    case cmd_MSG: 
-        buffer->data[0] = msg_MSG; 
-        // add to expected size
-        expectedSize += progInt->comDetails->displayName.used;
-        break;
     case cmd_CONF: 
         buffer->data[0] = msg_CONF;
         buffer->data[1] = pBlocks->cmd_conf_lowMsgID.start[0];
@@ -140,23 +217,6 @@ bool assembleProtocolUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
         // set type of message to JOIN
         pBlocks->type = msg_JOIN;
         break;
-    case cmd_ERR:
-    case cmd_MSG:
-        // check if displayname is stored
-        if(progInt->comDetails->displayName.data == NULL)
-        { 
-            safePrintStderr("System: ChannelID not provided, cannot rename!"
-                "(Did you use /auth before this commands?). Use /help for help.\n");
-            return false;
-        }
-        // add stored displayname to the messages
-        ADD_STORED_INFO_TO_BUFFER(buffer->data[ptrPos], progInt->comDetails->displayName);
-        ADD_ZERO_BYTE;
-        ADD_BLOCK_TO_BUFFER(buffer->data[ptrPos], pBlocks->cmd_msg_MsgContents);
-        ADD_ZERO_BYTE;
-        // set type of message to MSG or ERR
-        pBlocks->type = (type == cmd_MSG)? msg_MSG : msg_ERR;
-        break;
     default:
         errHandling("Unknown CommandType in assembleProtocolUDP()\n", 
             err_INTERNAL_BAD_ARG);
@@ -186,12 +246,19 @@ bool assembleProtocolUDP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
  */
 bool assembleProtocolTCP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterface* progInt)
 {
+    cmd_t type = uchar2CommandType(pBlocks->type);
+    // messages are most common, they are assembled from pre-encoded prefix
+    if(type == cmd_MSG || type == cmd_ERR)
+    {
+        return assembleMessageTCP(pBlocks, buffer, progInt);
+    }
+
     // calculate expected size and resize buffer accordingly, +1 zero byte.
     size_t expectedSize = pBlocks->zeroth.len + pBlocks->first.len
                         + pBlocks->second.len + pBlocks->third.len + 1;
 
     // based on command increase expected size of buffer
-    switch (uchar2CommandType(pBlocks->type))
+    switch (type)
     {
     case cmd_AUTH:
         // expectedSize += sizeof("AUTH ") - 1;
@@ -205,14 +272,6 @@ bool assembleProtocolTCP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
         expectedSize += 5 + 4;
         expectedSize += progInt->comDetails->channelID.used;
         break;
-    case cmd_MSG:
-    case cmd_ERR: // err and message are same
-        // expectedSize += sizeof("MSG FROM ") -1;
-        // expectedSize += sizeof("ERR FROM ") -1;
-        // expectedSize += sizeof(" IS ") -1;
-        expectedSize += 9 + 4; 
-        expectedSize += progInt->comDetails->displayName.used;
-        break;
     case cmd_EXIT:
         // expectedSize += sizeof("BYE") -1;
         expectedSize += 3;
@@ -230,7 +289,7 @@ bool assembleProtocolTCP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
     bufferResize(buffer, expectedSize);
     size_t ptrPos = 0;
 
-    switch (uchar2CommandType(pBlocks->type))
+    switch (type)
     {
     case cmd_AUTH:
         ADD_STRING_TO_BUFFER(buffer->data[0], "AUTH ");
@@ -241,32 +300,6 @@ bool assembleProtocolTCP(ProtocolBlocks* pBlocks, Buffer* buffer, ProgramInterfa
         ADD_BLOCK_TO_BUFFER(buffer->data[ptrPos], pBlocks->cmd_auth_secret);
 
         pBlocks->type = msg_AUTH;
-        break;
-    case cmd_MSG:
-    case cmd_ERR: // err and msg are same
-        // check if displayname is stored
-        if(progInt->comDetails->displayName.data == NULL)
-            { 
-                safePrintStderr("System: ChannelID not provided, cannot rename!"
-                    "(Did you use /auth before this commands?). Use /help for help.\n");
-                return false;
-        }
-
-        if(uchar2CommandType(pBlocks->type) == cmd_MSG)
-        {
-            ADD_STRING_TO_BUFFER(buffer->data[0], "MSG FROM ");
-            pBlocks->type = msg_MSG;
-        }
-        else
-        { 
-            ADD_STRING_TO_BUFFER(buffer->data[0], "ERR FROM ");
-            pBlocks->type = msg_ERR;
-        }
-
-        ADD_STORED_INFO_TO_BUFFER(buffer->data[ptrPos], progInt->comDetails->displayName);
-        ADD_STRING_TO_BUFFER(buffer->data[ptrPos], " IS ");
-        ADD_BLOCK_TO_BUFFER(buffer->data[ptrPos], pBlocks->cmd_msg_MsgContents);
-
         break;
     case cmd_JOIN:
         // check if displayname is stored
@@ -320,6 +353,8 @@ void disassebleProtocolUDP(Buffer* buffer, ProtocolBlocks* pBlocks, uint16_t* ms
 {
     size_t index; // Temporaty helping variable to hold index in string
 
+    pBlocks->parseError = NULL;
+
     // Get msg type
     pBlocks->type = uchar2msgType((unsigned char) buffer->data[0] );
     
@@ -400,185 +435,203 @@ void disassebleProtocolUDP(Buffer* buffer, ProtocolBlocks* pBlocks, uint16_t* ms
     return;
 }
 
-#define MSG_FROM_TEXT "MSG FROM "
-#define IS_TEXT " IS "
-#define REPLY_TEXT "REPLY "
-#define REPLY_OK_TEXT "OK IS "
-#define REPLY_NOK_TEXT "NOK IS "
-#define BYE_TEXT "BYE"
-#define ERR_FROM_TEXT "ERR FROM "
+/**
+ * @brief Returns lower case variant of letter, other characters are 
+ * returned unchanged
+ * 
+ * @param input Input character
+ * @return char Case folded character
+ */
+char tcpFoldCase(char input)
+{
+    return (input >= 'A' && input <= 'Z') ? (char) (input | 0x20) : input;
+}
+
+/**
+ * @brief Marks message as malformed and stores where and why parsing failed
+ * 
+ * @param pBlocks ProtocolBlocks of parsed message
+ * @param pos Offset of byte at which parsing failed
+ * @param description Description of expected input
+ * @return false Always, so it can be returned by parsing functions
+ */
+bool tcpParseFailed(ProtocolBlocks* pBlocks, size_t pos, const char* description)
+{
+    if(pBlocks->type != msg_UNKNOWN) { pBlocks->type = msg_CORRUPTED; }
+    pBlocks->parseError = description;
+    pBlocks->parseErrorAt = pos;
+    return false;
+}
 
 #define LEN_OF(constString) (sizeof(constString) - 1)
+
+/**
+ * @brief Matches keyword case-insensitively at the start of string
+ * 
+ * @param string String to be matched
+ * @param len Length of string
+ * @param keyword Keyword
+ * @param keywordLen Length of keyword
+ * @return size_t Number of matching characters, keywordLen if whole 
+ * keyword matches
+ */
+size_t tcpMatchKeyword(const char* string, size_t len, const char* keyword, size_t keywordLen)
+{
+    size_t index = 0;
+    while(index < keywordLen && index < len && 
+        tcpFoldCase(string[index]) == tcpFoldCase(keyword[index]))
+    {
+        index++;
+    }
+    return index;
+}
+
+// servers send keywords in upper case, such keyword is compared at once by 
+// memcmp() of constant length, tcpMatchKeyword() is used only otherwise
+#define TCP_MATCH_KEYWORD(string, len, keyword)                                 \
+    (((len) >= LEN_OF(keyword) && memcmp(string, keyword, LEN_OF(keyword)) == 0) ? \
+        LEN_OF(keyword) : tcpMatchKeyword(string, len, keyword, LEN_OF(keyword)))
+
 /**
  * @brief Dissassembles protocol from Buffer into commands, msgType and msgId
- * for TCP variant
+ * for TCP variant. Message is parsed in one pass, keywords are case 
+ * insensitive, malformed message has type msg_CORRUPTED (msg_UNKNOWN if 
+ * type was not recognized) and parseError describes the problem.
  * @param buffer Input buffer containing message
  * @param pBlocks Separated commands and values from user input
- * @param msgId Detected message ID 
  */
 void disassebleProtocolTCP(Buffer* buffer, ProtocolBlocks* pBlocks)
 {
-    size_t index;
+    char* data = buffer->data;
+    size_t used = buffer->used;
+    size_t pos;
+    size_t keywordLen; // length of keyword that is expected
+    const char* expected; // error if keyword does not match
 
-    if ( strncmp(buffer->data, MSG_FROM_TEXT, LEN_OF(MSG_FROM_TEXT)) == 0 )
-    {
-        pBlocks->msg_msg_displayname.start = &(buffer->data[LEN_OF(MSG_FROM_TEXT)]);
-        // find end of displayname after sizeof("MSG FROM ") =  len: 9 (\0 not counted)
-        index = findBlankCharInString(pBlocks->msg_msg_displayname.start, buffer->used - LEN_OF(MSG_FROM_TEXT));
-        pBlocks->msg_msg_displayname.len = index;
-        
-        // check if there is " IS " correctly typed after {displayname}
-        if(strncmp(BBLOCK_END(pBlocks->msg_msg_displayname), IS_TEXT, LEN_OF(IS_TEXT)) != 0)
-        {
-            pBlocks->type = msg_CORRUPTED;
-            return;
-        }
-
-        // set start of the message contets after displayname and add " IS " to it
-        pBlocks->msg_msg_MsgContents.start = 
-            &(pBlocks->msg_msg_displayname.start[pBlocks->msg_msg_displayname.len + 
-            LEN_OF(IS_TEXT)]);
+    pBlocks->parseError = NULL;
+    pBlocks->parseErrorAt = 0;
 
-        // find end of message contents
-        index = findNewLineInString(pBlocks->msg_msg_MsgContents.start, 
-            buffer->used - LEN_OF(MSG_FROM_TEXT) - pBlocks->msg_msg_displayname.len);
-            
-        pBlocks->msg_msg_MsgContents.len = index;
+    // type of message is decided by its first character
+    switch((used > 0) ? tcpFoldCase(data[0]) : '\0')
+    {
+    case 'm':
         pBlocks->type = msg_MSG;
+        pos = TCP_MATCH_KEYWORD(data, used, "MSG FROM ");
+        keywordLen = LEN_OF("MSG FROM ");
+        expected = "expected \"MSG FROM \"";
+        break;
+    case 'e':
+        pBlocks->type = msg_ERR;
+        pos = TCP_MATCH_KEYWORD(data, used, "ERR FROM ");
+        keywordLen = LEN_OF("ERR FROM ");
+        expected = "expected \"ERR FROM \"";
+        break;
+    case 'r':
+        pBlocks->type = msg_REPLY;
+        pos = TCP_MATCH_KEYWORD(data, used, "REPLY ");
+        keywordLen = LEN_OF("REPLY ");
+        expected = "expected \"REPLY \"";
+        break;
+    case 'b':
+        pBlocks->type = msg_BYE;
+        pos = TCP_MATCH_KEYWORD(data, used, "BYE\r\n");
+        keywordLen = LEN_OF("BYE\r\n");
+        expected = "expected \"BYE\\r\\n\"";
+        break;
+    default:
+        pBlocks->type = msg_UNKNOWN;
+        tcpParseFailed(pBlocks, 0, "unknown message type");
+        return;
     }
-    else if ( strncmp(buffer->data, REPLY_TEXT, LEN_OF(REPLY_TEXT)) == 0 )
+
+    if(pos != keywordLen)
+    {
+        tcpParseFailed(pBlocks, pos, expected);
+        return;
+    }
+    if(pBlocks->type == msg_BYE) { return; }
+
+    BytesBlock* contents;
+    if(pBlocks->type == msg_REPLY)
     {
-        // store result of reply
-        pBlocks->msg_reply_result.start = &(buffer->data[LEN_OF(REPLY_TEXT)]); 
-        if(strncmp(pBlocks->msg_reply_result.start,
-            REPLY_OK_TEXT, LEN_OF(REPLY_OK_TEXT)) == 0)
+        // {"OK"|"NOK"}
+        pBlocks->msg_reply_result.start = &(data[pos]);
+        pBlocks->msg_reply_result_bool = (pos < used && tcpFoldCase(data[pos]) == 'o');
+        if(pBlocks->msg_reply_result_bool)
         {
-            pBlocks->msg_reply_result.len = 2;
-            pBlocks->msg_reply_result_bool = true; 
-        } 
-        else if(strncmp(&(buffer->data[LEN_OF(REPLY_TEXT)]), 
-            REPLY_NOK_TEXT, LEN_OF(REPLY_NOK_TEXT)) == 0)
+            pBlocks->msg_reply_result.len = TCP_MATCH_KEYWORD(&(data[pos]), used - pos, "OK");
+            keywordLen = LEN_OF("OK");
+        }
+        else
         {
-            pBlocks->msg_reply_result.len = 3;
-            pBlocks->msg_reply_result_bool = false; 
-
+            pBlocks->msg_reply_result.len = TCP_MATCH_KEYWORD(&(data[pos]), used - pos, "NOK");
+            keywordLen = LEN_OF("NOK");
+        }
+        pos += pBlocks->msg_reply_result.len;
+        if(pBlocks->msg_reply_result.len != keywordLen)
+        {
+            tcpParseFailed(pBlocks, pos, "expected \"OK\" or \"NOK\"");
+            return;
         }
-        else { pBlocks->type = msg_CORRUPTED; return; }
-
-        // find end of message contents after sizeof("{RESULT} IS "), + sizeof(" IS ") = len: 4 (\0 not counted)
-        pBlocks->msg_reply_MsgContents.start = 
-            &(pBlocks->msg_reply_result.start
-                [pBlocks->msg_reply_result.len + LEN_OF(IS_TEXT)]);
-
-        index = findBlankCharInString(pBlocks->msg_reply_MsgContents.start, buffer->used - 
-            (LEN_OF(REPLY_TEXT) + pBlocks->msg_reply_result.len) );
 
-        // set start of msgContents right after "{RESULT} IS "
-        pBlocks->msg_reply_MsgContents.len = index;
-        pBlocks->type = msg_REPLY;
-    }
-    else if ( strncmp(buffer->data, BYE_TEXT, LEN_OF(BYE_TEXT)) == 0 )
-    {
-        pBlocks->type = msg_BYE;
+        contents = &(pBlocks->msg_reply_MsgContents);
+        expected = "expected \" IS \" after result";
     }
-    else if ( strncmp(buffer->data, ERR_FROM_TEXT, LEN_OF(ERR_FROM_TEXT)) == 0 )
+    else
     {
-        pBlocks->msg_err_displayname.start = &(buffer->data[LEN_OF(MSG_FROM_TEXT)]);
-        // find end of displayname after sizeof("MSG FROM ") =  len: 9 (\0 not counted)
-        index = findBlankCharInString(pBlocks->msg_err_displayname.start, buffer->used - LEN_OF(MSG_FROM_TEXT));
-        pBlocks->msg_err_displayname.len = index;
-        
-        // check if there is " IS " correctly typed after {displayname}
-        if(strncmp(BBLOCK_END(pBlocks->msg_err_displayname), IS_TEXT, LEN_OF(IS_TEXT)) != 0)
+        // {DisplayName} of MSG and ERR
+        pBlocks->zeroth.start = &(data[pos]);
+        pBlocks->zeroth.len = charScanner.findBlank(pBlocks->zeroth.start, used - pos);
+        pos += pBlocks->zeroth.len;
+
+        if(pBlocks->zeroth.len == 0)
         {
-            pBlocks->type = msg_CORRUPTED;
+            tcpParseFailed(pBlocks, pos, "expected display name");
+            return;
+        }
+        if(pos < used && data[pos] != ' ')
+        {
+            tcpParseFailed(pBlocks, pos, "invalid character in display name");
             return;
         }
 
-        // set start of the message contets after displayname and add " IS " to it
-        pBlocks->msg_err_MsgContents.start = 
-            &(pBlocks->msg_err_displayname.start[pBlocks->msg_err_displayname.len + 
-            LEN_OF(IS_TEXT)]);
-
-        // find end of message contents
-        index = findNewLineInString(pBlocks->msg_err_MsgContents.start, 
-            buffer->used - LEN_OF(MSG_FROM_TEXT) - pBlocks->msg_err_displayname.len);
-            
-        pBlocks->msg_err_MsgContents.len = index;
-        pBlocks->type = msg_ERR;
+        contents = &(pBlocks->first);
+        expected = "expected \" IS \" after display name";
     }
-    else
+
+    size_t matched = TCP_MATCH_KEYWORD(&(data[pos]), used - pos, " IS ");
+    pos += matched;
+    if(matched != LEN_OF(" IS "))
     {
-        pBlocks->type = msg_UNKNOWN;
+        tcpParseFailed(pBlocks, pos, expected);
         return;
     }
 
-    return;
-}
+    // {MessageContent}\r\n, message ends by the first "\r\n" (it is received that way)
+    contents->start = &(data[pos]);
+    contents->len = charScanner.findNewLine(contents->start, used - pos);
+    pos += contents->len;
 
-/**
- * @brief Checks if input character is alligable to be in credentials 
- * 
- * @param input Input character
- * @return true Character is alligable
- * @return false Character is not alligable
- */
-bool allowedCharsInCredentials(char input)
-{
-    if(input >= 'a' && input <= 'z')
-        return true;
-    else if(input >= 'A' && input <= 'Z')
-        return true;
-    else if(input >= '0' && input <= '9')
-        return true;
-    else if(input == '-')
-        return true;
-    #ifdef DEBUG // allow "." in debug mode
-        if(input == '.')
-        {
-            return true;
-        }
-    #endif
-
-    return false;
+    if(pos == used)
+    {
+        tcpParseFailed(pBlocks, pos, "message is not ended by \"\\r\\n\"");
+    }
+    else if(data[pos] == '\0')
+    {
+        tcpParseFailed(pBlocks, pos, "zero byte in message contents");
+    }
+    else if(!(data[pos] == '\r' && pos + 2 == used && data[pos + 1] == '\n'))
+    {
+        tcpParseFailed(pBlocks, pos, "line break in message contents");
+    }
 }
 
-/**
- * @brief Checks if input character is alligable to be in display name 
- * 
- * @param input Input character
- * @return true Character is alligable
- * @return false Character is not alligable
- */
-bool allowedCharsInName(char input)
-{
-    if(input >= 0x21 && input <= 0x7E)
-        return true;
-
-    return false;
-}  
-
-/**
- * @brief Checks if input character is alligable to be in message contents 
- * 
- * @param input Input character
- * @return true Character is alligable
- * @return false Character is not alligable
- */
-bool allowedCharsInMessage(char input)
-{
-    if(input >= 0x20 && input <= 0x7E)
-        return true;
-        
-    return false;
-}  
-
-// Types of Words
-#define ToW_Username 1
-#define ToW_ChannelID 2
-#define ToW_Secret 3
-#define ToW_DisplayName 4
-#define ToW_MessageContent 5
+// Types of Words, values are classes of characters allowed in them
+#define ToW_Username CHAR_CLASS_CREDENTIALS
+#define ToW_ChannelID CHAR_CLASS_CREDENTIALS
+#define ToW_Secret CHAR_CLASS_CREDENTIALS
+#define ToW_DisplayName CHAR_CLASS_NAME
+#define ToW_MessageContent CHAR_CLASS_MESSAGE
 /**
  * @brief Controls whenever word is valid
  * 
@@ -608,40 +661,20 @@ bool controlWord(BytesBlock* wordBlock, const size_t maxLen, unsigned char typeO
         return false;
     }
     
-    // check all characters in word
-    char correct = true;
-    size_t i = 0;
-    for(; i < wordBlock->len; i++)
+    // check all characters in word, message contents can be long so they 
+    // are checked by vector instructions
+    size_t i;
+    if(typeOfWord == ToW_MessageContent)
     {
-        if( typeOfWord == ToW_Username || typeOfWord == ToW_ChannelID ||
-            typeOfWord == ToW_Secret)
-        {
-            if( !allowedCharsInCredentials(wordBlock->start[i]))
-            {
-                correct = false;
-                break;
-            }
-        }
-        else if(typeOfWord == ToW_DisplayName)
-        {
-            if( !allowedCharsInName(wordBlock->start[i]) )
-            {
-                correct = false;
-                break;
-            }
-        }
-        else if(typeOfWord == ToW_MessageContent)
-        {
-            if( !allowedCharsInMessage(wordBlock->start[i]) )
-            {
-                correct = false;
-                break;
-            }   
-        }
+        i = charScanner.findNotPrintable(wordBlock->start, wordBlock->len);
+    }
+    else
+    {
+        i = charScanFindNotInClass(wordBlock->start, wordBlock->len, typeOfWord);
     }
 
     // if "i" didn't control whole word
-    if(!correct)
+    if(i < wordBlock->len)
     {
         fprintf(stderr, "ERR: Parameter \"");
         for(size_t i = 0; i < wordBlock->len; i++)
@@ -656,19 +689,98 @@ bool controlWord(BytesBlock* wordBlock, const size_t maxLen, unsigned char typeO
     return true;
 }
 
-#undef MSG_FROM_TEXT
-#undef IS_TEXT
-#undef REPLY_TEXT
-#undef REPLY_OK_TEXT
-#undef REPLY_NOK_TEXT
-#undef BYE_TEXT
-#undef ERR_FROM_TEXT
+#undef TCP_MATCH_KEYWORD
+#undef LEN_OF
 #undef BBLOCK_END
 #undef BBLOCK_END_W_ZERO_BYTE
 // ----------------------------------------------------------------------------
 //
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Table of user commands indexed by cmd_t, arguments are stored
+ * in order into first, second and third ProtocolBlocks
+ */
+const UserCommand userCommands[USER_COMMANDS_SIZE] = {
+    [cmd_AUTH] = {
+        .type = cmd_AUTH, .name = "/auth", .nameLen = sizeof("/auth") - 1,
+        .argCount = 3, .lineArgument = false,
+        .maxLen = {20, 128, 20}, .charClass = {ToW_Username, ToW_Secret, ToW_DisplayName},
+        .usage = "{Username} {Secret} {DisplayName}",
+        .help = "Authenticates user to server with data provided from the arguments. "
+            "{Username} and {Secret} are credentials. {Displayname} is name under "
+            "which will user(this) send messages to server."
+    },
+    [cmd_JOIN] = {
+        .type = cmd_JOIN, .name = "/join", .nameLen = sizeof("/join") - 1,
+        .argCount = 1, .lineArgument = true,
+        .maxLen = {20}, .charClass = {ToW_ChannelID},
+        .usage = "{ChannelID}",
+        .help = "Joins user to channel with {ChannelID}"
+    },
+    [cmd_RENAME] = {
+        .type = cmd_RENAME, .name = "/rename", .nameLen = sizeof("/rename") - 1,
+        .argCount = 1, .lineArgument = true,
+        .maxLen = {20}, .charClass = {ToW_DisplayName},
+        .usage = "{DisplayName}",
+        .help = "Renames user to {Displayname}"
+    },
+    [cmd_HELP] = {
+        .type = cmd_HELP, .name = "/help", .nameLen = sizeof("/help") - 1,
+        .argCount = 0, .lineArgument = false,
+        .usage = "",
+        .help = "Prints this help message."
+    },
+    [cmd_EXIT] = {
+        .type = cmd_EXIT, .name = "/exit", .nameLen = sizeof("/exit") - 1,
+        .argCount = 0, .lineArgument = false,
+        .usage = "",
+        .help = "Ends connection with server and exits program."
+    },
+};
+
+/**
+ * @brief Finds user command by its name, commands are distinguished by 
+ * length and first letter after "/" and then whole name is compared
+ * 
+ * @param name Name of command including "/"
+ * @param len Length of name
+ * @return const UserCommand* Found command or NULL if name is not a command
+ */
+const UserCommand* findUserCommand(const char* name, size_t len)
+{
+    // most of user input are messages, they are rejected by first character
+    if(len < 2 || name[0] != '/') { return NULL; }
+
+    const UserCommand* command;
+    switch(len)
+    {
+    case 5:
+        switch(name[1])
+        {
+        case 'a': command = &(userCommands[cmd_AUTH]); break;
+        case 'j': command = &(userCommands[cmd_JOIN]); break;
+        case 'h': command = &(userCommands[cmd_HELP]); break;
+        case 'e': command = &(userCommands[cmd_EXIT]); break;
+        default: return NULL;
+        }
+        break;
+    case 7:
+        if(name[1] != 'r') { return NULL; }
+        command = &(userCommands[cmd_RENAME]);
+        break;
+    default:
+        return NULL;
+    }
+
+    // whole name has to match, not only its length and first letter
+    if(command->nameLen != len || memcmp(name, command->name, len) != 0)
+    {
+        return NULL;
+    }
+    return command;
+}
+
 /**
  * @brief Wrapper around getWord(), if not enough arguments given
  * change all other commands into an message. 
@@ -714,82 +826,55 @@ int userInputToCmds(Buffer* buffer, ProtocolBlocks* pBlocks, msg_flags* flags)
     pBlocks->third = third;
     pBlocks->type = cmd_NONE;
 
-    long error = 0;
-
-    int tmp = -1;
-
-    if(strncmp(cmd.start, "/auth", cmd.len) == 0)
+    const UserCommand* command = findUserCommand(cmd.start, cmd.len);
+    if(command == NULL)
     {
-        // separate words and store in into BytesBlocks
-        TRY_GET_WORD( getWord(&first, &(cmd.start[cmd.len]), buffer->used - (cmd.len)) )
-        TRY_GET_WORD( getWord(&second, &(first.start[first.len]), buffer->used - (cmd.len + first.len)) )
-        TRY_GET_WORD( getWord(&third, &(second.start[second.len]), buffer->used - (cmd.len + first.len + second.len)))
+        // store information into correct ProtocolBlocks parts
+        pBlocks->cmd_msg_MsgContents.start = buffer->data;
+        pBlocks->cmd_msg_MsgContents.len = buffer->used;
+        if(!controlWord(&pBlocks->cmd_msg_MsgContents, 14000, ToW_MessageContent)) { return false; }
 
-        if(!controlWord(&first, 20, ToW_Username)) { return false; }
-        if(!controlWord(&second, 128, ToW_Secret)) { return false; }
-        if(!controlWord(&third, 20, ToW_DisplayName)) { return false; }
+        pBlocks->type = cmd_MSG;
+        return true;
+    }
 
-        // set message flag
-        *flags = msg_flag_AUTH;
+    BytesBlock* args[USER_COMMAND_MAX_ARGS] = {&(pBlocks->first), &(pBlocks->second), &(pBlocks->third)};
+    char* end = &(cmd.start[cmd.len]);
+    long error = 0;
 
-        // store information into correct ProtocolBlocks parts
-        pBlocks->type = cmd_AUTH;
-        pBlocks->cmd_auth_username = first;
-        pBlocks->cmd_auth_secret = second;
-        pBlocks->cmd_auth_displayname = third;
-    }
-    else if(  ((tmp = strncmp(cmd.start, "/join", cmd.len)) == 0) ||
-                    (strncmp(cmd.start, "/rename", cmd.len) == 0))
+    // separate arguments and store them into BytesBlocks
+    for(size_t i = 0; i < command->argCount; i++)
     {
-        // set start at after command 
-        first.start = &(cmd.start[cmd.len]);
-        // find first non white character
-        size_t index = skipBlankCharsInString(first.start, buffer->used - cmd.len);
-        // update first start position
-        first.start = &(first.start[index]);
-        // find end of line in string
-        error = findNewLineInString(first.start, buffer->used - cmd.len);
-
-        IF_ERR_SET_CMDTYPE(cmd_MISSING);
+        size_t left = buffer->used - (size_t) (end - buffer->data);
+        if(command->lineArgument)
+        {
+            // argument is rest of the line without leading blank characters
+            error = skipBlankCharsInString(end, left);
+            IF_ERR_SET_CMDTYPE(cmd_MISSING);
 
-        first.len = (size_t) error;
+            args[i]->start = &(end[error]);
+            error = findNewLineInString(args[i]->start, left - (size_t) error);
+            IF_ERR_SET_CMDTYPE(cmd_MISSING);
 
-        // store information into correct ProtocolBlocks parts
-        // if tmp == 0 join was provided
-        if(tmp == 0)
-        {
-            if(!controlWord(&first, 20, ToW_ChannelID)) { return false; }
-            pBlocks->type = cmd_JOIN;
-            pBlocks->cmd_join_channelID = first;
+            args[i]->len = (size_t) error;
         }
         else
         {
-            if(!controlWord(&first, 20, ToW_DisplayName)) { return false; }
-            pBlocks->type = cmd_RENAME;
-            pBlocks->cmd_rename_displayname = first;     
+            TRY_GET_WORD( getWord(args[i], end, left) )
         }
-            
-    }
-    else if(strncmp(cmd.start, "/help", cmd.len) == 0)
-    {
-        // store information into correct ProtocolBlocks parts
-        pBlocks->type = cmd_HELP;
+        end = &(args[i]->start[args[i]->len]);
     }
-    else if(strncmp(cmd.start, "/exit", cmd.len) == 0)
+
+    // arguments are controlled after all were found, missing one is reported first
+    for(size_t i = 0; i < command->argCount; i++)
     {
-        // store information into correct ProtocolBlocks parts
-        pBlocks->type = cmd_EXIT;
+        if(!controlWord(args[i], command->maxLen[i], command->charClass[i])) { return false; }
     }
-    else
-    {
-        // store information into correct ProtocolBlocks parts
-        pBlocks->cmd_msg_MsgContents.start = buffer->data;
-        pBlocks->cmd_msg_MsgContents.len = buffer->used;
-        if(!controlWord(&pBlocks->cmd_msg_MsgContents, 14000, ToW_MessageContent)) { return false; }
 
-        pBlocks->type = cmd_MSG;
-    }
+    // set message flag
+    if(command->type == cmd_AUTH) { *flags = msg_flag_AUTH; }
 
+    pBlocks->type = command->type;
     return true;
 }
 
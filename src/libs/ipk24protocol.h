@@ -70,8 +70,37 @@ typedef struct ProtocolBlocks {
         bool msg_reply_result_bool;
         
     };
+
+    // description of the first grammar error of received TCP message, 
+    // NULL if message is valid
+    const char* parseError;
+    size_t parseErrorAt; // offset of byte at which the error was found
 } ProtocolBlocks;
 
+// maximal number of arguments of user command (first, second, third)
+#define USER_COMMAND_MAX_ARGS 3
+// size of userCommands, table is indexed by cmd_t
+#define USER_COMMANDS_SIZE (cmd_EXIT + 1)
+
+/**
+ * @brief Description of command that user can enter, one table of commands
+ * drives both parsing of user input and user help menu
+ */
+typedef struct UserCommand {
+    cmd_t type; // type of command stored into ProtocolBlocks
+    const char* name; // name including "/", NULL if cmd_t is not user command
+    size_t nameLen; // length of name
+    size_t argCount; // number of arguments stored into first, second, third
+    bool lineArgument; // argument is rest of the line instead of one word
+    size_t maxLen[USER_COMMAND_MAX_ARGS]; // maximal allowed lengths of arguments
+    unsigned char charClass[USER_COMMAND_MAX_ARGS]; // CHAR_CLASS_* of arguments
+    const char* usage; // arguments as shown in help menu
+    const char* help; // explanation of command shown in help menu
+} UserCommand;
+
+// table of user commands indexed by their cmd_t
+extern const UserCommand userCommands[USER_COMMANDS_SIZE];
+
 /**
  * @brief Sets default values to the ProtocolBlock variable
  * 
@@ -117,10 +146,11 @@ void disassebleProtocolUDP(Buffer* buffer, ProtocolBlocks* pBlocks, uint16_t* ms
 
 /**
  * @brief Dissassembles protocol from Buffer into commands, msgType and msgId
- * for TCP variant
+ * for TCP variant. Message is parsed in one pass, keywords are case 
+ * insensitive, malformed message has type msg_CORRUPTED (msg_UNKNOWN if 
+ * type was not recognized) and parseError describes the problem.
  * @param buffer Input buffer containing message
  * @param pBlocks Separated commands and values from user input
- * @param msgId Detected message ID 
  */
 void disassebleProtocolTCP(Buffer* buffer, ProtocolBlocks* pBlocks);
 
@@ -138,5 +168,15 @@ void disassebleProtocolTCP(Buffer* buffer, ProtocolBlocks* pBlocks);
  */
 int userInputToCmds(Buffer* buffer, ProtocolBlocks* pBlocks, msg_flags* flags);
 
+/**
+ * @brief Finds user command by its name, commands are distinguished by 
+ * length and first letter after "/" and then whole name is compared
+ * 
+ * @param name Name of command including "/"
+ * @param len Length of name
+ * @return const UserCommand* Found command or NULL if name is not a command
+ */
+const UserCommand* findUserCommand(const char* name, size_t len);
+
 
 #endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+ * @file messageIdSet.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of MessageIdSet, bounded set of message IDs received
+ * from server
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stdlib.h"
+#include "string.h"
+
+#include "messageIdSet.h"
+
+#define SLOTS_MASK ((size_t) MESSAGE_ID_SET_SLOTS - 1)
+#define ORDER_MASK ((size_t) MESSAGE_ID_SET_CAPACITY - 1)
+
+/**
+ * @brief Initializes empty set
+ *
+ * @param set Pointer to the set
+ */
+void messageIdSetInit(MessageIdSet* set)
+{
+    memset(set->slots, 0, sizeof(set->slots));
+    set->oldest = 0;
+    set->len = 0;
+    set->peakLen = 0;
+    set->evictedByAge = 0;
+    set->evictedByCapacity = 0;
+}
+
+/**
+ * @brief Creates new empty set
+ *
+ * @return MessageIdSet* Created set or NULL if allocation failed
+ */
+MessageIdSet* messageIdSetCreate()
+{
+    MessageIdSet* set = (MessageIdSet*) malloc(sizeof(MessageIdSet));
+    if(set == NULL) { return NULL; }
+
+    messageIdSetInit(set);
+    return set;
+}
+
+/**
+ * @brief Returns slot at which search for key starts (Fibonacci hashing)
+ *
+ * @param key Key of message
+ * @return size_t Index of slot
+ */
+size_t messageIdSetHome(uint32_t key)
+{
+    return (size_t) ((key * 2654435769u) >> 16) & SLOTS_MASK;
+}
+
+/**
+ * @brief Finds slot holding key or empty slot where key would be stored
+ *
+ * @param set Pointer to the set
+ * @param key Key of message
+ * @return size_t Index of slot
+ */
+size_t messageIdSetFind(MessageIdSet* set, uint32_t key)
+{
+    size_t i = messageIdSetHome(key);
+    while(set->slots[i] != 0 && set->slots[i] != key + 1)
+    {
+        i = (i + 1) & SLOTS_MASK;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Deletes key from hash table, keys behind it are moved back so no 
+ * key is separated from its home slot by empty slot
+ *
+ * @param set Pointer to the set
+ * @param key Key of message, must be in table
+ */
+void messageIdSetErase(MessageIdSet* set, uint32_t key)
+{
+    size_t hole = messageIdSetFind(set, key);
+    set->slots[hole] = 0;
+
+    size_t i = (hole + 1) & SLOTS_MASK;
+    while(set->slots[i] != 0)
+    {
+        size_t home = messageIdSetHome(set->slots[i] - 1);
+        // key can be moved to the hole if hole lies between its home and i
+        if(((i - home) & SLOTS_MASK) >= ((i - hole) & SLOTS_MASK))
+        {
+            set->slots[hole] = set->slots[i];
+            set->slots[i] = 0;
+            hole = i;
+        }
+        i = (i + 1) & SLOTS_MASK;
+    }
+}
+
+/**
+ * @brief Deletes the oldest key from set
+ *
+ * @param set Pointer to the set, must not be empty
+ */
+void messageIdSetEvictOldest(MessageIdSet* set)
+{
+    messageIdSetErase(set, set->order[set->oldest]);
+    set->oldest = (set->oldest + 1) & ORDER_MASK;
+    set->len -= 1;
+}
+
+/**
+ * @brief Returns true if message of provided type and ID is in set
+ *
+ * @param set Pointer to the set
+ * @param type Type of message
+ * @param msgId Message ID
+ * @return true Message was already received
+ * @return false Message is not in set
+ */
+bool messageIdSetContains(MessageIdSet* set, unsigned char type, uint16_t msgId)
+{
+    uint32_t key = ((uint32_t) type << 16) | msgId;
+    return set->slots[messageIdSetFind(set, key)] != 0;
+}
+
+/**
+ * @brief Adds message of provided type and ID to the set, IDs older than 
+ * horizon are evicted first and the oldest ID is evicted if set is full
+ *
+ * @param set Pointer to the set
+ * @param type Type of message
+ * @param msgId Message ID
+ * @param horizon Time in milliseconds after which server does not resend 
+ * message anymore
+ * @return true Message was added
+ * @return false Message was already in set, nothing was added
+ */
+bool messageIdSetInsert(MessageIdSet* set, unsigned char type, uint16_t msgId, uint32_t horizon)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    uint32_t now = (uint32_t) (time.tv_sec * 1000 + time.tv_nsec / (1000 * 1000));
+
+    // keys are ordered by age, only keys at the start can be too old
+    // (difference of times is correct even if milliseconds wrap around)
+    while(set->len > 0 && now - set->insertedAt[set->oldest] > horizon)
+    {
+        messageIdSetEvictOldest(set);
+        set->evictedByAge += 1;
+    }
+
+    uint32_t key = ((uint32_t) type << 16) | msgId;
+    size_t slot = messageIdSetFind(set, key);
+    if(set->slots[slot] != 0) { return false; }
+
+    if(set->len == MESSAGE_ID_SET_CAPACITY)
+    {
+        messageIdSetEvictOldest(set);
+        set->evictedByCapacity += 1;
+        // slot must be found again, eviction could have moved keys
+        slot = messageIdSetFind(set, key);
+    }
+
+    size_t position = (set->oldest + set->len) & ORDER_MASK;
+    set->slots[slot] = key + 1;
+    set->order[position] = key;
+    set->insertedAt[position] = now;
+    set->len += 1;
+    if(set->len > set->peakLen) { set->peakLen = set->len; }
+
+    return true;
+}
+
+#undef SLOTS_MASK
+#undef ORDER_MASK
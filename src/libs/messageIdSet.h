@@ -0,0 +1,94 @@
+/**
+ * @file messageIdSet.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for MessageIdSet, bounded
+ * set of message IDs received from server that is used for detection of 
+ * resended (duplicate) UDP messages
+ *
+ * IDs are keyed by type and message ID and stored in open addressing hash
+ * table with linear probing, lookup and insertion take constant time. Server
+ * resends message only few times shortly after it was sended, IDs older 
+ * than retransmission horizon are therefore evicted. IDs are evicted in 
+ * order in which they were received, so every insertion evicts in amortized
+ * constant time. Set never holds more than MESSAGE_ID_SET_CAPACITY IDs, the
+ * oldest ID is evicted when set is full even if it is not old enough.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MESSAGE_ID_SET_H
+#define MESSAGE_ID_SET_H 1
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+#include "time.h"
+
+// maximal number of remembered IDs, must be power of two
+#define MESSAGE_ID_SET_CAPACITY 4096
+// number of slots in hash table, table is at most half full
+#define MESSAGE_ID_SET_SLOTS (2 * MESSAGE_ID_SET_CAPACITY)
+// time in milliseconds added to the retransmission horizon, covers delay 
+// in network and backoff of server
+#define MESSAGE_ID_SET_MARGIN 1000
+
+/**
+ * @brief Set of received message IDs, set is used only by receiver and it
+ * is not protected by any lock
+ */
+typedef struct MessageIdSet {
+    // hash table of keys (type << 16 | message ID) increased by one, zero 
+    // marks empty slot
+    uint32_t slots[MESSAGE_ID_SET_SLOTS];
+    // keys in order in which they were inserted, oldest is evicted first
+    uint32_t order[MESSAGE_ID_SET_CAPACITY];
+    // time of insertion of keys in order (milliseconds, CLOCK_MONOTONIC)
+    uint32_t insertedAt[MESSAGE_ID_SET_CAPACITY];
+    size_t oldest; // position of the oldest key in order
+    size_t len; // number of keys in set
+    size_t peakLen; // maximal number of keys that were in set at once
+    size_t evictedByAge; // number of keys older than horizon
+    size_t evictedByCapacity; // number of keys evicted because set was full
+} MessageIdSet;
+
+/**
+ * @brief Initializes empty set
+ *
+ * @param set Pointer to the set
+ */
+void messageIdSetInit(MessageIdSet* set);
+
+/**
+ * @brief Creates new empty set
+ *
+ * @return MessageIdSet* Created set or NULL if allocation failed
+ */
+MessageIdSet* messageIdSetCreate();
+
+/**
+ * @brief Returns true if message of provided type and ID is in set
+ *
+ * @param set Pointer to the set
+ * @param type Type of message
+ * @param msgId Message ID
+ * @return true Message was already received
+ * @return false Message is not in set
+ */
+bool messageIdSetContains(MessageIdSet* set, unsigned char type, uint16_t msgId);
+
+/**
+ * @brief Adds message of provided type and ID to the set, IDs older than 
+ * horizon are evicted first and the oldest ID is evicted if set is full
+ *
+ * @param set Pointer to the set
+ * @param type Type of message
+ * @param msgId Message ID
+ * @param horizon Time in milliseconds after which server does not resend 
+ * message anymore
+ * @return true Message was added
+ * @return false Message was already in set, nothing was added
+ */
+bool messageIdSetInsert(MessageIdSet* set, unsigned char type, uint16_t msgId, uint32_t horizon);
+
+#endif /*MESSAGE_ID_SET_H*/
@@ -0,0 +1,164 @@
+/**
+ * @file messagePool.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of MessagePool, free lists of messages with inline
+ * contents that are reused by MessageQueue
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "messagePool.h"
+#include "msgQueue.h"
+
+/**
+ * @brief Initializes empty pool
+ *
+ * @param pool Pointer to the pool
+ */
+void messagePoolInit(MessagePool* pool)
+{
+    for(int i = 0; i < MESSAGE_POOL_CLASSES; i++)
+    {
+        pool->freeMessages[i] = NULL;
+    }
+    pool->slabs = NULL;
+    pool->allocations = 0;
+    pool->acquired = 0;
+}
+
+/**
+ * @brief Frees all memory allocated by pool, messages taken from pool 
+ * cannot be used afterwards
+ *
+ * @param pool Pointer to the pool
+ */
+void messagePoolDestroy(MessagePool* pool)
+{
+    while(pool->slabs != NULL)
+    {
+        PoolSlab* next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+
+    messagePoolInit(pool);
+}
+
+/**
+ * @brief Allocates new slab aligned to the cache line and adds it to the pool
+ *
+ * @param pool Pointer to the pool
+ * @param size Number of bytes behind header of slab
+ * @return char* Pointer to the first byte behind header of slab
+ */
+char* messagePoolAddSlab(MessagePool* pool, size_t size)
+{
+    // aligned_alloc() requires size to be multiple of alignment
+    size_t total = sizeof(PoolSlab) + size;
+    total = (total + MESSAGE_POOL_ALIGNMENT - 1) & ~((size_t) MESSAGE_POOL_ALIGNMENT - 1);
+
+    PoolSlab* slab = (PoolSlab*) aligned_alloc(MESSAGE_POOL_ALIGNMENT, total);
+    if(slab == NULL)
+    {
+        errHandling("Failed to allocate memory for MessagePool", err_MEMORY_FAIL);
+    }
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->allocations += 1;
+
+    return (char*) (slab + 1);
+}
+
+/**
+ * @brief Returns number of bytes occupied by message of given class 
+ * including its header, rounded up to the cache line
+ *
+ * @param capacity Size of contents of class
+ * @return size_t Distance between two messages in slab
+ */
+size_t messagePoolStride(size_t capacity)
+{
+    size_t size = sizeof(Message) + capacity;
+    return (size + MESSAGE_POOL_ALIGNMENT - 1) & ~((size_t) MESSAGE_POOL_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Takes unused message of smallest class that can hold len bytes 
+ * of contents, new slab is allocated if there is none. Payload of message 
+ * points to its inline contents, other attributes are not initialized.
+ *
+ * @param pool Pointer to the pool
+ * @param len Number of bytes that will be stored in message
+ * @return struct Message* Unused message
+ */
+Message* messagePoolGetMessage(MessagePool* pool, size_t len)
+{
+    const size_t classSizes[MESSAGE_POOL_CLASSES] = MESSAGE_POOL_CLASS_SIZES;
+
+    int class = 0;
+    while(class < MESSAGE_POOL_CLASSES && classSizes[class] < len) { class++; }
+
+    Message* msg;
+
+    // message is longer than any class, it is not reused
+    if(class == MESSAGE_POOL_CLASSES)
+    {
+        msg = (Message*) malloc(sizeof(Message) + len);
+        if(msg == NULL)
+        {
+            errHandling("Failed to allocate memory for message in MessagePool", err_MEMORY_FAIL);
+        }
+        pool->allocations += 1;
+        msg->payload.allocated = len;
+    }
+    else
+    {
+        if(pool->freeMessages[class] == NULL)
+        {
+            size_t stride = messagePoolStride(classSizes[class]);
+            size_t count = (stride < MESSAGE_POOL_SLAB_SIZE) ? MESSAGE_POOL_SLAB_SIZE / stride : 1;
+            char* messages = messagePoolAddSlab(pool, count * stride);
+
+            // messages are taken in order of their addresses
+            for(size_t i = count; i > 0; i--)
+            {
+                Message* unused = (Message*) (messages + (i - 1) * stride);
+                unused->payload.allocated = classSizes[class];
+                messagePoolPutMessage(pool, unused);
+            }
+        }
+
+        msg = pool->freeMessages[class];
+        pool->freeMessages[class] = msg->behindMe;
+    }
+
+    msg->payload.data = msg->data;
+    pool->acquired += 1;
+
+    return msg;
+}
+
+/**
+ * @brief Returns message to the pool
+ *
+ * @param pool Pointer to the pool
+ * @param msg Message taken from the same pool
+ */
+void messagePoolPutMessage(MessagePool* pool, Message* msg)
+{
+    const size_t classSizes[MESSAGE_POOL_CLASSES] = MESSAGE_POOL_CLASS_SIZES;
+
+    int class = 0;
+    while(class < MESSAGE_POOL_CLASSES && classSizes[class] != msg->payload.allocated) { class++; }
+
+    if(class == MESSAGE_POOL_CLASSES)
+    {
+        free(msg);
+        return;
+    }
+
+    msg->behindMe = pool->freeMessages[class];
+    pool->freeMessages[class] = msg;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file messagePool.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for MessagePool, free lists
+ * of messages that are reused by MessageQueue instead of allocating them for
+ * every message
+ *
+ * Memory is allocated in slabs and never returned to the system until pool
+ * is destroyed. Contents of message are stored inline behind its header,
+ * messages are therefore divided into size classes sized by maximal lengths
+ * of protocol messages.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H 1
+
+#include "stddef.h"
+
+#include "utils.h"
+
+// number of bytes allocated at once when pool runs out of messages
+#define MESSAGE_POOL_SLAB_SIZE 16384
+// messages are aligned to the cache line so header fits into one line
+#define MESSAGE_POOL_ALIGNMENT 64
+// number of size classes
+#define MESSAGE_POOL_CLASSES 4
+// CONFIRM, REPLY and BYE; AUTH and JOIN; MSG and ERR with up to 1400 
+// characters (protocol maximum); MSG with up to 14000 characters (accepted 
+// by user input), longer messages are allocated separately
+#define MESSAGE_POOL_CLASS_SIZES {64, 256, 2048, 16384}
+
+/**
+ * @brief Header of memory allocated by pool, messages are stored behind it
+ */
+typedef union PoolSlab {
+    union PoolSlab* next; // next slab of pool
+    max_align_t align; // messages behind header are aligned for any type
+    char line[MESSAGE_POOL_ALIGNMENT]; // ... and start at the cache line
+} PoolSlab;
+
+/**
+ * @brief Free lists of messages, pool is protected by lock of queue that 
+ * owns it
+ */
+typedef struct MessagePool {
+    // unused messages of every class linked through behindMe
+    struct Message* freeMessages[MESSAGE_POOL_CLASSES];
+    PoolSlab* slabs; // all slabs allocated by pool
+    size_t allocations; // number of heap allocations made by pool
+    size_t acquired; // number of messages taken from pool
+} MessagePool;
+
+/**
+ * @brief Initializes empty pool
+ *
+ * @param pool Pointer to the pool
+ */
+void messagePoolInit(MessagePool* pool);
+
+/**
+ * @brief Frees all memory allocated by pool, messages taken from pool 
+ * cannot be used afterwards
+ *
+ * @param pool Pointer to the pool
+ */
+void messagePoolDestroy(MessagePool* pool);
+
+/**
+ * @brief Takes unused message of smallest class that can hold len bytes 
+ * of contents, new slab is allocated if there is none. Payload of message 
+ * points to its inline contents, other attributes are not initialized.
+ *
+ * @param pool Pointer to the pool
+ * @param len Number of bytes that will be stored in message
+ * @return struct Message* Unused message
+ */
+struct Message* messagePoolGetMessage(MessagePool* pool, size_t len);
+
+/**
+ * @brief Returns message to the pool
+ *
+ * @param pool Pointer to the pool
+ * @param msg Message taken from the same pool
+ */
+void messagePoolPutMessage(MessagePool* pool, struct Message* msg);
+
+#endif /*MESSAGE_POOL_H*/
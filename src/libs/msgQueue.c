@@ -10,6 +10,7 @@
  */
 
 #include "msgQueue.h"
+#include "submitRing.h"
 
 #define HIGHER_MSGID_BYTE_POSTION 2
 #define LOWER_MSGID_BYTE_POSTION 1
@@ -30,6 +31,10 @@ void queueInit(MessageQueue* queue)
     queue->first = NULL;
     queue->last = NULL;
     queue->len = 0;
+    queue->controlFirst = NULL;
+    queue->controlLast = NULL;
+    messagePoolInit(&(queue->pool));
+    queue->submitRing = NULL;
 
     pthread_mutex_init(&(queue->lock), NULL);
 }
@@ -44,6 +49,9 @@ void queueDestroy(MessageQueue* queue)
     IS_INITIALIZED;
 
     queuePopAllMessages(queue);
+    while(queue->controlFirst != NULL) { queuePopControlMessage(queue); }
+    messagePoolDestroy(&(queue->pool));
+    submitRingDestroy(queue->submitRing);
 
     pthread_mutex_destroy(&(queue->lock));
 
@@ -103,42 +111,46 @@ Message* queueGetMessage(MessageQueue* queue)
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Creates and initializes message and returns pointer to it
+ * @brief Creates and initializes message and returns pointer to it, message
+ * is taken from pool of queue and contents are copied behind its header
  * 
+ * @param queue Queue to which message will be added
  * @param buffer Contents of buffer that will be copied into message
  * @param msgFlags Flags that will be set
- * @return Message* Pointer to new allocated message
+ * @return Message* Pointer to new message
  */
-Message* createMessage(Buffer* buffer, msg_flags msgFlags)
+Message* createMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags)
 {
-    Message* tmpMsg = (Message*) malloc(sizeof(Message));
-
-    if(tmpMsg == NULL)
-    {
-        errHandling("Malloc failed in queueAddMessage() for Message", 
-            err_MEMORY_FAIL);
-    }
-
-    Buffer* tmpBuffer = (Buffer*) malloc(sizeof(Buffer));
-    if(tmpMsg == NULL)
-    {
-        errHandling("Malloc failed in queueAddMessage() for Buffer", 
-            err_MEMORY_FAIL);
-    }
-    /* set default values to the message attributes*/
-    bufferInit(tmpBuffer);
+    Message* tmpMsg = messagePoolGetMessage(&(queue->pool), buffer->used);
 
     /* Copies input buffer to the new message*/
-    bufferCopy(tmpBuffer, buffer);
+    memcpy(tmpMsg->payload.data, buffer->data, buffer->used);
+    tmpMsg->payload.used = buffer->used;
 
     tmpMsg->sendCount = 0;
     tmpMsg->confirmed = false;
-    tmpMsg->buffer = tmpBuffer;
+    tmpMsg->buffer = &(tmpMsg->payload);
     tmpMsg->msgFlags = msgFlags;
+    tmpMsg->msgId = 0;
+    tmpMsg->retransmitAt.tv_sec = 0;
+    tmpMsg->retransmitAt.tv_nsec = 0;
+    tmpMsg->sentAt.tv_sec = 0;
+    tmpMsg->sentAt.tv_nsec = 0;
 
     return tmpMsg;
 }
 
+/**
+ * @brief Returns message to the pool of queue
+ * 
+ * @param queue Queue from which message was removed
+ * @param message Message to be returned
+ */
+void releaseMessage(MessageQueue* queue, Message* message)
+{
+    messagePoolPutMessage(&(queue->pool), message);
+}
+
 /**
  * @brief Adds new message to the queue at the end
  * 
@@ -150,7 +162,7 @@ void queueAddMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, un
 {
     IS_INITIALIZED;
 
-    Message* newMessage = createMessage(buffer, msgFlags);
+    Message* newMessage = createMessage(queue, buffer, msgFlags);
 
     // if queue doesn't have first, set this msg as first
     if(queue->first == NULL) { queue->first = newMessage; }
@@ -170,79 +182,66 @@ void queueAddMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, un
 }
 
 /**
- * @brief Adds new message to the queue at the start
+ * @brief Adds new message to the end of control lane of queue
  * 
  * @param queue MessageQueue to which will the new message be added
  * @param buffer is and input buffer from which the new message will be created
  * @param cmdType type of message to be set to the message 
  */
-void queueAddMessagePriority(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, unsigned char msgType)
+void queueAddControlMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, unsigned char msgType)
 {
     IS_INITIALIZED;
 
-    Message* newMessage = createMessage(buffer, msgFlags);
+    Message* newMessage = createMessage(queue, buffer, msgFlags);
     newMessage->type = msgType;
-    // if queue doesn't have last, set this msg as last
-    if(queue->last == NULL) { queue->last = newMessage; }
-
-    Message* oldFirst = queue->first;
-
-    // set new message as first
-    queue->first = newMessage;
+    newMessage->behindMe = NULL;
 
-    newMessage->behindMe = oldFirst;
-    
-    // increase queue size
-    queue->len += 1;
+    // confirmations are sended in order in which they were added
+    if(queue->controlLast != NULL) { queue->controlLast->behindMe = newMessage; }
+    else { queue->controlFirst = newMessage; }
+    queue->controlLast = newMessage;
 }
 
 /**
- * @brief Adds message to queue at the start. Added emssage won't contain buffer, only
- * message ID
+ * @brief Adds new message to the queue from thread that doesn't hold lock 
+ * of queue. If queue has submit ring, message is pushed to the ring without
+ * locking and consumer of ring moves it to the queue later, consumer itself 
+ * moves all submitted messages first and adds message directly. Otherwise 
+ * queue is locked and message is added.
  * 
- * @param queue Pointer to the queue 
- * @param buffer Buffer where message is stored
- * @param cmdType type of message to be set to the message
+ * @param queue MessageQueue to which will the new message be added
+ * @param buffer Contents of message
+ * @param msgFlags Flags that will be set
+ * @param msgType Type of message
+ * @param control Message will be added to the control lane
+ * @return true Message was added or submitted
+ * @return false Submit ring is full, nothing was added
  */
-void queueAddMessageOnlyID(MessageQueue* queue, Buffer* buffer, unsigned char msgType)
+bool queueSubmitMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, 
+    unsigned char msgType, bool control)
 {
     IS_INITIALIZED;
 
-    Message* tmpMsg = (Message*) malloc(sizeof(Message));
-
-    if(tmpMsg == NULL)
+    if(queue->submitRing != NULL && !submitRingIsConsumer(queue->submitRing))
     {
-        errHandling("Malloc failed in queueAddMessageOnlyID() for Message", 
-            err_MEMORY_FAIL);
+        return submitRingPush(queue->submitRing, buffer, msgFlags, msgType, control);
     }
 
-    tmpMsg->buffer = NULL;
-    tmpMsg->msgFlags = msg_flag_ERR;
-    tmpMsg->type = msgType;
+    queueLock(queue);
+    // messages submitted earlier must stay in front of this one
+    if(queue->submitRing != NULL) { submitRingDrain(queue->submitRing, queue); }
 
-    // Only ID queue is meant for storing only ID, it does need to be atleast 
-    // 3 bytes
-    if(buffer->used < 3) 
-    { 
-        errHandling("Buffer provided in queueAddMessageOnlyID"
-        "is shorter than 3 bytes!", err_INTERNAL_BAD_ARG);
+    if(control)
+    {
+        queueAddControlMessage(queue, buffer, msgFlags, msgType);
     }
-    
-    tmpMsg->highMsgId = buffer->data[HIGHER_MSGID_BYTE_POSTION];
-    tmpMsg->lowMsgId = buffer->data[LOWER_MSGID_BYTE_POSTION];
-
-    // if queue doesn't have last, set this msg as last
-    if(queue->last == NULL) { queue->last = tmpMsg; }
-
-    Message* oldFirst = queue->first;
-
-    // set new message as first
-    queue->first = tmpMsg;
+    else
+    {
+        queueAddMessage(queue, buffer, msgFlags, msgType);
+    }
+    queueUnlock(queue);
 
-    tmpMsg->behindMe = oldFirst;
-    
-    // increase queue size
-    queue->len += 1;
+    return true;
 }
 
 // ----------------------------------------------------------------------------
@@ -274,20 +273,17 @@ void queuePopMessage(MessageQueue* queue)
         queue->last = NULL;
     }
 
-    if(oldFirst->buffer != NULL)
-    {
-        // destroy message
-        bufferDestroy(oldFirst->buffer); // buffer.data
-        free(oldFirst->buffer); // buffer pointer
-    }
-    free(oldFirst); // message pointer
+    // return message to the pool
+    releaseMessage(queue, oldFirst);
 
     // decrease size of queue
     queue->len -= 1;
 }
 
 /**
- * @brief Deletes all messages in queue
+ * @brief Deletes all messages in data lane of queue, messages in submit 
+ * ring of queue are deleted as well. Control lane is kept, received 
+ * messages must be confirmed anyway.
  * 
  * @param queue Queue from which will the messages be deleted
  */
@@ -300,17 +296,91 @@ void queuePopAllMessages(MessageQueue* queue)
         queuePopMessage(queue);
     }
 
+    if(queue->submitRing != NULL) { submitRingDiscard(queue->submitRing); }
+
     queue->first = NULL;
     queue->last = NULL;
     queue->last = 0;
 }
 
+/**
+ * @brief Returns pointer to the first message of control lane
+ * 
+ * @param queue Queue from which the message will be returned 
+ * @return Message* First message or NULL if control lane is empty
+ */
+Message* queueGetControlMessage(MessageQueue* queue)
+{
+    IS_INITIALIZED;
+    return queue->controlFirst;
+}
+
+/**
+ * @brief Deletes first message of control lane
+ * 
+ * @param queue Queue from which will be the message deleted
+ */
+void queuePopControlMessage(MessageQueue* queue)
+{
+    IS_INITIALIZED;
+
+    Message* oldFirst = queue->controlFirst;
+    if(oldFirst == NULL) { return; }
+
+    queue->controlFirst = oldFirst->behindMe;
+    if(queue->controlFirst == NULL) { queue->controlLast = NULL; }
+
+    // return message to the pool
+    releaseMessage(queue, oldFirst);
+}
+
+/**
+ * @brief Deletes provided message from any position in queue
+ * 
+ * @param queue Queue from which will be the message deleted
+ * @param message Message to be deleted, must be part of the queue
+ */
+void queueRemoveMessage(MessageQueue* queue, Message* message)
+{
+    IS_INITIALIZED;
+
+    if(message == queue->first)
+    {
+        queuePopMessage(queue);
+        return;
+    }
+
+    // find message that is in front of the removed one
+    Message* inFront = queue->first;
+    while(inFront != NULL && inFront->behindMe != message)
+    {
+        inFront = inFront->behindMe;
+    }
+
+    if(inFront == NULL)
+    {
+        errHandling("In queueRemoveMessage(), message is not part of the queue",
+            err_INTERNAL_BAD_ARG);
+    }
+
+    // unlink message from queue
+    inFront->behindMe = message->behindMe;
+    if(message == queue->last) { queue->last = inFront; }
+
+    // return message to the pool
+    releaseMessage(queue, message);
+
+    // decrease size of queue
+    queue->len -= 1;
+}
+
 // ----------------------------------------------------------------------------
 //
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Check if MessageQueue is empty
+ * @brief Check if MessageQueue is empty, messages in control lane and in 
+ * submit ring of queue are counted as well
  * 
  * @param queue Queue to be checked
  * @return true if queue is empty
@@ -320,18 +390,18 @@ bool queueIsEmpty(MessageQueue* queue)
 {
     IS_INITIALIZED;
     
-    if(queue->len == 0){
-        return true;
+    if(queue->len == 0 && queue->controlFirst == NULL){
+        return queue->submitRing == NULL || submitRingLength(queue->submitRing) == 0;
     }
 
     return false;
 }
 
 /**
- * @brief Returns length of MesssageQueue
+ * @brief Returns length of data lane of MesssageQueue
  * 
  * @param queue queue to be checked
- * @return size_t Number of Messages in queue
+ * @return size_t Number of Messages in data lane of queue
  */
 size_t queueLength(MessageQueue* queue)
 {
@@ -343,39 +413,97 @@ size_t queueLength(MessageQueue* queue)
 }
 
 /**
- * @brief Looks for message ID in queue, works only with message queues
- *  without buffers containing only msg ids
+ * @brief Returns true if message was not sended yet or waits for confirmation
  * 
- * @param queue Pointer to the queue
- * @param incoming Incoming message pointer
- * @return true Message with this ID was found
- * @return false Message with this ID was not found
+ * @param msg Pointer to the message
+ */
+bool isPendingMessage(Message* msg)
+{
+    switch (msg->msgFlags)
+    {
+    case msg_flag_DO_NOT_RESEND:
+    case msg_flag_CONFIRM:
+    case msg_flag_NOK_REPLY:
+    case msg_flag_REJECTED:
+    case msg_flag_CONFIRMED:
+        return false;
+    default:
+        return !msg->confirmed;
+    }
+}
+
+/**
+ * @brief Returns number of messages in queue that were not sended yet or 
+ * that wait for confirmation, confirms and rejected messages are not counted.
+ * All messages in submit ring of queue are counted.
+ * 
+ * @param queue queue to be checked
+ * @return size_t Number of pending Messages in queue
+ */
+size_t queuePendingLength(MessageQueue* queue)
+{
+    IS_INITIALIZED;
+
+    size_t pending = (queue->submitRing != NULL) ? submitRingLength(queue->submitRing) : 0;
+    for(Message* msg = queue->first; msg != NULL; msg = msg->behindMe)
+    {
+        if(isPendingMessage(msg)) { pending += 1; }
+    }
+
+    return pending;
+}
+
+/**
+ * @brief Returns true if queue contains message of provided type that was 
+ * not sended yet or that waits for confirmation, messages in submit ring of 
+ * queue are checked as well
+ * 
+ * @param queue queue to be checked
+ * @param msgType Type of message
+ * @return true Pending message of this type was found
+ * @return false There is no pending message of this type
  */
-bool queueContainsMessageId(MessageQueue* queue, Message* incoming)
+bool queueHasPending(MessageQueue* queue, msg_t msgType)
 {
     IS_INITIALIZED;
 
-    char highMsgIDByte = incoming->buffer->data[HIGHER_MSGID_BYTE_POSTION];
-    char lowMsgIDByte = incoming->buffer->data[LOWER_MSGID_BYTE_POSTION];
+    if(queue->submitRing != NULL && submitRingCount(queue->submitRing, msgType) > 0) { return true; }
 
-    Message* topOfQueue = queue->first;
-    while(topOfQueue != NULL)
+    for(Message* msg = queue->first; msg != NULL; msg = msg->behindMe)
     {
-        if(highMsgIDByte == topOfQueue->highMsgId)
+        if(uchar2msgType(msg->type) == msgType && isPendingMessage(msg)) 
+        { 
+            return true; 
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Looks for already sended message with provided message ID in data
+ * lane of queue
+ * 
+ * @param queue Pointer to the queue
+ * @param msgId Message ID to be found
+ * @return Message* Found message or NULL if there is no such message
+ */
+Message* queueFindSendedMessage(MessageQueue* queue, uint16_t msgId)
+{
+    IS_INITIALIZED;
+
+    Message* msg = queue->first;
+    while(msg != NULL)
+    {
+        if(msg->sendCount > 0 && msg->msgId == msgId)
         {
-            if(lowMsgIDByte == topOfQueue->lowMsgId)
-            {
-                if(incoming->type == topOfQueue->type)
-                {
-                    return true; 
-                }
-            }
+            return msg;
         }
 
-        topOfQueue = topOfQueue->behindMe;
+        msg = msg->behindMe;
     }
-    
-    return false;
+
+    return NULL;
 }
 
 // ----------------------------------------------------------------------------
@@ -436,6 +564,31 @@ void queueSetMessageID(MessageQueue* queue, ProgramInterface* progInt)
     }
 }
 
+/**
+ * @brief Assigns next message ID from program interface message counter to 
+ * the provided message and increases the counter
+ * 
+ * @param message Message that will be labeled with message ID
+ * @param progInt Pointer to ProgramInterface that holds message counter
+ */
+void queueAssignMessageID(Message* message, ProgramInterface* progInt)
+{
+    if(message == NULL || message->buffer == NULL || message->buffer->used < 3)
+    {
+        errHandling("In queueAssignMessageID(), invalid message was passed as argument",
+            err_INTERNAL_BAD_ARG);
+    }
+
+    message->msgId = progInt->comDetails->msgCounter;
+    progInt->comDetails->msgCounter += 1;
+
+    // break message id into bytes and store it into buffer at positions
+    breakU16IntToBytes(
+        &(message->buffer->data[HIGHER_MSGID_BYTE_POSTION]),
+        &(message->buffer->data[LOWER_MSGID_BYTE_POSTION]),
+        message->msgId);
+}
+
 /**
  * @brief Returns message ID of the first message from queue
  * 
@@ -467,7 +620,12 @@ uint16_t queueGetMessageID(MessageQueue* queue)
 msg_flags queueGetMessageFlags(MessageQueue* queue)
 {
     IS_INITIALIZED;
-    return queue->first->msgFlags;
+    if(queue->first != NULL)
+    {
+        return queue->first->msgFlags;
+    }
+
+    return msg_flag_NONE;
 }
 
 /**
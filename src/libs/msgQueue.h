@@ -12,8 +12,10 @@
 #define MSG_LISH_H
 
 #include "pthread.h"
+#include "time.h"
 
 #include "programInterface.h"
+#include "messagePool.h"
 
 // ----------------------------------------------------------------------------
 // Defines, typedefs and structures
@@ -54,36 +56,47 @@ typedef enum MessageType {
 /**
  * @brief Mesage in list containing Buffer with message contents,
  *  type of message, flag and pointer to the message behind this message
+ *
+ * Attributes used by queue and sender are placed at the beginning so they
+ * share one cache line, contents of message are stored inline behind header.
  */
 typedef struct Message {
-    Buffer* buffer;
     struct Message* behindMe;
-    
-    union 
-    {
-        u_int8_t sendCount;
-        unsigned char highMsgId; 
-    };
-    union 
-    {
-        bool confirmed;
-        unsigned char lowMsgId;
-    };
-    
-    unsigned char type;
+    Buffer* buffer; // points to payload
     msg_flags msgFlags;
+    uint16_t msgId; // message id assigned by sender on first transmission
+    unsigned char type;
+
+    u_int8_t sendCount;
+    bool confirmed;
+
+    Buffer payload; // points to data, allocated is size of class in pool
+    struct timespec retransmitAt; // time at which message will be resent
+    struct timespec sentAt; // time of first transmission (CLOCK_MONOTONIC)
+
+    char data[]; // contents of message
 } Message;
 
 /**
- * @brief MessageQueue is priority FIFO (first in first out) queue containg 
- * Message structures and mutex lock for protecting data from being access 
- * at multiple points in same time.
+ * @brief MessageQueue is FIFO (first in first out) queue containg Message
+ * structures and mutex lock for protecting data from being access at 
+ * multiple points in same time.
+ *
+ * Queue has two lanes. Data lane holds messages that are sended in sending
+ * window and resended until they are confirmed. Control lane holds 
+ * confirmations of received messages, these are never resended and sender 
+ * sends them before any message from data lane.
  */
 typedef struct MessageQueue {
     Message* first; // Pointer to the first message
     Message* last; // Pointer to the last message
     size_t len; // length of queue
+    Message* controlFirst; // Pointer to the first message of control lane
+    Message* controlLast; // Pointer to the last message of control lane
     pthread_mutex_t lock;
+    MessagePool pool; // messages are reused
+    // messages submitted by other threads without lock, NULL if not used
+    struct SubmitRing* submitRing;
 } MessageQueue;
 
 // ----------------------------------------------------------------------------
@@ -139,13 +152,23 @@ Message* queueGetMessage(MessageQueue* queue);
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Creates and initializes message and returns pointer to it
+ * @brief Creates and initializes message and returns pointer to it, message
+ * is taken from pool of queue and contents are copied behind its header
  * 
+ * @param queue Queue to which message will be added
  * @param buffer Contents of buffer that will be copied into message
  * @param msgFlags Flags that will be set
- * @return Message* Pointer to new allocated message
+ * @return Message* Pointer to new message
  */
-Message* createMessage(Buffer* buffer, msg_flags msgFlags);
+Message* createMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags);
+
+/**
+ * @brief Returns message to the pool of queue
+ * 
+ * @param queue Queue from which message was removed
+ * @param message Message to be returned
+ */
+void releaseMessage(MessageQueue* queue, Message* message);
 
 /**
  * @brief Adds new message to the queue at the end
@@ -157,23 +180,31 @@ Message* createMessage(Buffer* buffer, msg_flags msgFlags);
 void queueAddMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, unsigned char msgType);
 
 /**
- * @brief Adds new message to the queue at the start
+ * @brief Adds new message to the end of control lane of queue
  * 
  * @param queue MessageQueue to which will the new message be added
  * @param buffer is and input buffer from which the new message will be created
  * @param cmdType type of message to be set to the message 
  */
-void queueAddMessagePriority(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, unsigned char msgType);
+void queueAddControlMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, unsigned char msgType);
 
 /**
- * @brief Adds message to queue at the start. Added emssage won't contain buffer, only
- * message ID
+ * @brief Adds new message to the queue from thread that doesn't hold lock 
+ * of queue. If queue has submit ring, message is pushed to the ring without
+ * locking and consumer of ring moves it to the queue later, consumer itself 
+ * moves all submitted messages first and adds message directly. Otherwise 
+ * queue is locked and message is added.
  * 
- * @param queue Pointer to the queue 
- * @param buffer Buffer where message is stored
- * @param cmdType type of message to be set to the message
+ * @param queue MessageQueue to which will the new message be added
+ * @param buffer Contents of message
+ * @param msgFlags Flags that will be set
+ * @param msgType Type of message
+ * @param control Message will be added to the control lane
+ * @return true Message was added or submitted
+ * @return false Submit ring is full, nothing was added
  */
-void queueAddMessageOnlyID(MessageQueue* queue, Buffer* buffer, unsigned char msgType);
+bool queueSubmitMessage(MessageQueue* queue, Buffer* buffer, msg_flags msgFlags, 
+    unsigned char msgType, bool control);
 
 // ----------------------------------------------------------------------------
 //
@@ -188,18 +219,44 @@ void queueAddMessageOnlyID(MessageQueue* queue, Buffer* buffer, unsigned char ms
 void queuePopMessage(MessageQueue* queue);
 
 /**
- * @brief Deletes all messages in queue
+ * @brief Deletes all messages in data lane of queue, messages in submit 
+ * ring of queue are deleted as well. Control lane is kept, received 
+ * messages must be confirmed anyway.
  * 
  * @param queue Queue from which will the messages be deleted
  */
 void queuePopAllMessages(MessageQueue* queue);
 
+/**
+ * @brief Returns pointer to the first message of control lane
+ * 
+ * @param queue Queue from which the message will be returned 
+ * @return Message* First message or NULL if control lane is empty
+ */
+Message* queueGetControlMessage(MessageQueue* queue);
+
+/**
+ * @brief Deletes first message of control lane
+ * 
+ * @param queue Queue from which will be the message deleted
+ */
+void queuePopControlMessage(MessageQueue* queue);
+
+/**
+ * @brief Deletes provided message from any position in queue
+ * 
+ * @param queue Queue from which will be the message deleted
+ * @param message Message to be deleted, must be part of the queue
+ */
+void queueRemoveMessage(MessageQueue* queue, Message* message);
+
 // ----------------------------------------------------------------------------
 //
 // ----------------------------------------------------------------------------
 
 /**
- * @brief Check if MessageQueue is empty
+ * @brief Check if MessageQueue is empty, messages in control lane and in 
+ * submit ring of queue are counted as well
  * 
  * @param queue Queue to be checked
  * @return true if queue is empty
@@ -208,23 +265,44 @@ void queuePopAllMessages(MessageQueue* queue);
 bool queueIsEmpty(MessageQueue* queue);
 
 /**
- * @brief Returns length of MesssageQueue
+ * @brief Returns length of data lane of MesssageQueue
  * 
  * @param queue queue to be checked
- * @return size_t Number of Messages in queue
+ * @return size_t Number of Messages in data lane of queue
  */
 size_t queueLength(MessageQueue* queue);
 
 /**
- * @brief Looks for message ID in queue, works only with message queues
- *  without buffers containing only msg ids
+ * @brief Returns number of messages in queue that were not sended yet or 
+ * that wait for confirmation, confirms and rejected messages are not counted.
+ * All messages in submit ring of queue are counted.
+ * 
+ * @param queue queue to be checked
+ * @return size_t Number of pending Messages in queue
+ */
+size_t queuePendingLength(MessageQueue* queue);
+
+/**
+ * @brief Returns true if queue contains message of provided type that was 
+ * not sended yet or that waits for confirmation, messages in submit ring of 
+ * queue are checked as well
+ * 
+ * @param queue queue to be checked
+ * @param msgType Type of message
+ * @return true Pending message of this type was found
+ * @return false There is no pending message of this type
+ */
+bool queueHasPending(MessageQueue* queue, msg_t msgType);
+
+/**
+ * @brief Looks for already sended message with provided message ID in data
+ * lane of queue
  * 
  * @param queue Pointer to the queue
- * @param incoming Incoming message pointer
- * @return true Message with this ID was found
- * @return false Message with this ID was not found
+ * @param msgId Message ID to be found
+ * @return Message* Found message or NULL if there is no such message
  */
-bool queueContainsMessageId(MessageQueue* queue, Message* incoming);
+Message* queueFindSendedMessage(MessageQueue* queue, uint16_t msgId);
 
 /**
  * @brief Adds ONE to sended counter of first message 
@@ -255,6 +333,15 @@ u_int8_t queueGetSendedCounter(MessageQueue* queue);
  */
 void queueSetMessageID(MessageQueue* queue, ProgramInterface* progInt);
 
+/**
+ * @brief Assigns next message ID from program interface message counter to 
+ * the provided message and increases the counter
+ * 
+ * @param message Message that will be labeled with message ID
+ * @param progInt Pointer to ProgramInterface that holds message counter
+ */
+void queueAssignMessageID(Message* message, ProgramInterface* progInt);
+
 /**
  * @brief Returns message ID of the first message from queue
  * 
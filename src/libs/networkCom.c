@@ -7,6 +7,14 @@
  * 
  */
 
+// getaddrinfo(), clock_gettime()
+#define _DEFAULT_SOURCE
+
+#include "errno.h"
+#include "fcntl.h"
+#include "poll.h"
+#include "time.h"
+
 #include "networkCom.h"
 
 // ----------------------------------------------------------------------------
@@ -17,19 +25,20 @@
  * @brief Get the Socket id
  * 
  * @param protocol Protocol that will be used to open socket (UDP or TCP) 
+ * @param family Address family of socket (AF_INET or AF_INET6)
  * @return int Socket id
  */
-int getSocket(enum Protocols protocol)
+int getSocket(enum Protocols protocol, int family)
 {   
-    int family;
+    int type;
     switch (protocol)
     {
-        case prot_UDP: family = SOCK_DGRAM; break; 
-        case prot_TCP: family = SOCK_STREAM; break;
+        case prot_UDP: type = SOCK_DGRAM; break; 
+        case prot_TCP: type = SOCK_STREAM; break;
         default: errHandling("Unknown protocol passed to function get socket", err_NETWORK_INIT); 
     }
 
-    int newSocket = socket(AF_INET, family, 0);
+    int newSocket = socket(family, type, 0);
     if(newSocket < 0)
     { 
         errHandling("Socket creation failed", err_NETWORK_INIT);
@@ -39,37 +48,538 @@ int getSocket(enum Protocols protocol)
 }
 
 // ----------------------------------------------------------------------------
-//
+// Resolve cache
 // ----------------------------------------------------------------------------
 
+// maximal length of line in resolve cache
+#define RESOLVE_CACHE_LINE_LEN 1024
+
 /**
- * @brief Finds server and returns it socket adress
- * 
+ * @brief Adds address in text format to the list of addresses
+ *
+ * @param text Address in text format (IPv4 or IPv6)
+ * @param addresses Array of addresses
+ * @param sizes Array of lengths of addresses
+ * @param count Number of addresses in array, increased if address was added
+ * @return true Address was added
+ * @return false Address is not valid or array is full
+ */
+bool addressFromText(const char* text, struct sockaddr_storage* addresses,
+    socklen_t* sizes, size_t* count)
+{
+    if(*count >= MAX_SERVER_ADDRESSES) { return false; }
+
+    struct sockaddr_storage* address = &(addresses[*count]);
+    memset(address, 0, sizeof(struct sockaddr_storage));
+
+    struct sockaddr_in* address4 = (struct sockaddr_in*) address;
+    struct sockaddr_in6* address6 = (struct sockaddr_in6*) address;
+    if(inet_pton(AF_INET, text, &(address4->sin_addr)) == 1)
+    {
+        address4->sin_family = AF_INET;
+        sizes[*count] = sizeof(struct sockaddr_in);
+    }
+    else if(inet_pton(AF_INET6, text, &(address6->sin6_addr)) == 1)
+    {
+        address6->sin6_family = AF_INET6;
+        sizes[*count] = sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        return false;
+    }
+
+    *count += 1;
+    return true;
+}
+
+/**
+ * @brief Loads server addresses from resolve cache, one line of cache has
+ * format "<hostname> <port> <address>[,<address>...] <expiration time>"
+ *
+ * @param lookup Pointer to the lookup to which addresses will be stored
+ * @return true Valid addresses were found
+ * @return false Cache doesn't exist or server is not in it or it expired
+ */
+bool resolveCacheLoad(ServerLookup* lookup)
+{
+    FILE* cache = fopen(lookup->cachePath, "r");
+    if(cache == NULL) { return false; }
+
+    time_t now = time(NULL);
+
+    char line[RESOLVE_CACHE_LINE_LEN];
+    char host[RESOLVE_CACHE_LINE_LEN];
+    char list[RESOLVE_CACHE_LINE_LEN];
+    unsigned cachedPort;
+    long long expires;
+
+    lookup->addressesCount = 0;
+    while(lookup->addressesCount == 0 && fgets(line, sizeof(line), cache) != NULL)
+    {
+        if(sscanf(line, "%1023s %u %1023s %lld", host, &cachedPort, list, &expires) != 4) { continue; }
+
+        if(strcmp(host, lookup->hostname) != 0 || cachedPort != lookup->port || expires <= now)
+        {
+            continue;
+        }
+
+        for(char* text = strtok(list, ","); text != NULL; text = strtok(NULL, ","))
+        {
+            addressFromText(text, lookup->addresses, lookup->addressesSizes, &(lookup->addressesCount));
+        }
+    }
+
+    fclose(cache);
+    return lookup->addressesCount > 0;
+}
+
+/**
+ * @brief Stores server addresses into resolve cache, entries of other
+ * servers that did not expire are kept. Cache is rewritten through temporary
+ * file, so other clients never read half written cache.
+ *
+ * @param lookup Pointer to the lookup with resolved addresses
+ */
+void resolveCacheStore(ServerLookup* lookup)
+{
+    const char* path = lookup->cachePath;
+
+    char tmpPath[RESOLVE_CACHE_LINE_LEN];
+    if(snprintf(tmpPath, sizeof(tmpPath), "%s.%d", path, getpid()) >= (int) sizeof(tmpPath)) { return; }
+
+    FILE* tmp = fopen(tmpPath, "w");
+    if(tmp == NULL) { return; }
+
+    time_t now = time(NULL);
+
+    FILE* cache = fopen(path, "r");
+    if(cache != NULL)
+    {
+        char line[RESOLVE_CACHE_LINE_LEN];
+        char host[RESOLVE_CACHE_LINE_LEN];
+        unsigned cachedPort;
+        long long expires;
+
+        while(fgets(line, sizeof(line), cache) != NULL)
+        {
+            if(sscanf(line, "%1023s %u %*s %lld", host, &cachedPort, &expires) != 3) { continue; }
+            if(expires <= now) { continue; }
+            if(strcmp(host, lookup->hostname) == 0 && cachedPort == lookup->port) { continue; }
+
+            fputs(line, tmp);
+        }
+        fclose(cache);
+    }
+
+    fprintf(tmp, "%s %u ", lookup->hostname, lookup->port);
+    for(size_t i = 0; i < lookup->addressesCount; i++)
+    {
+        char text[INET6_ADDRSTRLEN];
+        struct sockaddr_storage* address = &(lookup->addresses[i]);
+        if(address->ss_family == AF_INET6)
+        {
+            inet_ntop(AF_INET6, &(((struct sockaddr_in6*) address)->sin6_addr), text, sizeof(text));
+        }
+        else
+        {
+            inet_ntop(AF_INET, &(((struct sockaddr_in*) address)->sin_addr), text, sizeof(text));
+        }
+        fprintf(tmp, "%s%s", (i > 0) ? "," : "", text);
+    }
+    fprintf(tmp, " %lld\n", (long long) now + RESOLVE_CACHE_TTL);
+
+    if(fclose(tmp) != 0 || rename(tmpPath, path) != 0)
+    {
+        remove(tmpPath);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Server lookup
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Stores addresses returned by getaddrinfo() into lookup, IPv6 and
+ * IPv4 addresses alternate starting with IPv6 (RFC 8305), so one broken
+ * address family cannot delay connection for long
+ *
+ * @param lookup Pointer to the lookup
+ * @param result Addresses returned by getaddrinfo()
+ */
+void findServerSortAddresses(ServerLookup* lookup, struct addrinfo* result)
+{
+    struct addrinfo* next6 = result;
+    struct addrinfo* next4 = result;
+    bool preferIPv6 = true;
+
+    lookup->addressesCount = 0;
+    while(lookup->addressesCount < MAX_SERVER_ADDRESSES)
+    {
+        // find next address of each family
+        while(next6 != NULL && next6->ai_family != AF_INET6) { next6 = next6->ai_next; }
+        while(next4 != NULL && next4->ai_family != AF_INET) { next4 = next4->ai_next; }
+        if(next6 == NULL && next4 == NULL) { break; }
+
+        struct addrinfo** taken = ((preferIPv6 && next6 != NULL) || next4 == NULL) ? &next6 : &next4;
+        preferIPv6 = (taken == &next4);
+
+        size_t size = (*taken)->ai_addrlen;
+        if(size > sizeof(struct sockaddr_storage)) { size = sizeof(struct sockaddr_storage); }
+
+        memset(&(lookup->addresses[lookup->addressesCount]), 0, sizeof(struct sockaddr_storage));
+        memcpy(&(lookup->addresses[lookup->addressesCount]), (*taken)->ai_addr, size);
+        lookup->addressesSizes[lookup->addressesCount] = size;
+        lookup->addressesCount += 1;
+
+        *taken = (*taken)->ai_next;
+    }
+}
+
+/**
+ * @brief Body of lookup thread, resolves server addresses from cache or
+ * with getaddrinfo()
+ *
+ * @param vargp Pointer to the ServerLookup
+ * @return void* NULL
+ */
+void* findServerThread(void* vargp)
+{
+    ServerLookup* lookup = (ServerLookup*) vargp;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(lookup->cachePath != NULL && resolveCacheLoad(lookup))
+    {
+        lookup->cached = true;
+        lookup->result = 0;
+    }
+    else
+    {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        // one entry per address, not per socket type
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = AI_ADDRCONFIG;
+
+        struct addrinfo* result;
+        lookup->result = getaddrinfo(lookup->hostname, NULL, &hints, &result);
+        if(lookup->result == 0)
+        {
+            findServerSortAddresses(lookup, result);
+            freeaddrinfo(result);
+
+            if(lookup->addressesCount == 0) { lookup->result = EAI_NONAME; }
+            else if(lookup->cachePath != NULL) { resolveCacheStore(lookup); }
+        }
+    }
+
+    // port is not part of resolving
+    for(size_t i = 0; i < lookup->addressesCount; i++)
+    {
+        struct sockaddr_storage* address = &(lookup->addresses[i]);
+        if(address->ss_family == AF_INET6)
+        {
+            ((struct sockaddr_in6*) address)->sin6_port = htons(lookup->port);
+        }
+        else
+        {
+            ((struct sockaddr_in*) address)->sin_port = htons(lookup->port);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    lookup->resolveMillis = (end.tv_sec - start.tv_sec) * 1000.0 +
+        (end.tv_nsec - start.tv_nsec) / 1000000.0;
+
+    return NULL;
+}
+
+/**
+ * @brief Starts lookup of server address in background thread, so it can
+ * overlap with rest of program initialization. Result is collected by
+ * findServerFinish().
+ *
+ * @param lookup Pointer to the lookup
  * @param serverHostname String containing server hostname
  * @param serverPort Port of server
- * @return struct sockaddr_in Socket adress that was created
+ * @param cachePath File with resolved addresses, NULL if cache is not used
  */
-struct sockaddr_in findServer(const char* serverHostname, uint16_t serverPort)
+void findServerStart(ServerLookup* lookup, const char* serverHostname,
+    uint16_t serverPort, const char* cachePath)
 {
-    // this is apparently depricated however this was made based on 
-    // provided slides from lectures ...
-    struct hostent* server = gethostbyname(serverHostname);
-    if(server == NULL)
+    size_t hostnameLen = strlen(serverHostname);
+    lookup->hostname = (char*) malloc(hostnameLen + 1);
+    if(lookup->hostname == NULL)
     {
-        fprintf(stderr, "ERR: No such host %s\n", serverHostname);
+        errHandling("Failed to allocate memory for server lookup", err_MEMORY_FAIL);
+    }
+    memcpy(lookup->hostname, serverHostname, hostnameLen + 1);
+
+    lookup->port = serverPort;
+    lookup->cachePath = cachePath;
+    lookup->cached = false;
+    lookup->addressesCount = 0;
+
+    // if thread cannot be created, resolve right away
+    if(pthread_create(&(lookup->thread), NULL, findServerThread, lookup) != 0)
+    {
+        findServerThread(lookup);
+        lookup->thread = pthread_self();
+    }
+}
+
+/**
+ * @brief Waits for lookup started by findServerStart() and stores all
+ * resolved addresses of server into config, exits program if server was
+ * not found
+ *
+ * @param lookup Pointer to the lookup
+ * @param config Network configuration to which addresses will be stored
+ */
+void findServerFinish(ServerLookup* lookup, NetworkConfig* config)
+{
+    if(!pthread_equal(lookup->thread, pthread_self()))
+    {
+        pthread_join(lookup->thread, NULL);
+    }
+
+    if(lookup->result != 0)
+    {
+        fprintf(stderr, "ERR: No such host %s\n", lookup->hostname);
+        free(lookup->hostname);
         errHandling("Host not found", err_NETWORK_INIT);
     }
+    free(lookup->hostname);
+
+    memcpy(config->serverAddresses, lookup->addresses, sizeof(lookup->addresses));
+    memcpy(config->serverAddressesSizes, lookup->addressesSizes, sizeof(lookup->addressesSizes));
+    config->serverAddressesCount = lookup->addressesCount;
+
+    debugPrint(stdout, "DEBUG: Server has %zu address(es), resolved in %.3f ms\n",
+        lookup->addressesCount, lookup->resolveMillis);
+}
+
+// ----------------------------------------------------------------------------
+// Connection
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Sets address with given index as address of server
+ *
+ * @param config Network configuration with resolved addresses of server
+ * @param index Index of address
+ */
+void useServerAddress(NetworkConfig* config, size_t index)
+{
+    config->serverAddressIndex = index;
+    memcpy(&(config->serverAddressStorage), &(config->serverAddresses[index]),
+        sizeof(struct sockaddr_storage));
+    config->serverAddress = (struct sockaddr*) &(config->serverAddressStorage);
+    config->serverAddressSize = config->serverAddressesSizes[index];
+}
+
+/**
+ * @brief Races TCP connections to all resolved addresses of server, next
+ * attempt is started after CONNECTION_ATTEMPT_DELAY_MS or right after
+ * previous attempt failed. First established connection is kept, others
+ * are closed.
+ *
+ * @param config Network configuration with resolved addresses of server
+ */
+void connectHappyEyeballs(NetworkConfig* config)
+{
+    struct pollfd attempts[MAX_SERVER_ADDRESSES];
+    size_t attemptIndex[MAX_SERVER_ADDRESSES]; // address of each attempt
+    size_t attemptsCount = 0;
+    size_t pending = 0;
+    size_t started = 0;
+    int winner = -1;
+
+    while(winner < 0 && (started < config->serverAddressesCount || pending > 0))
+    {
+        // start next attempt
+        if(started < config->serverAddressesCount)
+        {
+            size_t index = started;
+            started += 1;
+
+            int newSocket = socket(config->serverAddresses[index].ss_family, SOCK_STREAM, 0);
+            if(newSocket < 0) { continue; }
+            fcntl(newSocket, F_SETFL, fcntl(newSocket, F_GETFL) | O_NONBLOCK);
+
+            int res = connect(newSocket, (struct sockaddr*) &(config->serverAddresses[index]),
+                config->serverAddressesSizes[index]);
+            if(res == 0)
+            {
+                winner = newSocket;
+                useServerAddress(config, index);
+                break;
+            }
+            if(errno != EINPROGRESS)
+            {
+                close(newSocket);
+                continue;
+            }
+
+            attempts[attemptsCount].fd = newSocket;
+            attempts[attemptsCount].events = POLLOUT;
+            attemptIndex[attemptsCount] = index;
+            attemptsCount += 1;
+            pending += 1;
+        }
+
+        // wait for any attempt, if there are addresses left, wait only
+        // until next attempt should be started
+        int timeout = (started < config->serverAddressesCount) ? CONNECTION_ATTEMPT_DELAY_MS : -1;
+        int ready = poll(attempts, attemptsCount, timeout);
+        if(ready < 0 && errno != EINTR) { break; }
+        if(ready <= 0) { continue; }
+
+        for(size_t i = 0; i < attemptsCount && winner < 0; i++)
+        {
+            if(attempts[i].fd < 0 || attempts[i].revents == 0) { continue; }
+
+            int error = 0;
+            socklen_t errorLen = sizeof(error);
+            getsockopt(attempts[i].fd, SOL_SOCKET, SO_ERROR, &error, &errorLen);
+            if(error == 0)
+            {
+                winner = attempts[i].fd;
+                useServerAddress(config, attemptIndex[i]);
+            }
+            else
+            {
+                close(attempts[i].fd);
+            }
+
+            // negative descriptors are ignored by poll()
+            attempts[i].fd = -1;
+            pending -= 1;
+        }
+    }
+
+    // close attempts that lost the race
+    for(size_t i = 0; i < attemptsCount; i++)
+    {
+        if(attempts[i].fd >= 0) { close(attempts[i].fd); }
+    }
+
+    if(winner < 0)
+    {
+        errHandling("Failed to connect to the server", err_NETWORK_INIT);
+    }
+
+    // rest of program uses blocking socket
+    fcntl(winner, F_SETFL, fcntl(winner, F_GETFL) & ~O_NONBLOCK);
+    config->openedSocket = winner;
+}
+
+/**
+ * @brief Opens UDP socket, if server has IPv6 address socket is dual-stack
+ * and IPv4 addresses are converted to IPv4-mapped IPv6 addresses, so all
+ * addresses can be tried through one socket
+ *
+ * @param config Network configuration with resolved addresses of server
+ */
+void openDatagramSocket(NetworkConfig* config)
+{
+    bool hasIPv6 = false;
+    for(size_t i = 0; i < config->serverAddressesCount; i++)
+    {
+        if(config->serverAddresses[i].ss_family == AF_INET6) { hasIPv6 = true; }
+    }
+
+    int dualStack = -1;
+    if(hasIPv6)
+    {
+        dualStack = socket(AF_INET6, SOCK_DGRAM, 0);
+        int v6Only = 0;
+        if(dualStack >= 0 &&
+            setsockopt(dualStack, IPPROTO_IPV6, IPV6_V6ONLY, &v6Only, sizeof(v6Only)) != 0)
+        {
+            close(dualStack);
+            dualStack = -1;
+        }
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < config->serverAddressesCount; i++)
+    {
+        struct sockaddr_storage address = config->serverAddresses[i];
+
+        if(dualStack >= 0 && address.ss_family == AF_INET)
+        {
+            struct sockaddr_in* address4 = (struct sockaddr_in*) &(config->serverAddresses[i]);
+            struct sockaddr_in6* mapped = (struct sockaddr_in6*) &address;
+            memset(mapped, 0, sizeof(struct sockaddr_in6));
+            mapped->sin6_family = AF_INET6;
+            mapped->sin6_port = address4->sin_port;
+            mapped->sin6_addr.s6_addr[10] = 0xFF;
+            mapped->sin6_addr.s6_addr[11] = 0xFF;
+            memcpy(&(mapped->sin6_addr.s6_addr[12]), &(address4->sin_addr), 4);
+        }
+        // IPv6 is not available, its addresses cannot be used
+        else if(dualStack < 0 && address.ss_family == AF_INET6)
+        {
+            continue;
+        }
+
+        config->serverAddresses[count] = address;
+        config->serverAddressesSizes[count] = (address.ss_family == AF_INET6) ?
+            sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+        count += 1;
+    }
+    config->serverAddressesCount = count;
+
+    if(count == 0)
+    {
+        errHandling("Server has no address that can be used", err_NETWORK_INIT);
+    }
 
-    struct sockaddr_in serverAddress;
-    memset(&serverAddress, 0, sizeof(serverAddress)); // clear memory
-    serverAddress.sin_family = AF_INET;
-    serverAddress.sin_port = htons(serverPort);
-    memcpy(&serverAddress.sin_addr.s_addr, server->h_addr_list[0], server->h_length);
-    
-    debugPrint(stdout, "DEBUG: Server socket %s : %d \n", inet_ntoa(serverAddress.sin_addr), ntohs(serverAddress.sin_port));
-    
-    return serverAddress;
+    config->openedSocket = (dualStack >= 0) ? dualStack : getSocket(prot_UDP, AF_INET);
+    useServerAddress(config, 0);
 }
+
+/**
+ * @brief Opens socket to the server. TCP connections to all resolved
+ * addresses are raced (Happy Eyeballs, RFC 8305) and the first one that
+ * is established is kept. UDP socket is dual-stack if server has IPv6
+ * address and communication starts with the first address.
+ *
+ * @param config Network configuration with resolved addresses of server
+ */
+void openServerConnection(NetworkConfig* config)
+{
+    if(config->protocol == prot_TCP)
+    {
+        connectHappyEyeballs(config);
+    }
+    else
+    {
+        openDatagramSocket(config);
+    }
+}
+
+/**
+ * @brief Switches UDP communication to the next resolved address of server,
+ * used when AUTH was not confirmed by current address
+ *
+ * @param config Network configuration with resolved addresses of server
+ */
+void nextServerAddress(NetworkConfig* config)
+{
+    if(config->serverAddressesCount <= 1) { return; }
+
+    useServerAddress(config, (config->serverAddressIndex + 1) % config->serverAddressesCount);
+}
+
+// ----------------------------------------------------------------------------
+//
+// ----------------------------------------------------------------------------
+
 /**
  * @brief Sets default values for NetworkConfig
  * 
@@ -81,7 +591,17 @@ void defaultNetworkConfig(NetworkConfig* config)
     config->portNumber = PORT_NUMBER;
     config->udpTimeout = 250;
     config->udpMaxRetries = 3;
+    config->udpBackoffCap = BACKOFF_CAP_MS;
+    config->udpWindow = UDP_WINDOW_SIZE;
+    config->pipelineDepth = 0;
+    config->useEventLoop = false;
+    config->useSubmitRing = false;
+    config->sessions = 0;
+    config->printStats = false;
+    config->resolveCache = NULL;
     config->openedSocket = -1;
+    config->serverAddressesCount = 0;
+    config->serverAddressIndex = 0;
     config->serverAddress = NULL;
     config->serverAddressSize = 0;
-}
\ No newline at end of file
+}
@@ -21,6 +21,17 @@
  */
 typedef enum Protocols {prot_ERR=-50, prot_UDP=50, prot_TCP=100} prot_t;
 
+#define PORT_NUMBER 4567
+#define UDP_WINDOW_SIZE 1
+// number of seconds for which address stored in resolve cache is valid
+#define RESOLVE_CACHE_TTL 300
+// maximal number of resolved addresses of server that are tried
+#define MAX_SERVER_ADDRESSES 8
+// delay between starts of two TCP connection attempts (RFC 8305)
+#define CONNECTION_ATTEMPT_DELAY_MS 250
+// default upper bound of delay between two UDP retransmissions
+#define BACKOFF_CAP_MS 2000
+
 /**
  * @brief Structure holding current network configuration of program
  */
@@ -29,29 +40,94 @@ typedef struct NetworkConfig {
     uint16_t portNumber;
     uint16_t udpTimeout;
     uint8_t udpMaxRetries;
+    uint32_t udpBackoffCap; // maximal delay of retransmission (--backoff-cap), 0 = no backoff
+    uint16_t udpWindow; // maximum number of unconfirmed messages in flight
+    uint16_t pipelineDepth; // maximum number of user messages queued ahead (--pipeline), 0 = input waits for replies
+    bool useEventLoop; // run in single thread using epoll (--event-loop)
+    bool useSubmitRing; // threads submit messages to sender through lock-free ring (--submit-ring)
+    uint32_t sessions; // number of sessions in one process (--sessions), 0 if only one
+    bool printStats; // print statistics at the end of program (--stats)
+    const char* resolveCache; // file with resolved addresses, NULL if not used
     int openedSocket;
+
+    // all resolved addresses of server, IPv6 and IPv4 addresses alternate
+    struct sockaddr_storage serverAddresses[MAX_SERVER_ADDRESSES];
+    socklen_t serverAddressesSizes[MAX_SERVER_ADDRESSES];
+    size_t serverAddressesCount;
+    size_t serverAddressIndex; // index of address that is currently used
+
+    // address that is currently used, serverAddress points to serverAddressStorage
+    struct sockaddr_storage serverAddressStorage;
     struct sockaddr* serverAddress;
     unsigned serverAddressSize;
 } NetworkConfig;
 
-#define PORT_NUMBER 4567
+/**
+ * @brief Structure holding state of server address lookup that runs in
+ * background thread
+ */
+typedef struct ServerLookup {
+    pthread_t thread;
+    char* hostname; // copy of server hostname
+    uint16_t port;
+    const char* cachePath; // file with resolved addresses, NULL if not used
+    int result; // 0 on success, return value of getaddrinfo() otherwise
+    bool cached; // address was loaded from cache
+    double resolveMillis; // time spent by lookup
+    struct sockaddr_storage addresses[MAX_SERVER_ADDRESSES];
+    socklen_t addressesSizes[MAX_SERVER_ADDRESSES];
+    size_t addressesCount;
+} ServerLookup;
 
 /**
  * @brief Get the Socket id
  * 
  * @param protocol Protocol that will be used to open socket (UDP or TCP) 
+ * @param family Address family of socket (AF_INET or AF_INET6)
  * @return int Socket id
  */
-int getSocket(prot_t protocol);
+int getSocket(prot_t protocol, int family);
 
 /**
- * @brief Finds server and returns it socket adress
- * 
+ * @brief Starts lookup of server address in background thread, so it can
+ * overlap with rest of program initialization. Result is collected by
+ * findServerFinish().
+ *
+ * @param lookup Pointer to the lookup
  * @param serverHostname String containing server hostname
  * @param serverPort Port of server
- * @return struct sockaddr_in Socket adress that was created
+ * @param cachePath File with resolved addresses, NULL if cache is not used
+ */
+void findServerStart(ServerLookup* lookup, const char* serverHostname,
+    uint16_t serverPort, const char* cachePath);
+
+/**
+ * @brief Waits for lookup started by findServerStart() and stores all 
+ * resolved addresses of server into config, exits program if server was 
+ * not found
+ *
+ * @param lookup Pointer to the lookup
+ * @param config Network configuration to which addresses will be stored
+ */
+void findServerFinish(ServerLookup* lookup, NetworkConfig* config);
+
+/**
+ * @brief Opens socket to the server. TCP connections to all resolved 
+ * addresses are raced (Happy Eyeballs, RFC 8305) and the first one that 
+ * is established is kept. UDP socket is dual-stack if server has IPv6 
+ * address and communication starts with the first address.
+ *
+ * @param config Network configuration with resolved addresses of server
+ */
+void openServerConnection(NetworkConfig* config);
+
+/**
+ * @brief Switches UDP communication to the next resolved address of server,
+ * used when AUTH was not confirmed by current address
+ *
+ * @param config Network configuration with resolved addresses of server
  */
-struct sockaddr_in findServer(const char* serverHostname, uint16_t serverPort);
+void nextServerAddress(NetworkConfig* config);
 
 /**
  * @brief Sets default values for NetworkConfig
@@ -0,0 +1,104 @@
+/**
+ * @file notifier.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of Notifier, waking up of threads without lost 
+ * wakeups (sequence counter and condition)
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "notifier.h"
+
+/**
+ * @brief Initializes notifier
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierInit(Notifier* notifier)
+{
+    pthread_mutex_init(&(notifier->lock), NULL);
+    pthread_cond_init(&(notifier->cond), NULL);
+    notifier->sequence = 0;
+    notifier->waiters = 0;
+}
+
+/**
+ * @brief Destroys notifier, no thread can wait on it
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierDestroy(Notifier* notifier)
+{
+    pthread_cond_destroy(&(notifier->cond));
+    pthread_mutex_destroy(&(notifier->lock));
+}
+
+/**
+ * @brief Returns number of notifications so far, must be read before 
+ * predicate of waiter is checked
+ *
+ * @param notifier Pointer to the notifier
+ * @return uint64_t Current sequence
+ */
+uint64_t notifierSequence(Notifier* notifier)
+{
+    pthread_mutex_lock(&(notifier->lock));
+    uint64_t sequence = notifier->sequence;
+    pthread_mutex_unlock(&(notifier->lock));
+
+    return sequence;
+}
+
+/**
+ * @brief Wakes all waiting threads, must be called after state that 
+ * predicates of waiters depend on was changed
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierNotify(Notifier* notifier)
+{
+    pthread_mutex_lock(&(notifier->lock));
+    notifier->sequence += 1;
+    // nobody waits, waiters that come later see changed sequence
+    if(notifier->waiters > 0)
+    {
+        pthread_cond_broadcast(&(notifier->cond));
+    }
+    pthread_mutex_unlock(&(notifier->lock));
+}
+
+/**
+ * @brief Waits until sequence differs from seen one (notification came after
+ * it was read) or until deadline expires
+ *
+ * @param notifier Pointer to the notifier
+ * @param seen Sequence returned by notifierSequence() or notifierWait()
+ * @param deadline Absolute time (CLOCK_REALTIME) of end of waiting, NULL 
+ * to wait without timeout
+ * @return uint64_t Current sequence, equal to seen if deadline expired
+ */
+uint64_t notifierWait(Notifier* notifier, uint64_t seen, const struct timespec* deadline)
+{
+    pthread_mutex_lock(&(notifier->lock));
+
+    notifier->waiters += 1;
+    while(notifier->sequence == seen)
+    {
+        if(deadline == NULL)
+        {
+            pthread_cond_wait(&(notifier->cond), &(notifier->lock));
+        }
+        else if(pthread_cond_timedwait(&(notifier->cond), &(notifier->lock), deadline) != 0)
+        {
+            // deadline expired (or error), sequence is checked by caller
+            break;
+        }
+    }
+    notifier->waiters -= 1;
+
+    uint64_t sequence = notifier->sequence;
+    pthread_mutex_unlock(&(notifier->lock));
+
+    return sequence;
+}
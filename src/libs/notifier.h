@@ -0,0 +1,79 @@
+/**
+ * @file notifier.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Declaration of structure and functions for Notifier, waking up of 
+ * threads without lost wakeups (sequence counter and condition)
+ *
+ * Waiter reads sequence before it checks its predicate and waits only until 
+ * sequence changes, so notification that came between check and wait is 
+ * never lost:
+ * 
+ *     uint64_t seen = notifierSequence(notifier);
+ *     while(!predicate()) { seen = notifierWait(notifier, seen, NULL); }
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef NOTIFIER_H
+#define NOTIFIER_H 1
+
+#include "time.h"
+
+#include "utils.h"
+
+/**
+ * @brief Structure holding number of notifications and condition on which 
+ * threads wait for next one
+ */
+typedef struct Notifier {
+    pthread_mutex_t lock; // protects sequence and waiters
+    pthread_cond_t cond;
+    uint64_t sequence; // number of notifications so far
+    unsigned waiters; // number of threads waiting in notifierWait()
+} Notifier;
+
+/**
+ * @brief Initializes notifier
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierInit(Notifier* notifier);
+
+/**
+ * @brief Destroys notifier, no thread can wait on it
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierDestroy(Notifier* notifier);
+
+/**
+ * @brief Returns number of notifications so far, must be read before 
+ * predicate of waiter is checked
+ *
+ * @param notifier Pointer to the notifier
+ * @return uint64_t Current sequence
+ */
+uint64_t notifierSequence(Notifier* notifier);
+
+/**
+ * @brief Wakes all waiting threads, must be called after state that 
+ * predicates of waiters depend on was changed
+ *
+ * @param notifier Pointer to the notifier
+ */
+void notifierNotify(Notifier* notifier);
+
+/**
+ * @brief Waits until sequence differs from seen one (notification came after
+ * it was read) or until deadline expires
+ *
+ * @param notifier Pointer to the notifier
+ * @param seen Sequence returned by notifierSequence() or notifierWait()
+ * @param deadline Absolute time (CLOCK_REALTIME) of end of waiting, NULL 
+ * to wait without timeout
+ * @return uint64_t Current sequence, equal to seen if deadline expired
+ */
+uint64_t notifierWait(Notifier* notifier, uint64_t seen, const struct timespec* deadline);
+
+#endif /*NOTIFIER_H*/
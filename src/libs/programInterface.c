@@ -9,6 +9,7 @@
  * 
  */
 #include "programInterface.h"
+#include "ipk24protocol.h"
 
 /**
  * @brief Prints help menu when user inputs /help command 
@@ -32,9 +33,40 @@ void printCliHelpMenu(const char* executableName)
         "Specifies which port will client try to connect to at specified "
         "IP adress. Default value is 4567.\n"
         "\t-d\t- "
-        "Sets UDP confirmation timeout in milliseconds\n"
+        "Sets UDP confirmation timeout in milliseconds, it is used until "
+        "round trip time is measured and it is upper bound of estimated "
+        "timeout afterwards\n"
         "\t-r\t- "
         "Sets maximum number of UDP retransmissions\n"
+        "\t--backoff-cap MS\t- "
+        "Sets maximum delay of UDP retransmission in milliseconds, every "
+        "retransmission waits randomly longer up to this value. Value 0 "
+        "disables backoff. Default value is 2000.\n"
+        "\t-w\t- "
+        "Sets maximum number of unconfirmed UDP messages that can be sent "
+        "at the same time (sliding window). Default value is 1.\n"
+        "\t--pipeline N\t- "
+        "Reads user input ahead of server, up to N messages are queued "
+        "while earlier ones wait for confirmation or reply. Messages are "
+        "held until program is authenticated and not joining a channel, "
+        "/exit and end of input wait for all queued messages.\n"
+        "\t--submit-ring\t- "
+        "Threads pass messages to the sender through lock-free ring "
+        "instead of locking sending queue, messages are sended after "
+        "sending queue is unlocked. Not used with --event-loop.\n"
+        "\t--event-loop\t- "
+        "Runs whole client in single thread that reacts to user input, "
+        "server messages, retransmission timeouts and signals (epoll)\n"
+        "\t--sessions N\t- "
+        "Runs N sessions (clients) in single thread, every line of input "
+        "must be prefixed by index of session (\"0 /auth ...\") or \"*\" "
+        "for all sessions (\"* hello\"). Implies --event-loop.\n"
+        "\t--stats\t- "
+        "Prints statistics (for example time of resolving server address) "
+        "to stderr at the end of program\n"
+        "\t--resolve-cache FILE\t- "
+        "Stores resolved server addresses in FILE for 300 seconds, next "
+        "start of program uses cached address instead of DNS\n"
         "\t-h\t- "
         "Prints this help menu end exits program with code 0\n"
 
@@ -49,22 +81,25 @@ void printCliHelpMenu(const char* executableName)
  */
 void printUserHelpMenu(ProgramInterface* progInt)
 {
-    safePrintStdout(
+    char menu[2048];
+    int used = snprintf(menu, sizeof(menu),
         "Commands start with \"/\", \"{arg}\" symbolize mandatory arguments for"
         " command, explanation of command is written after \"-\" symbol."
-        " Eligable commands are listed below: \n"
-        "\n\t/auth {Username} {Secret} {DisplayName}\t\t- "
-        "Authenticates user to server with data provided from the arguments. "
-        "{Username} and {Secret} are credentials. {Displayname} is name under "
-        "which will user(this) send messages to server."
-        "\n\t/join {ChannelID}\t\t\t\t- "                 
-        "Joins user to channel with {ChannelID}"
-        "\n\t/rename {DisplayName}\t\t\t\t- "             
-        "Renames user to {Displayname}"
-        "\n\t/help\t\t\t\t\t\t- "                     
-        "Prints this help message."
-        "\n"
-        );
+        " Eligable commands are listed below: \n");
+
+    // menu is generated from same table that is used for parsing commands
+    for(size_t i = 0; i < USER_COMMANDS_SIZE && used < (int) sizeof(menu); i++)
+    {
+        const UserCommand* command = &(userCommands[i]);
+        if(command->name == NULL) { continue; }
+
+        // explanations are aligned into one column
+        int padding = 46 - (int) (command->nameLen + strlen(command->usage));
+        used += snprintf(&(menu[used]), sizeof(menu) - (size_t) used, "\n\t%s %s%*s- %s",
+            command->name, command->usage, (padding > 0) ? padding : 1, "", command->help);
+    }
+
+    safePrintStdout("%s\n", menu);
 }
 
 
@@ -85,6 +120,13 @@ void setProgramState(ProgramInterface* progInt, fsm_t newState)
     debugPrint(stdout, "DEBUG: FSM state changed. Old: %i", progInt->threads->fsmState);
     progInt->threads->fsmState = newState;
 
+    // receiver is blocked on socket until server sends something, wake it 
+    if(newState == fsm_END && progInt->threads->wakeFd >= 0)
+    {
+        uint64_t wake = 1;
+        if(write(progInt->threads->wakeFd, &wake, sizeof(wake)) < 0) {}
+    }
+
     debugPrint(stdout, ", New: %i\n", newState);
     debugPrintSeparator(stdout);
     
@@ -101,4 +143,32 @@ fsm_t getProgramState(ProgramInterface* progInt)
     pthread_mutex_unlock(progInt->threads->fsmMutex);
 
     return val;
+}
+
+/**
+ * @brief Stores new display name and pre-encodes prefix of outgoing 
+ * messages with it, prefix is rebuilt only here (by /auth and /rename)
+ * 
+ * @param progInt Pointer to ProgramInterface
+ * @param name New display name
+ * @param len Length of new display name
+ */
+void setDisplayName(ProgramInterface* progInt, const char* name, size_t len)
+{
+    CommunicationDetails* comDetails = progInt->comDetails;
+
+    // "{DisplayName}\0" is prefix of UDP messages
+    bufferResize(&(comDetails->displayName), len + 1);
+    memcpy(comDetails->displayName.data, name, len);
+    comDetails->displayName.data[len] = '\0';
+    comDetails->displayName.used = len;
+
+    // "MSG FROM {DisplayName} IS " is prefix of TCP messages, ERR differs 
+    // only by first three characters
+    Buffer* prefix = &(comDetails->messagePrefix);
+    bufferResize(prefix, sizeof("MSG FROM ") - 1 + len + sizeof(" IS ") - 1);
+    memcpy(prefix->data, "MSG FROM ", sizeof("MSG FROM ") - 1);
+    memcpy(&(prefix->data[sizeof("MSG FROM ") - 1]), name, len);
+    memcpy(&(prefix->data[sizeof("MSG FROM ") - 1 + len]), " IS ", sizeof(" IS ") - 1);
+    prefix->used = sizeof("MSG FROM ") - 1 + len + sizeof(" IS ") - 1;
 }
\ No newline at end of file
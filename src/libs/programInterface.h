@@ -14,6 +14,14 @@
 
 #include "networkCom.h"
 #include "buffer.h"
+#include "ringBuffer.h"
+#include "ioRing.h"
+#include "datagramBatch.h"
+#include "statistics.h"
+#include "rttEstimator.h"
+#include "retryScheduler.h"
+#include "notifier.h"
+#include "messageIdSet.h"
 
 // ----------------------------------------------------------------------------
 // Structures
@@ -22,14 +30,21 @@
 /**
  * @brief Structure holding basic communication details.
  * 
- * displayname - identity of client that is send to server as 
+ * displayname - identity of client that is send to server as, always ended
+ * by '\0' so it is also prefix of UDP MSG and ERR
+ * messagePrefix - "MSG FROM {DisplayName} IS " prefix of TCP MSG and ERR
  * channelID - currect channel that client is connected to
  * msgCounter - counter of send messages
+ * rtt - round trip time estimation, protected by lock of sending queue
+ * retry - generator of retransmission delays, protected by lock of sending queue
  */
 typedef struct CommunicationDetails {
     Buffer displayName;
+    Buffer messagePrefix;
     Buffer channelID;
     uint16_t msgCounter;
+    RttEstimator rtt;
+    RetryScheduler retry;
 } CommunicationDetails;
 
 /**
@@ -45,14 +60,14 @@ typedef struct ThreadCommunication {
 
     struct MessageQueue* sendingQueue; // queue of outcoming (user sent) messages
 
-    pthread_cond_t* senderEmptyQueueCond;// signaling sender thread from main thread
-    pthread_mutex_t* senderEmptyQueueMutex;// signaling sender thread from main thread
+    // wakes sender when sending queue or program state changed (from main 
+    // and receiver thread)
+    Notifier senderNotifier;
+    // wakes main when message was processed or program state changed (from 
+    // sender and receiver thread)
+    Notifier mainNotifier;
 
-    pthread_cond_t* rec2SenderCond; // signaling sender thread from receiver thread
-    pthread_mutex_t* rec2SenderMutex; // signaling sender thread from receiver thread
-
-    pthread_cond_t* mainCond; // signaling sender thread from receiver thread
-    pthread_mutex_t* mainMutex; // signaling sender thread from receiver thread
+    int wakeFd; // eventfd that wakes receiver when program ends, -1 if not used
 } ThreadCommunication;
 
 /**
@@ -62,11 +77,19 @@ typedef struct ThreadCommunication {
 typedef struct CleanUp
 {
     Buffer clientInput;
+    LineReader stdinReader; // user input of threaded program
     Buffer protocolToSendedByMain;
     Buffer protocolToSendedByReceiver;
     Buffer protocolToSendedBySender;
+    Buffer senderOutbox; // messages sended after sending queue is unlocked
     Buffer serverResponse;
-    struct MessageQueue* confirmedMessages;
+    RingBuffer serverStream; // reassembly of messages received over TCP
+    MessageIdSet* confirmedMessages; // IDs of messages received from server (UDP)
+    struct EventLoop* eventLoop; // NULL if program runs in multiple threads
+    IoRing* sendRing; // NULL if io_uring is not used for sending
+    IoRing* recvRing; // NULL if io_uring is not used for receiving
+    DatagramBatch* sendBatch; // NULL if datagrams are not sended in batches
+    DatagramBatch* recvBatch; // NULL if datagrams are not received in batches
 } CleanUp;
 
 /*approx. 740 bytes*/
@@ -82,6 +105,7 @@ typedef struct ProgramInterface {
     struct NetworkConfig* netConfig;
     ThreadCommunication* threads;
     CleanUp* cleanUp;
+    Statistics* stats;
 } ProgramInterface;
 
 // ----------------------------------------------------------------------------
@@ -112,4 +136,14 @@ void setProgramState(ProgramInterface* progInt, fsm_t newState);
  */
 fsm_t getProgramState(ProgramInterface* progInt);
 
+/**
+ * @brief Stores new display name and pre-encodes prefix of outgoing 
+ * messages with it, prefix is rebuilt only here (by /auth and /rename)
+ * 
+ * @param progInt Pointer to ProgramInterface
+ * @param name New display name
+ * @param len Length of new display name
+ */
+void setDisplayName(ProgramInterface* progInt, const char* name, size_t len);
+
 #endif /*PROGRAM_INTERFACE_H*/
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file retryScheduler.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of RetryScheduler, exponential backoff with 
+ * bounded jitter for retransmissions of UDP messages
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "retryScheduler.h"
+
+/**
+ * @brief Initializes scheduler with seed
+ *
+ * @param sched Pointer to the scheduler
+ * @param seed Seed of generator, should be different for every session
+ */
+void retrySchedulerInit(RetryScheduler* sched, uint64_t seed)
+{
+    // xorshift generator would return only zeroes
+    sched->state = (seed != 0) ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * @brief Returns next pseudo random number in range <0, 1)
+ *
+ * @param sched Pointer to the scheduler
+ * @return double Random number
+ */
+double retrySchedulerRandom(RetryScheduler* sched)
+{
+    // xorshift64*
+    sched->state ^= sched->state >> 12;
+    sched->state ^= sched->state << 25;
+    sched->state ^= sched->state >> 27;
+    uint64_t value = sched->state * 0x2545F4914F6CDD1DULL;
+
+    // use upper 53 bits that fit into mantissa of double
+    return (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Returns delay after which message will be resended. First 
+ * transmission waits for timeout, backoff window is twice the timeout after 
+ * first retransmission and doubles with every other one up to the cap. Delay
+ * is drawn uniformly between timeout and end of window (bounded jitter), it 
+ * is never shorter than timeout, confirmation could still arrive before it.
+ *
+ * @param sched Pointer to the scheduler
+ * @param timeoutMillis Estimated retransmission timeout
+ * @param capMillis Upper bound of delay, 0 disables backoff
+ * @param retransmissions Number of retransmissions of message so far
+ * @return double Delay in milliseconds
+ */
+double retrySchedulerDelay(RetryScheduler* sched, double timeoutMillis, 
+    double capMillis, unsigned retransmissions)
+{
+    // backoff is disabled
+    if(retransmissions == 0 || capMillis <= timeoutMillis) { return timeoutMillis; }
+
+    double window = timeoutMillis;
+    for(unsigned i = 0; i < retransmissions && window < capMillis; i++)
+    {
+        window *= 2;
+    }
+    if(window > capMillis) { window = capMillis; }
+
+    return timeoutMillis + retrySchedulerRandom(sched) * (window - timeoutMillis);
+}
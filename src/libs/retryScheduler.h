@@ -0,0 +1,49 @@
+/**
+ * @file retryScheduler.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Declaration of structure and functions for RetryScheduler, 
+ * exponential backoff with bounded jitter for retransmissions of UDP messages
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef RETRY_SCHEDULER_H
+#define RETRY_SCHEDULER_H 1
+
+#include "utils.h"
+
+/**
+ * @brief Structure holding state of pseudo random generator of one session, 
+ * every session draws its own delays so sessions do not retransmit in 
+ * lockstep
+ */
+typedef struct RetryScheduler {
+    uint64_t state; // state of xorshift generator, never 0
+} RetryScheduler;
+
+/**
+ * @brief Initializes scheduler with seed
+ *
+ * @param sched Pointer to the scheduler
+ * @param seed Seed of generator, should be different for every session
+ */
+void retrySchedulerInit(RetryScheduler* sched, uint64_t seed);
+
+/**
+ * @brief Returns delay after which message will be resended. First 
+ * transmission waits for timeout, backoff window is twice the timeout after 
+ * first retransmission and doubles with every other one up to the cap. Delay
+ * is drawn uniformly between timeout and end of window (bounded jitter), it 
+ * is never shorter than timeout, confirmation could still arrive before it.
+ *
+ * @param sched Pointer to the scheduler
+ * @param timeoutMillis Estimated retransmission timeout
+ * @param capMillis Upper bound of delay, 0 disables backoff
+ * @param retransmissions Number of retransmissions of message so far
+ * @return double Delay in milliseconds
+ */
+double retrySchedulerDelay(RetryScheduler* sched, double timeoutMillis, 
+    double capMillis, unsigned retransmissions);
+
+#endif /*RETRY_SCHEDULER_H*/
@@ -0,0 +1,265 @@
+/**
+ * @file ringBuffer.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of RingBuffer functions
+ * 
+ * RingBuffer is a growable circular byte buffer used for reassembling 
+ * messages from stream (TCP) communication, where one read can contain 
+ * multiple messages or only part of a message.
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#include "ringBuffer.h"
+
+/**
+ * @brief Sets default values to the ring buffer
+ * 
+ * @warning Do not use on ring buffer that already has allocated memory
+ * 
+ * @param ring RingBuffer to be reseted
+ */
+void ringBufferInit(RingBuffer* ring)
+{
+    ring->data = NULL;
+    ring->allocated = 0;
+    ring->head = 0;
+    ring->used = 0;
+    ring->scanned = 0;
+}
+
+/**
+ * @brief Copies unread data from ring buffer into continuous memory
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param dst Destination memory, must have atleast ring->used bytes
+ * @param len Number of bytes to be copied from the start of unread data
+ */
+void ringBufferCopyOut(RingBuffer* ring, char* dst, size_t len)
+{
+    size_t firstPart = ring->allocated - ring->head;
+    if(firstPart > len) { firstPart = len; }
+
+    memcpy(dst, &(ring->data[ring->head]), firstPart);
+    memcpy(&(dst[firstPart]), ring->data, len - firstPart);
+}
+
+/**
+ * @brief Resizes ring buffer to new size, unread data are moved to the 
+ * start of the new memory
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param newSize New size
+ */
+void ringBufferResize(RingBuffer* ring, size_t newSize)
+{
+    char* tmp = (char*) calloc(newSize + RING_BUFFER_PADDING, sizeof(char));
+    if(tmp == NULL)
+    {
+        errHandling("Failed to allocate memory for ring buffer in "
+            "ringBufferResize()", err_MEMORY_FAIL);
+    }
+
+    if(ring->data != NULL)
+    {
+        ringBufferCopyOut(ring, tmp, ring->used);
+        free(ring->data);
+    }
+
+    ring->data = tmp;
+    ring->allocated = newSize;
+    ring->head = 0;
+}
+
+/**
+ * @brief Returns free space of the ring buffer as up to two iovec blocks
+ * that can be directly filled by readv(). If there is less than minFree 
+ * free bytes, ring buffer will be resized.
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param minFree Minimal number of free bytes 
+ * @param iov Output array of two iovec structures
+ * @return int Number of used iovec structures
+ */
+int ringBufferGetFreeSpace(RingBuffer* ring, size_t minFree, struct iovec iov[2])
+{
+    if(ring->data == NULL)
+    {
+        ringBufferResize(ring, (minFree > INITIAL_RING_BUFFER_SIZE)? 
+            minFree : INITIAL_RING_BUFFER_SIZE);
+    }
+    else if(ring->allocated - ring->used < minFree)
+    {
+        size_t newSize = ring->allocated * 2;
+        if(newSize < ring->used + minFree) { newSize = ring->used + minFree; }
+        ringBufferResize(ring, newSize);
+    }
+
+    // without unread data start from the beginning to get one block
+    if(ring->used == 0) { ring->head = 0; }
+
+    size_t tail = (ring->head + ring->used) % ring->allocated;
+
+    if(tail >= ring->head)
+    {
+        // free space is behind tail until end and from start until head
+        iov[0].iov_base = &(ring->data[tail]);
+        iov[0].iov_len = ring->allocated - tail;
+        if(ring->head == 0) { return 1; }
+
+        iov[1].iov_base = ring->data;
+        iov[1].iov_len = ring->head;
+        return 2;
+    }
+
+    // unread data are wrapped, free space is between tail and head
+    iov[0].iov_base = &(ring->data[tail]);
+    iov[0].iov_len = ring->head - tail;
+    return 1;
+}
+
+/**
+ * @brief Marks bytes that were written into free space as unread
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param written Number of written bytes
+ */
+void ringBufferCommit(RingBuffer* ring, size_t written)
+{
+    if(ring->used + written > ring->allocated)
+    {
+        errHandling("In ringBufferCommit(), more bytes were written than "
+            "ring buffer can hold", err_INTERNAL_BAD_ARG);
+    }
+
+    ring->used += written;
+}
+
+/**
+ * @brief Finds first complete line (ended with "\r\n") in unread data. 
+ * 
+ * If line is stored continuously it is returned as a view into the ring
+ * buffer (view will not own the memory), otherwise it is copied into the 
+ * scratch buffer. Returned line is valid until ringBufferDiscard() is called.
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param view Buffer that will point into ring buffer memory
+ * @param scratch Buffer for lines that are split by end of ring buffer
+ * @return Buffer* Pointer to the view or scratch containing line including 
+ * "\r\n", NULL if there is no complete line
+ */
+Buffer* ringBufferGetLine(RingBuffer* ring, Buffer* view, Buffer* scratch)
+{
+    // continue searching where last search ended, lines cannot start with
+    // '\n' so first byte can be skipped as well
+    size_t offset = (ring->scanned > 0)? ring->scanned : 1;
+
+    while(offset < ring->used)
+    {
+        // search until end of unread data or until end of memory
+        size_t position = (ring->head + offset) % ring->allocated;
+        size_t blockLen = ring->used - offset;
+        if(position + blockLen > ring->allocated) 
+        { 
+            blockLen = ring->allocated - position; 
+        }
+
+        char* newLine = (char*) memchr(&(ring->data[position]), '\n', blockLen);
+        if(newLine == NULL)
+        {
+            offset += blockLen;
+            continue;
+        }
+
+        offset += newLine - &(ring->data[position]);
+        // check if newline is preceded by '\r'
+        size_t previous = (ring->head + offset - 1) % ring->allocated;
+        if(ring->data[previous] != '\r')
+        {
+            offset += 1;
+            continue;
+        }
+
+        size_t lineLen = offset + 1;
+        ring->scanned = lineLen;
+
+        // line is stored continuously, return view into the ring buffer
+        if(ring->head + lineLen <= ring->allocated)
+        {
+            view->data = &(ring->data[ring->head]);
+            view->used = lineLen;
+            view->allocated = lineLen;
+            return view;
+        }
+
+        // line is split by end of memory, copy it into scratch buffer
+        bufferResize(scratch, lineLen + 1);
+        ringBufferCopyOut(ring, scratch->data, lineLen);
+        scratch->data[lineLen] = '\0';
+        scratch->used = lineLen;
+        return scratch;
+    }
+
+    // remember how many bytes were already searched
+    ring->scanned = ring->used;
+    return NULL;
+}
+
+/**
+ * @brief Copies all unread data into the scratch buffer, used for data that
+ * are not ended with delimiter
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param scratch Buffer to which data will be copied
+ * @return Buffer* Pointer to the scratch buffer
+ */
+Buffer* ringBufferGetAll(RingBuffer* ring, Buffer* scratch)
+{
+    bufferResize(scratch, ring->used + 1);
+    ringBufferCopyOut(ring, scratch->data, ring->used);
+    scratch->data[ring->used] = '\0';
+    scratch->used = ring->used;
+
+    return scratch;
+}
+
+/**
+ * @brief Removes bytes from the start of unread data
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param len Number of bytes to be removed
+ */
+void ringBufferDiscard(RingBuffer* ring, size_t len)
+{
+    if(ring->allocated == 0) { return; }
+    if(len > ring->used) { len = ring->used; }
+
+    ring->head = (ring->head + len) % ring->allocated;
+    ring->used -= len;
+    ring->scanned = (ring->scanned > len)? ring->scanned - len : 0;
+}
+
+/**
+ * @brief Returns number of unread bytes in ring buffer
+ * 
+ * @param ring Pointer to the ring buffer
+ * @return size_t Number of unread bytes
+ */
+size_t ringBufferLength(RingBuffer* ring)
+{
+    return ring->used;
+}
+
+/**
+ * @brief Destroys RingBuffer and frees memory
+ * 
+ * @param ring Pointer to the ring buffer
+ */
+void ringBufferDestroy(RingBuffer* ring)
+{
+    if(ring->data != NULL)
+    {
+        free(ring->data);
+    }
+}
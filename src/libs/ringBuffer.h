@@ -0,0 +1,117 @@
+/**
+ * @file ringBuffer.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for RingBuffer
+ * 
+ * RingBuffer is a growable circular byte buffer used for reassembling 
+ * messages from stream (TCP) communication, where one read can contain 
+ * multiple messages or only part of a message.
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H 1
+
+#include "sys/uio.h"
+
+#include "buffer.h"
+
+#define INITIAL_RING_BUFFER_SIZE (64 * 1024)
+// zeroed bytes behind allocated memory, protects against reading 
+// one byte behind the end of message at the end of buffer
+#define RING_BUFFER_PADDING 16
+
+/**
+ * @brief RingBuffer is circular byte array with information about where 
+ * unread data starts, how many bytes are unread and how many of unread bytes
+ * were already searched for the message delimiter.
+ */
+typedef struct RingBuffer
+{
+    char* data;
+    size_t allocated;
+    size_t head; // index of first unread byte
+    size_t used; // number of unread bytes
+    size_t scanned; // number of unread bytes searched for delimiter
+} RingBuffer;
+
+/**
+ * @brief Sets default values to the ring buffer
+ * 
+ * @warning Do not use on ring buffer that already has allocated memory
+ * 
+ * @param ring RingBuffer to be reseted
+ */
+void ringBufferInit(RingBuffer* ring);
+
+/**
+ * @brief Returns free space of the ring buffer as up to two iovec blocks
+ * that can be directly filled by readv(). If there is less than minFree 
+ * free bytes, ring buffer will be resized.
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param minFree Minimal number of free bytes 
+ * @param iov Output array of two iovec structures
+ * @return int Number of used iovec structures
+ */
+int ringBufferGetFreeSpace(RingBuffer* ring, size_t minFree, struct iovec iov[2]);
+
+/**
+ * @brief Marks bytes that were written into free space as unread
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param written Number of written bytes
+ */
+void ringBufferCommit(RingBuffer* ring, size_t written);
+
+/**
+ * @brief Finds first complete line (ended with "\r\n") in unread data. 
+ * 
+ * If line is stored continuously it is returned as a view into the ring
+ * buffer (view will not own the memory), otherwise it is copied into the 
+ * scratch buffer. Returned line is valid until ringBufferDiscard() is called.
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param view Buffer that will point into ring buffer memory
+ * @param scratch Buffer for lines that are split by end of ring buffer
+ * @return Buffer* Pointer to the view or scratch containing line including 
+ * "\r\n", NULL if there is no complete line
+ */
+Buffer* ringBufferGetLine(RingBuffer* ring, Buffer* view, Buffer* scratch);
+
+/**
+ * @brief Copies all unread data into the scratch buffer, used for data that
+ * are not ended with delimiter
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param scratch Buffer to which data will be copied
+ * @return Buffer* Pointer to the scratch buffer
+ */
+Buffer* ringBufferGetAll(RingBuffer* ring, Buffer* scratch);
+
+/**
+ * @brief Removes bytes from the start of unread data
+ * 
+ * @param ring Pointer to the ring buffer
+ * @param len Number of bytes to be removed
+ */
+void ringBufferDiscard(RingBuffer* ring, size_t len);
+
+/**
+ * @brief Returns number of unread bytes in ring buffer
+ * 
+ * @param ring Pointer to the ring buffer
+ * @return size_t Number of unread bytes
+ */
+size_t ringBufferLength(RingBuffer* ring);
+
+/**
+ * @brief Destroys RingBuffer and frees memory
+ * 
+ * @param ring Pointer to the ring buffer
+ */
+void ringBufferDestroy(RingBuffer* ring);
+
+#endif /*RING_BUFFER_H*/
@@ -0,0 +1,76 @@
+/**
+ * @file rttEstimator.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of RttEstimator, estimation of round trip time and 
+ * retransmission timeout of UDP messages (RFC 6298)
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "rttEstimator.h"
+
+// gains of smoothed round trip time and its variation (alpha and beta)
+#define RTT_ALPHA (1.0 / 8.0)
+#define RTT_BETA (1.0 / 4.0)
+
+/**
+ * @brief Initializes estimator, until first sample is measured maximal 
+ * timeout is used
+ *
+ * @param est Pointer to the estimator
+ */
+void rttEstimatorInit(RttEstimator* est)
+{
+    est->srtt = 0;
+    est->rttvar = 0;
+    est->rto = 0;
+    est->samples = 0;
+}
+
+/**
+ * @brief Updates smoothed round trip time and its variation with new sample
+ * and recalculates retransmission timeout. Samples of retransmitted messages 
+ * must not be used (Karn's rule), it is not known which transmission was 
+ * confirmed.
+ *
+ * @param est Pointer to the estimator
+ * @param sampleMillis Time between first transmission and confirmation
+ */
+void rttEstimatorSample(RttEstimator* est, double sampleMillis)
+{
+    if(sampleMillis < 0) { sampleMillis = 0; }
+
+    if(est->samples == 0)
+    {
+        est->srtt = sampleMillis;
+        est->rttvar = sampleMillis / 2;
+    }
+    else
+    {
+        // variation must be updated with previous srtt
+        double diff = est->srtt - sampleMillis;
+        est->rttvar = (1 - RTT_BETA) * est->rttvar + RTT_BETA * (diff < 0 ? -diff : diff);
+        est->srtt = (1 - RTT_ALPHA) * est->srtt + RTT_ALPHA * sampleMillis;
+    }
+    est->samples += 1;
+
+    double variation = 4 * est->rttvar;
+    est->rto = est->srtt + 
+        (variation > RTT_CLOCK_GRANULARITY_MS ? variation : RTT_CLOCK_GRANULARITY_MS);
+}
+
+/**
+ * @brief Returns current retransmission timeout, it is bounded by maxMillis
+ * and by maxMillis / RTO_MIN_DIVISOR
+ *
+ * @param est Pointer to the estimator
+ * @param maxMillis Upper bound of timeout, used until first sample is measured
+ * @return double Retransmission timeout in milliseconds
+ */
+double rttEstimatorTimeout(RttEstimator* est, double maxMillis)
+{
+    if(est->samples == 0 || est->rto > maxMillis) { return maxMillis; }
+    if(est->rto < maxMillis / RTO_MIN_DIVISOR) { return maxMillis / RTO_MIN_DIVISOR; }
+    return est->rto;
+}
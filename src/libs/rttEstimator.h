@@ -0,0 +1,64 @@
+/**
+ * @file rttEstimator.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Declaration of structure and functions for RttEstimator, estimation
+ * of round trip time and retransmission timeout of UDP messages (RFC 6298)
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H 1
+
+#include "utils.h"
+
+// lower bound of retransmission timeout is this fraction of its upper bound 
+// (-d), RFC 6298 suggests 1 second which is too slow for chat on local 
+// network, but timeout must not be so short that few lost messages in a row
+// exhaust all retries
+#define RTO_MIN_DIVISOR 8.0
+// clock granularity in milliseconds (G in RFC 6298)
+#define RTT_CLOCK_GRANULARITY_MS 1.0
+
+/**
+ * @brief Structure holding smoothed round trip time and its variance of one
+ * session, all values are in milliseconds
+ */
+typedef struct RttEstimator {
+    double srtt; // smoothed round trip time
+    double rttvar; // round trip time variation
+    double rto; // retransmission timeout, valid only if samples > 0
+    size_t samples; // number of measured round trip times
+} RttEstimator;
+
+/**
+ * @brief Initializes estimator, until first sample is measured maximal 
+ * timeout is used
+ *
+ * @param est Pointer to the estimator
+ */
+void rttEstimatorInit(RttEstimator* est);
+
+/**
+ * @brief Updates smoothed round trip time and its variation with new sample
+ * and recalculates retransmission timeout. Samples of retransmitted messages 
+ * must not be used (Karn's rule), it is not known which transmission was 
+ * confirmed.
+ *
+ * @param est Pointer to the estimator
+ * @param sampleMillis Time between first transmission and confirmation
+ */
+void rttEstimatorSample(RttEstimator* est, double sampleMillis);
+
+/**
+ * @brief Returns current retransmission timeout, it is bounded by maxMillis
+ * and by maxMillis / RTO_MIN_DIVISOR
+ *
+ * @param est Pointer to the estimator
+ * @param maxMillis Upper bound of timeout, used until first sample is measured
+ * @return double Retransmission timeout in milliseconds
+ */
+double rttEstimatorTimeout(RttEstimator* est, double maxMillis);
+
+#endif /*RTT_ESTIMATOR_H*/
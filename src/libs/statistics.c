@@ -0,0 +1,108 @@
+/**
+ * @file statistics.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of Statistics, metrics collected during run of
+ * program and printed at the end (--stats)
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "statistics.h"
+
+/**
+ * @brief Initializes statistics
+ *
+ * @param stats Pointer to the statistics
+ */
+void statisticsInit(Statistics* stats)
+{
+    memset(stats, 0, sizeof(Statistics));
+}
+
+/**
+ * @brief Adds round trip time estimation of one session to statistics, 
+ * average of all added sessions is printed
+ *
+ * @param stats Pointer to the statistics
+ * @param rtt Pointer to the estimator of session
+ * @param maxMillis Upper bound of retransmission timeout
+ */
+void statisticsAddRtt(Statistics* stats, RttEstimator* rtt, double maxMillis)
+{
+    if(rtt->samples == 0) { return; }
+
+    stats->srttMillis += rtt->srtt;
+    stats->rtoMillis += rttEstimatorTimeout(rtt, maxMillis);
+    stats->rttSessions += 1;
+    stats->rttSamples += rtt->samples;
+}
+
+/**
+ * @brief Adds size and evictions of store of received message IDs of one
+ * session to statistics
+ *
+ * @param stats Pointer to the statistics
+ * @param set Pointer to the store of IDs, NULL if session uses TCP
+ */
+void statisticsAddIdSet(Statistics* stats, MessageIdSet* set)
+{
+    // TCP session has no set
+    if(set == NULL) { return; }
+
+    stats->storedIds += set->len;
+    if(set->peakLen > stats->peakStoredIds) { stats->peakStoredIds = set->peakLen; }
+    stats->idsEvictedByAge += set->evictedByAge;
+    stats->idsEvictedByCapacity += set->evictedByCapacity;
+}
+
+/**
+ * @brief Adds allocations made by pool of one message queue to statistics
+ *
+ * @param stats Pointer to the statistics
+ * @param pool Pointer to the pool of queue
+ */
+void statisticsAddPool(Statistics* stats, MessagePool* pool)
+{
+    stats->poolAllocations += pool->allocations;
+    stats->pooledMessages += pool->acquired;
+}
+
+/**
+ * @brief Prints statistics in human readable format
+ *
+ * @param fs File stream to which statistics will be printed
+ * @param stats Pointer to the statistics
+ */
+void statisticsPrint(FILE* fs, Statistics* stats)
+{
+    fprintf(fs, "Statistics:\n");
+    fprintf(fs, "\tresolve time: %.3f ms%s\n", stats->resolveMillis,
+        stats->resolveCached ? " (cached)" : "");
+
+    if(stats->rttSessions > 0)
+    {
+        fprintf(fs, "\tsrtt: %.3f ms\n", stats->srttMillis / stats->rttSessions);
+        fprintf(fs, "\trto: %.3f ms\n", stats->rtoMillis / stats->rttSessions);
+        fprintf(fs, "\trtt samples: %zu\n", stats->rttSamples);
+    }
+
+    if(stats->transmissions > 0)
+    {
+        fprintf(fs, "\tretransmissions: %zu (%zu messages)\n", 
+            stats->retransmissions, stats->transmissions);
+    }
+
+    if(stats->pooledMessages > 0)
+    {
+        fprintf(fs, "\tqueue allocations: %zu (%zu messages)\n", 
+            stats->poolAllocations, stats->pooledMessages);
+    }
+
+    if(stats->peakStoredIds > 0)
+    {
+        fprintf(fs, "\treceived IDs: %zu stored (peak %zu of %d), evicted %zu by age, "
+            "%zu by capacity\n", stats->storedIds, stats->peakStoredIds, 
+            MESSAGE_ID_SET_CAPACITY, stats->idsEvictedByAge, stats->idsEvictedByCapacity);
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file statistics.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Declaration of structure and functions for Statistics, metrics
+ * collected during run of program and printed at the end (--stats)
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H 1
+
+#include "utils.h"
+#include "rttEstimator.h"
+#include "messagePool.h"
+#include "messageIdSet.h"
+
+/**
+ * @brief Structure holding metrics collected during run of program
+ */
+typedef struct Statistics {
+    double resolveMillis; // time spent by resolving server address
+    bool resolveCached; // server address was loaded from resolve cache
+
+    double srttMillis; // sum of smoothed round trip times of sessions
+    double rtoMillis; // sum of retransmission timeouts of sessions
+    size_t rttSessions; // number of sessions with measured round trip time
+    size_t rttSamples; // number of measured round trip times
+
+    size_t transmissions; // number of UDP messages sended for the first time
+    size_t retransmissions; // number of resended UDP messages
+
+    size_t poolAllocations; // number of heap allocations made by message queues
+    size_t pooledMessages; // number of messages created by message queues
+
+    size_t storedIds; // IDs of received messages remembered at the end
+    size_t peakStoredIds; // maximum of remembered IDs of one session
+    size_t idsEvictedByAge; // IDs older than retransmission horizon
+    size_t idsEvictedByCapacity; // IDs evicted because store was full
+} Statistics;
+
+/**
+ * @brief Initializes statistics
+ *
+ * @param stats Pointer to the statistics
+ */
+void statisticsInit(Statistics* stats);
+
+/**
+ * @brief Adds round trip time estimation of one session to statistics, 
+ * average of all added sessions is printed
+ *
+ * @param stats Pointer to the statistics
+ * @param rtt Pointer to the estimator of session
+ * @param maxMillis Upper bound of retransmission timeout
+ */
+void statisticsAddRtt(Statistics* stats, RttEstimator* rtt, double maxMillis);
+
+/**
+ * @brief Adds size and evictions of store of received message IDs of one
+ * session to statistics
+ *
+ * @param stats Pointer to the statistics
+ * @param set Pointer to the store of IDs, NULL if session uses TCP
+ */
+void statisticsAddIdSet(Statistics* stats, MessageIdSet* set);
+
+/**
+ * @brief Adds allocations made by pool of one message queue to statistics
+ *
+ * @param stats Pointer to the statistics
+ * @param pool Pointer to the pool of queue
+ */
+void statisticsAddPool(Statistics* stats, MessagePool* pool);
+
+/**
+ * @brief Prints statistics in human readable format
+ *
+ * @param fs File stream to which statistics will be printed
+ * @param stats Pointer to the statistics
+ */
+void statisticsPrint(FILE* fs, Statistics* stats);
+
+#endif /*STATISTICS_H*/
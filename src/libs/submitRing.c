@@ -0,0 +1,278 @@
+/**
+ * @file submitRing.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of SubmitRing, bounded lock-free ring through which
+ * threads submit messages to the sender
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "limits.h"
+
+#include "submitRing.h"
+
+#define LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+
+// positions are counted from 0, slot of position is selected by mask
+#define SUBMIT_RING_MASK (SUBMIT_RING_CAPACITY - 1)
+// positions claimed by producers and consumed by consumer are on their own 
+// cache lines, so producers do not slow down consumer and vice versa
+#define SUBMIT_RING_LINE 64
+
+/**
+ * @brief Slot of ring holding one submitted message
+ */
+typedef struct SubmitSlot {
+    // position that can use slot next: equal to position if producer can 
+    // fill it, position + 1 if it was published and consumer can take it
+    size_t sequence;
+    msg_flags msgFlags;
+    unsigned char type;
+    bool control; // message belongs to the control lane
+    size_t used; // length of contents
+    char* overflow; // contents longer than SUBMIT_RING_SLOT_SIZE, NULL otherwise
+    char data[SUBMIT_RING_SLOT_SIZE];
+} SubmitSlot;
+
+/**
+ * @brief Structure holding positions of producers and consumer and slots
+ */
+struct SubmitRing {
+    _Alignas(SUBMIT_RING_LINE) size_t head; // next position claimed by producer
+    _Alignas(SUBMIT_RING_LINE) size_t tail; // next position taken by consumer
+    size_t discardBefore; // messages at lower positions are deleted
+    size_t typeCounts[UCHAR_MAX + 1]; // number of messages of every type in ring
+    pthread_t consumer;
+    bool hasConsumer;
+    _Alignas(SUBMIT_RING_LINE) SubmitSlot slots[SUBMIT_RING_CAPACITY];
+};
+
+/**
+ * @brief Creates new empty ring
+ *
+ * @return SubmitRing* Created ring or NULL if allocation failed
+ */
+SubmitRing* submitRingCreate()
+{
+    SubmitRing* ring = (SubmitRing*) aligned_alloc(SUBMIT_RING_LINE, sizeof(SubmitRing));
+    if(ring == NULL) { return NULL; }
+
+    ring->head = 0;
+    ring->tail = 0;
+    ring->discardBefore = 0;
+    ring->hasConsumer = false;
+    memset(ring->typeCounts, 0, sizeof(ring->typeCounts));
+    for(size_t i = 0; i < SUBMIT_RING_CAPACITY; i++)
+    {
+        ring->slots[i].sequence = i;
+        ring->slots[i].overflow = NULL;
+    }
+
+    return ring;
+}
+
+/**
+ * @brief Destroys ring and messages that were not taken out of it
+ *
+ * @param ring Pointer to the ring, can be NULL
+ */
+void submitRingDestroy(SubmitRing* ring)
+{
+    if(ring == NULL) { return; }
+
+    for(size_t i = 0; i < SUBMIT_RING_CAPACITY; i++)
+    {
+        free(ring->slots[i].overflow);
+    }
+    free(ring);
+}
+
+/**
+ * @brief Copies message into ring, can be called by any thread at any time
+ *
+ * @param ring Pointer to the ring
+ * @param buffer Contents of message
+ * @param msgFlags Flags of message
+ * @param msgType Type of message
+ * @param control Message will be added to the control lane of queue
+ * @return true Message was submitted
+ * @return false Ring is full, nothing was submitted
+ */
+bool submitRingPush(SubmitRing* ring, Buffer* buffer, msg_flags msgFlags, 
+    unsigned char msgType, bool control)
+{
+    size_t position = LOAD_RELAXED(&(ring->head));
+    SubmitSlot* slot;
+
+    // claim position, fails only if other producer claimed it first
+    while(true)
+    {
+        slot = &(ring->slots[position & SUBMIT_RING_MASK]);
+        size_t sequence = LOAD_ACQUIRE(&(slot->sequence));
+
+        if(sequence == position)
+        {
+            if(__atomic_compare_exchange_n(&(ring->head), &position, position + 1, 
+                false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+            // position was updated to the current head
+        }
+        // slot was not taken by consumer yet, ring is full
+        else if(sequence < position)
+        {
+            return false;
+        }
+        else
+        {
+            position = LOAD_RELAXED(&(ring->head));
+        }
+    }
+
+    slot->msgFlags = msgFlags;
+    slot->type = msgType;
+    slot->control = control;
+    slot->used = buffer->used;
+    if(buffer->used <= SUBMIT_RING_SLOT_SIZE)
+    {
+        memcpy(slot->data, buffer->data, buffer->used);
+    }
+    else
+    {
+        slot->overflow = (char*) malloc(buffer->used);
+        if(slot->overflow == NULL)
+        {
+            errHandling("Failed to allocate memory for message in SubmitRing", err_MEMORY_FAIL);
+        }
+        memcpy(slot->overflow, buffer->data, buffer->used);
+    }
+
+    // publish slot to the consumer
+    __atomic_fetch_add(&(ring->typeCounts[msgType]), 1, __ATOMIC_RELEASE);
+    STORE_RELEASE(&(slot->sequence), position + 1);
+    return true;
+}
+
+/**
+ * @brief Moves all published messages from ring to the queue in order in
+ * which they were submitted, data messages submitted before last call of 
+ * submitRingDiscard() are deleted, control messages are always moved to 
+ * the control lane. Can be called only by consumer, caller must hold lock 
+ * of queue.
+ *
+ * @param ring Pointer to the ring
+ * @param queue Queue to which messages are added
+ * @return size_t Number of messages taken out of ring
+ */
+size_t submitRingDrain(SubmitRing* ring, MessageQueue* queue)
+{
+    size_t position = ring->tail;
+    size_t discardBefore = LOAD_ACQUIRE(&(ring->discardBefore));
+    size_t taken = 0;
+
+    while(true)
+    {
+        SubmitSlot* slot = &(ring->slots[position & SUBMIT_RING_MASK]);
+        // ring is empty or producer of next message did not finish yet
+        if(LOAD_ACQUIRE(&(slot->sequence)) != position + 1) { break; }
+
+        Buffer contents = {
+            .data = (slot->overflow != NULL) ? slot->overflow : slot->data,
+            .allocated = slot->used,
+            .used = slot->used
+        };
+
+        // received messages must be confirmed even if data were discarded
+        if(slot->control)
+        {
+            queueAddControlMessage(queue, &contents, slot->msgFlags, slot->type);
+        }
+        else if(position >= discardBefore)
+        {
+            queueAddMessage(queue, &contents, slot->msgFlags, slot->type);
+        }
+
+        free(slot->overflow);
+        slot->overflow = NULL;
+        __atomic_fetch_sub(&(ring->typeCounts[slot->type]), 1, __ATOMIC_RELEASE);
+
+        // slot can be used by producer again after one round
+        STORE_RELEASE(&(slot->sequence), position + SUBMIT_RING_CAPACITY);
+        position += 1;
+        taken += 1;
+    }
+
+    STORE_RELEASE(&(ring->tail), position);
+    return taken;
+}
+
+/**
+ * @brief Marks all data messages that were submitted so far to be deleted 
+ * instead of being moved to the queue, control messages are kept
+ *
+ * @param ring Pointer to the ring
+ */
+void submitRingDiscard(SubmitRing* ring)
+{
+    size_t head = LOAD_ACQUIRE(&(ring->head));
+    size_t discardBefore = LOAD_RELAXED(&(ring->discardBefore));
+
+    // mark never moves back, even if other thread discarded later position 
+    // in the meantime
+    while(discardBefore < head && 
+        !__atomic_compare_exchange_n(&(ring->discardBefore), &discardBefore, head, 
+            false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+}
+
+/**
+ * @brief Returns number of messages in ring, messages that are being 
+ * submitted right now are counted as well
+ *
+ * @param ring Pointer to the ring
+ * @return size_t Number of messages
+ */
+size_t submitRingLength(SubmitRing* ring)
+{
+    size_t tail = LOAD_ACQUIRE(&(ring->tail));
+    size_t head = LOAD_ACQUIRE(&(ring->head));
+
+    return head - tail;
+}
+
+/**
+ * @brief Returns number of messages of provided type in ring, messages 
+ * that are being submitted right now might not be counted
+ *
+ * @param ring Pointer to the ring
+ * @param msgType Type of message
+ * @return size_t Number of messages
+ */
+size_t submitRingCount(SubmitRing* ring, unsigned char msgType)
+{
+    return LOAD_ACQUIRE(&(ring->typeCounts[msgType]));
+}
+
+/**
+ * @brief Sets calling thread as the only consumer of ring
+ *
+ * @param ring Pointer to the ring
+ */
+void submitRingSetConsumer(SubmitRing* ring)
+{
+    ring->consumer = pthread_self();
+    STORE_RELEASE(&(ring->hasConsumer), true);
+}
+
+/**
+ * @brief Returns true if calling thread is consumer of ring
+ *
+ * @param ring Pointer to the ring
+ */
+bool submitRingIsConsumer(SubmitRing* ring)
+{
+    return LOAD_ACQUIRE(&(ring->hasConsumer)) && pthread_equal(ring->consumer, pthread_self());
+}
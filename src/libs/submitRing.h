@@ -0,0 +1,116 @@
+/**
+ * @file submitRing.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Structures and declaration of functions for SubmitRing, bounded 
+ * lock-free ring through which threads submit messages to the sender 
+ * without locking of sending queue
+ *
+ * Any number of threads can push messages into ring (multi-producer), only
+ * one thread (sender) takes them out and moves them to the MessageQueue 
+ * (single-consumer). Every slot holds number of position that can use it 
+ * next, producer claims position with one compare-and-swap and publishes 
+ * slot by storing next position into it, so producers never wait for each 
+ * other or for consumer unless ring is full.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SUBMIT_RING_H
+#define SUBMIT_RING_H 1
+
+#include "msgQueue.h"
+
+// number of slots in ring, must be power of two
+#define SUBMIT_RING_CAPACITY 256
+// size of contents stored in slot, longer messages are copied to the heap
+#define SUBMIT_RING_SLOT_SIZE 1536
+
+/**
+ * @brief Bounded lock-free queue of submitted messages
+ */
+typedef struct SubmitRing SubmitRing;
+
+/**
+ * @brief Creates new empty ring
+ *
+ * @return SubmitRing* Created ring or NULL if allocation failed
+ */
+SubmitRing* submitRingCreate();
+
+/**
+ * @brief Destroys ring and messages that were not taken out of it
+ *
+ * @param ring Pointer to the ring, can be NULL
+ */
+void submitRingDestroy(SubmitRing* ring);
+
+/**
+ * @brief Copies message into ring, can be called by any thread at any time
+ *
+ * @param ring Pointer to the ring
+ * @param buffer Contents of message
+ * @param msgFlags Flags of message
+ * @param msgType Type of message
+ * @param control Message will be added to the control lane of queue
+ * @return true Message was submitted
+ * @return false Ring is full, nothing was submitted
+ */
+bool submitRingPush(SubmitRing* ring, Buffer* buffer, msg_flags msgFlags, 
+    unsigned char msgType, bool control);
+
+/**
+ * @brief Moves all published messages from ring to the queue in order in
+ * which they were submitted, data messages submitted before last call of 
+ * submitRingDiscard() are deleted, control messages are always moved to 
+ * the control lane. Can be called only by consumer, caller must hold lock 
+ * of queue.
+ *
+ * @param ring Pointer to the ring
+ * @param queue Queue to which messages are added
+ * @return size_t Number of messages taken out of ring
+ */
+size_t submitRingDrain(SubmitRing* ring, MessageQueue* queue);
+
+/**
+ * @brief Marks all data messages that were submitted so far to be deleted 
+ * instead of being moved to the queue, control messages are kept
+ *
+ * @param ring Pointer to the ring
+ */
+void submitRingDiscard(SubmitRing* ring);
+
+/**
+ * @brief Returns number of messages in ring, messages that are being 
+ * submitted right now are counted as well
+ *
+ * @param ring Pointer to the ring
+ * @return size_t Number of messages
+ */
+size_t submitRingLength(SubmitRing* ring);
+
+/**
+ * @brief Returns number of messages of provided type in ring, messages 
+ * that are being submitted right now might not be counted
+ *
+ * @param ring Pointer to the ring
+ * @param msgType Type of message
+ * @return size_t Number of messages
+ */
+size_t submitRingCount(SubmitRing* ring, unsigned char msgType);
+
+/**
+ * @brief Sets calling thread as the only consumer of ring
+ *
+ * @param ring Pointer to the ring
+ */
+void submitRingSetConsumer(SubmitRing* ring);
+
+/**
+ * @brief Returns true if calling thread is consumer of ring
+ *
+ * @param ring Pointer to the ring
+ */
+bool submitRingIsConsumer(SubmitRing* ring);
+
+#endif /*SUBMIT_RING_H*/
@@ -9,6 +9,7 @@
  */
 
 #include "utils.h"
+#include "charScan.h"
 
 
 // ----------------------------------------------------------------------------
@@ -56,19 +57,11 @@ bool getWord(BytesBlock* block, char* startOfLastWord, size_t bufferSize)
  */
 long findBlankCharInString(char* string, size_t len)
 {
-    size_t index = 0;
-    for(; index <= len ; index++)
-    {
-        if( string[index] == ' ' || string[index] == '\t' || 
-            string[index] == '\0' || string[index] == '\n' ||
-            string[index] == '\r')
-        { 
-            return index;
-        }
-    }
+    // character at index len is searched as well
+    size_t index = charScanner.findBlank(string, (len < SIZE_MAX) ? len + 1 : len);
 
     // Character was not found
-    return -1;
+    return (index <= len) ? (long) index : -1;
 }
 
 /**
@@ -80,17 +73,11 @@ long findBlankCharInString(char* string, size_t len)
  */
 long findNewLineInString(char* string, size_t len)
 {
-    size_t index = 0;
-    for(; index <= len ; index++)
-    {
-        if(string[index] == '\0' || string[index] == '\n' || string[index] == '\r')
-        { 
-            return index;
-        }
-    }
+    // character at index len is searched as well
+    size_t index = charScanner.findNewLine(string, (len < SIZE_MAX) ? len + 1 : len);
 
     // Character was not found
-    return -1;
+    return (index <= len) ? (long) index : -1;
 }
 
 /**
@@ -102,23 +89,10 @@ long findNewLineInString(char* string, size_t len)
  */
 long skipBlankCharsInString(char* string, size_t len)
 {
-    size_t index = 0;
-    for(; index < len ; index++)
-    {
-        if(! (string[index] == ' ' || string[index] == '\t'))
-        { 
-            return index;
-        }
-
-        if(string[index] == '\0' || string[index] == '\n')
-        {
-            // Character was not found
-            return -1;
-        }
-    }
+    size_t index = charScanner.skipBlank(string, len);
 
     // Character was not found
-    return -1;
+    return (index < len) ? (long) index : -1;
 }
 
 /**
@@ -130,11 +104,7 @@ long skipBlankCharsInString(char* string, size_t len)
  */
 long findZeroInString(char* string, size_t len)
 {
-    long index = 0;
-    while( ((size_t)index < len) && (string[index] != 0) )
-    {
-        index++;
-    }
+    long index = (long) charScanner.findZero(string, len);
 
     if(index <= 0)
     {
@@ -232,8 +202,9 @@ void breakU16IntToBytes(char* high, char* low, uint16_t msgCounter)
  */
 uint16_t convert2BytesToU16Int(char low, char high)
 {
-    // Join bytes into one number
-    return (low +  (high << 8)); 
+    // Join bytes into one number, bytes must be unsigned otherwise values 
+    // above 127 would be negative
+    return ((unsigned char) low + ((unsigned char) high << 8)); 
 }
 
 /**
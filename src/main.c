@@ -13,16 +13,30 @@
 
 #include "getopt.h" // argument processing
 #include "signal.h"
+#include "sys/eventfd.h"
 
 #include "protocolReceiver.h"
 #include "protocolSender.h"
+#include "eventLoop.h"
+#include "sessionGroup.h"
 #include "libs/cleanUpMaster.h"
+#include "libs/charScan.h"
 
 #ifdef DEBUG
     // global variable for printing to debug, only if DEBUG is defined
     pthread_mutex_t debugPrintMutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
+// values of options that have only long variant, outside of range of 
+// characters used for short options
+#define OPT_EVENT_LOOP 256
+#define OPT_SESSIONS 257
+#define OPT_STATS 258
+#define OPT_RESOLVE_CACHE 259
+#define OPT_BACKOFF_CAP 260
+#define OPT_PIPELINE 261
+#define OPT_SUBMIT_RING 262
+
 // global pointer of ProgramInterface, this is needed to ensure correct 
 // closing of program in case of SIGINT
 ProgramInterface* globalProgInt;
@@ -50,16 +64,29 @@ int errHandling(const char* msg, int errorCode)
         // print error message
         fprintf(stderr, "ERR: %s\n", msg);
         // signal main thread (stdin handling) to wake up and stop 
-        pthread_cond_signal(globalProgInt->threads->mainCond);
+        notifierNotify(&(globalProgInt->threads->mainNotifier));
         // empty whole queue
         queueLock(globalProgInt->threads->sendingQueue);
         queuePopAllMessages(globalProgInt->threads->sendingQueue);
         queueUnlock(globalProgInt->threads->sendingQueue);
         // add bye to message queue
         sendBye(globalProgInt);
-        // wait on sender to send signal, to make sure program interface is not destroy before bye was send
-        pthread_cond_wait(globalProgInt->threads->mainCond, 
-            globalProgInt->threads->mainMutex);
+        if(globalProgInt->cleanUp->eventLoop != NULL)
+        {
+            // there is no sender thread, bye must be sended from this one
+            eventLoopDrain(globalProgInt);
+        }
+        else
+        {
+            // wait on sender to end program, to make sure program interface 
+            // is not destroyed before bye was sended
+            Notifier* mainNotifier = &(globalProgInt->threads->mainNotifier);
+            uint64_t seen = notifierSequence(mainNotifier);
+            while(getProgramState(globalProgInt) != fsm_END)
+            {
+                seen = notifierWait(mainNotifier, seen, NULL);
+            }
+        }
 
         // destroy program interface
         programInterfaceDestroy(globalProgInt);
@@ -85,12 +112,26 @@ int errHandling(const char* msg, int errorCode)
  * 
  * @param argc Number of arguments given
  * @param argv Array of arguments strings (char pointers)
+ * @param config Network configuration to which options will be stored
+ * @param ipAddress Buffer to which server address will be stored
  */
-void processArguments(int argc, char* argv[], enum Protocols* prot, Buffer* ipAddress, uint16_t* portNum, uint16_t* udpTimeout, uint8_t* udpRetrans)
+void processArguments(int argc, char* argv[], NetworkConfig* config, Buffer* ipAddress)
 {
+    // options that have only long variant
+    static struct option longOptions[] = {
+        {"event-loop", no_argument, NULL, OPT_EVENT_LOOP},
+        {"sessions", required_argument, NULL, OPT_SESSIONS},
+        {"stats", no_argument, NULL, OPT_STATS},
+        {"resolve-cache", required_argument, NULL, OPT_RESOLVE_CACHE},
+        {"backoff-cap", required_argument, NULL, OPT_BACKOFF_CAP},
+        {"pipeline", required_argument, NULL, OPT_PIPELINE},
+        {"submit-ring", no_argument, NULL, OPT_SUBMIT_RING},
+        {NULL, 0, NULL, 0}
+    };
+
     int opt;
     size_t optLen;
-    while((opt = getopt(argc, argv, "ht:s:p:d:r:")) != -1)
+    while((opt = getopt_long(argc, argv, "ht:s:p:d:r:w:", longOptions, NULL)) != -1)
     {
         switch (opt)
         {
@@ -99,8 +140,8 @@ void processArguments(int argc, char* argv[], enum Protocols* prot, Buffer* ipAd
             errHandling("", 0);
             break;
         case 't':
-            if(strcmp(optarg, "udp") == 0) { *prot = prot_UDP; }
-            else if(strcmp(optarg, "tcp") == 0) { *prot = prot_TCP; }
+            if(strcmp(optarg, "udp") == 0) { config->protocol = prot_UDP; }
+            else if(strcmp(optarg, "tcp") == 0) { config->protocol = prot_TCP; }
             else
             {
                 errHandling("Unknown protocol provided in -t option. Use -h for help", err_MISING_PROGRAM_ARG);
@@ -115,13 +156,51 @@ void processArguments(int argc, char* argv[], enum Protocols* prot, Buffer* ipAd
             ipAddress->used = optLen + 1;
             break;
         case 'p':
-            *portNum = (uint16_t)atoi(optarg);
+            config->portNumber = (uint16_t)atoi(optarg);
             break;
         case 'd':
-            *udpTimeout = (uint16_t)atoi(optarg);
+            config->udpTimeout = (uint16_t)atoi(optarg);
             break;
         case 'r':
-            *udpRetrans = (uint8_t)atoi(optarg);
+            config->udpMaxRetries = (uint8_t)atoi(optarg);
+            break;
+        case 'w':
+            config->udpWindow = (uint16_t)atoi(optarg);
+            if(config->udpWindow == 0)
+            {
+                errHandling("Window size (-w) must be at least 1. Use -h for help", err_MISING_PROGRAM_ARG);
+            }
+            break;
+        case OPT_EVENT_LOOP:
+            config->useEventLoop = true;
+            break;
+        case OPT_SESSIONS:
+            config->sessions = (uint32_t)atol(optarg);
+            if(config->sessions == 0)
+            {
+                errHandling("Number of sessions (--sessions) must be at least 1. Use -h for help", err_MISING_PROGRAM_ARG);
+            }
+            // sessions are driven by event loop
+            config->useEventLoop = true;
+            break;
+        case OPT_STATS:
+            config->printStats = true;
+            break;
+        case OPT_RESOLVE_CACHE:
+            config->resolveCache = optarg;
+            break;
+        case OPT_BACKOFF_CAP:
+            config->udpBackoffCap = (uint32_t)atol(optarg);
+            break;
+        case OPT_PIPELINE:
+            config->pipelineDepth = (uint16_t)atoi(optarg);
+            if(config->pipelineDepth == 0)
+            {
+                errHandling("Pipeline depth (--pipeline) must be at least 1. Use -h for help", err_MISING_PROGRAM_ARG);
+            }
+            break;
+        case OPT_SUBMIT_RING:
+            config->useSubmitRing = true;
             break;
         default:
             errHandling("Unknown option. Use -h for help", err_MISING_PROGRAM_ARG);
@@ -134,6 +213,24 @@ void processArguments(int argc, char* argv[], enum Protocols* prot, Buffer* ipAd
 //
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Returns true if user can send messages, join channel or rename in 
+ * current state of program. Pipelined input can queue them as soon as AUTH
+ * was queued, sender holds them until program is authenticated.
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ */
+bool isDataAllowed(ProgramInterface* progInt)
+{
+    fsm_t state = getProgramState(progInt);
+    if(progInt->netConfig->pipelineDepth > 0)
+    {
+        return state > fsm_START && state <= fsm_JOIN_ATEMPT;
+    }
+
+    return state == fsm_OPEN;
+}
+
 /**
  * @brief Filters commands by CommandType (cmd_t) and returns 
  * if they should be sended
@@ -153,15 +250,9 @@ bool filterCommandsByFSM(ProtocolBlocks* pBlocks, ProgramInterface* progInt, msg
     {
     case cmd_AUTH:
         // commands: CMD, USERNAME, SECRET, DISPLAYNAME
-        bufferResize(&(progInt->comDetails->displayName), pBlocks->cmd_auth_displayname.len + 1);
-
-        stringReplace(  progInt->comDetails->displayName.data, 
-                        pBlocks->cmd_auth_displayname.start, 
+        setDisplayName(progInt, pBlocks->cmd_auth_displayname.start, 
                         pBlocks->cmd_auth_displayname.len);
 
-        progInt->comDetails->displayName.used = pBlocks->cmd_auth_displayname.len;
-        progInt->comDetails->displayName.data[pBlocks->cmd_auth_displayname.len] = '\0';
-
         if( getProgramState(progInt) == fsm_START )
         {
             *flags = msg_flag_AUTH;
@@ -175,7 +266,7 @@ bool filterCommandsByFSM(ProtocolBlocks* pBlocks, ProgramInterface* progInt, msg
         break;
     case cmd_JOIN:
         // can only be send in open state
-        if(getProgramState(progInt) == fsm_OPEN)
+        if(isDataAllowed(progInt))
         {
             // commands: CMD, CHANNELID
             bufferResize(&(progInt->comDetails->channelID), pBlocks->cmd_join_channelID.len + 1);
@@ -190,22 +281,17 @@ bool filterCommandsByFSM(ProtocolBlocks* pBlocks, ProgramInterface* progInt, msg
         break;
     case cmd_RENAME:
         // can only be send in open state
-        if(getProgramState(progInt) == fsm_OPEN)
+        if(isDataAllowed(progInt))
         {
             // replace displayname stored in Communication Details with data 
             // from user provided command
-            bufferResize(   &(progInt->comDetails->displayName), 
-                            pBlocks->cmd_rename_displayname.len + 1);
-            stringReplace(  progInt->comDetails->displayName.data, 
-                            pBlocks->cmd_rename_displayname.start, 
+            setDisplayName(progInt, pBlocks->cmd_rename_displayname.start, 
                             pBlocks->cmd_rename_displayname.len);
-            progInt->comDetails->displayName.used = pBlocks->cmd_rename_displayname.len;
-            progInt->comDetails->displayName.data[progInt->comDetails->displayName.used] = 0;
             return false; // rename is local only, dont send
         }
         break;
     case cmd_MSG:
-        if(getProgramState(progInt) == fsm_OPEN)
+        if(isDataAllowed(progInt))
         {
             return true; // send message
         }
@@ -229,6 +315,132 @@ bool filterCommandsByFSM(ProtocolBlocks* pBlocks, ProgramInterface* progInt, msg
 //
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Converts line of user input into an protocol message 
+ * and adds it to the sending queue
+ * 
+ * @param progInt Pointer to the program interface
+ * @param clientInput Line of user input
+ * @param pBlocks ProtocolBlocks to which user input will be separated
+ * @return true Message was added to the sending queue
+ * @return false Input was local only, message couldn't be assembled or 
+ * input was ended by /exit in pipelined mode
+ */
+bool queueUserInput(ProgramInterface* progInt, Buffer* clientInput, ProtocolBlocks* pBlocks)
+{
+    Buffer* protocolMsg = &(progInt->cleanUp->protocolToSendedByMain);
+
+    int canBeSended = false;
+    msg_flags flags = msg_flag_NONE;
+
+    // Separate clientCommands buffer into commands (ByteBlocks),
+    // store recognized command
+    canBeSended = userInputToCmds(clientInput, pBlocks, &flags);
+
+    // Filter commands by type and FSM state
+    canBeSended = filterCommandsByFSM(pBlocks, progInt, &flags);
+
+    // if message should not be send skip it because it is local only
+    if(!canBeSended) { return false; }
+
+    // pipelined input is ended by /exit same as by end of file, BYE must 
+    // wait for messages queued before it
+    if(pBlocks->type == cmd_EXIT && progInt->netConfig->pipelineDepth > 0) { return false; }
+
+    // Assembles array of bytes into Buffer protocolMsg, returns if 
+    // message can be trasmitted
+    UDP_VARIANT
+        canBeSended = assembleProtocolUDP(pBlocks, protocolMsg, progInt);
+    TCP_VARIANT
+        canBeSended = assembleProtocolTCP(pBlocks, protocolMsg, progInt);
+    END_VARIANTS
+    // if message wasnt assebled correcttly
+    if(!canBeSended) { return false; }
+    
+    // add message to the queue
+    submitMessage(progInt, protocolMsg, flags, pBlocks->type, false);
+
+    // sender might be waiting because queue was empty or for confirmations
+    // while there is still room in the sending window for this message
+    notifierNotify(&(progInt->threads->senderNotifier));
+
+    // Exit loop if /exit detected 
+    if(pBlocks->type == cmd_EXIT || pBlocks->type == msg_BYE)
+    {
+        // set state to empty queue, send bye and exit
+        setProgramState(progInt, fsm_EMPTY_Q_BYE);
+        // wake up sender to exit
+        notifierNotify(&(progInt->threads->senderNotifier));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns true if main can process next user input. Main waits for 
+ * reply to AUTH and JOIN and for room in sending window (UDP), TCP stream 
+ * keeps order of messages by itself so messages are never waited for.
+ * Pipelined input waits only for room in pipeline.
+ * 
+ * @param progInt Pointer to the program interface
+ */
+bool canProcessInput(ProgramInterface* progInt)
+{
+    fsm_t state = getProgramState(progInt);
+    // program is ending
+    if(state >= fsm_EMPTY_Q_BYE) { return true; }
+
+    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
+    uint16_t pipelineDepth = progInt->netConfig->pipelineDepth;
+    if(pipelineDepth > 0)
+    {
+        queueLock(sendingQueue);
+        bool hasRoom = queuePendingLength(sendingQueue) < pipelineDepth;
+        queueUnlock(sendingQueue);
+        return hasRoom;
+    }
+
+    // authentication failed and user can try again
+    if(state == fsm_START) { return true; }
+    // waiting for reply to AUTH or JOIN
+    if(state != fsm_OPEN) { return false; }
+
+    queueLock(sendingQueue);
+    // JOIN that was not sended yet doesn't change state of program 
+    bool canProcess = !queueHasPending(sendingQueue, msg_JOIN);
+    UDP_VARIANT
+        canProcess = canProcess && 
+            queuePendingLength(sendingQueue) < progInt->netConfig->udpWindow;
+    END_VARIANTS
+    queueUnlock(sendingQueue);
+
+    return canProcess;
+}
+
+/**
+ * @brief Returns true if all user messages queued by pipelined input were
+ * processed, so program can start ending. Always true if input is not 
+ * pipelined.
+ * 
+ * @param progInt Pointer to the program interface
+ */
+bool isPipelineDrained(ProgramInterface* progInt)
+{
+    if(progInt->netConfig->pipelineDepth == 0) { return true; }
+
+    fsm_t state = getProgramState(progInt);
+    if(state >= fsm_EMPTY_Q_BYE) { return true; }
+    // waiting for reply to AUTH or JOIN
+    if(state != fsm_OPEN && state != fsm_START) { return false; }
+
+    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
+    queueLock(sendingQueue);
+    bool drained = queuePendingLength(sendingQueue) == 0;
+    queueUnlock(sendingQueue);
+
+    return drained;
+}
+
 /**
  * @brief Main loop for user input
  * 
@@ -236,13 +448,11 @@ bool filterCommandsByFSM(ProtocolBlocks* pBlocks, ProgramInterface* progInt, msg
  */
 void userCommandHandling(ProgramInterface* progInt)
 {
-    // use already allocated buffers for global freeing in case of SIGINT
-    Buffer* protocolMsg = &(progInt->cleanUp->protocolToSendedByMain);
-    Buffer* clientInput = &(progInt->cleanUp->clientInput);
+    // reader is stored in clean up for global freeing in case of SIGINT
+    LineReader* stdinReader = &(progInt->cleanUp->stdinReader);
+    Buffer clientInput;
 
-    int canBeSended;
     bool eofDetected = false;
-    msg_flags flags = msg_flag_NONE;
     ProtocolBlocks pBlocks;
 
     // main shall stop to work in these states: fsm_ERR, fsm_SIGINT_BYE, fsm_END
@@ -253,70 +463,49 @@ void userCommandHandling(ProgramInterface* progInt)
         // eof was detected in last loop, send bye and exit
         if(eofDetected)
         {
+            // messages queued by pipelined input are processed first
+            if(!isPipelineDrained(progInt))
+            {
+                Notifier* mainNotifier = &(progInt->threads->mainNotifier);
+                uint64_t seen = notifierSequence(mainNotifier);
+                while(!isPipelineDrained(progInt))
+                {
+                    seen = notifierWait(mainNotifier, seen, NULL);
+                }
+                continue;
+            }
+
             // set program to empty queue and leave
             setProgramState(progInt, fsm_EMPTY_Q_BYE);
             // add bye to the message queue
             sendBye(progInt);
             // wake up sender to exit
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
+            notifierNotify(&(progInt->threads->senderNotifier));
             continue;
         }
 
         // --------------------------------------------------------------------
         // Convert user input into an protocol
         // --------------------------------------------------------------------
-        canBeSended = false;
-        // Load buffer from stdin, store length of buffer
-        clientInput->used = loadBufferFromStdin(clientInput, &eofDetected);
-        // Separate clientCommands buffer into commands (ByteBlocks),
-        // store recognized command
-        flags = msg_flag_NONE;
-        canBeSended = userInputToCmds(clientInput, &pBlocks, &flags);
-
-        // Filter commands by type and FSM state
-        canBeSended = filterCommandsByFSM(&pBlocks, progInt, &flags);
-
-        // if message should not be send skip it because it is local only
-        if(!canBeSended) { continue; }
-
-        // Assembles array of bytes into Buffer protocolMsg, returns if 
-        // message can be trasmitted
-        UDP_VARIANT
-            canBeSended = assembleProtocolUDP(&pBlocks, protocolMsg, progInt);
-        TCP_VARIANT
-            canBeSended = assembleProtocolTCP(&pBlocks, protocolMsg, progInt);
-        END_VARIANTS
-        // if message wasnt assebled correcttly
-        if(!canBeSended) { continue; }
-        
-        // add message to the queue
-        queueLock(progInt->threads->sendingQueue);
-
-        // if queue is empty store that sender should be signaled
-        bool signalSender = false;
-        if(queueIsEmpty(progInt->threads->sendingQueue)) { signalSender = true; }
-        
-        queueAddMessage(progInt->threads->sendingQueue, protocolMsg, flags, pBlocks.type);
-        // signal sender if he is waiting because queue is empty
-        if(signalSender || pBlocks.type == msg_AUTH || pBlocks.type == cmd_AUTH)
+        // Load line from stdin, line points into reader
+        lineReaderNext(stdinReader, &clientInput, &eofDetected);
+
+        if(!queueUserInput(progInt, &clientInput, &pBlocks))
         {
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
+            // pipelined input was ended by /exit
+            if(pBlocks.type == cmd_EXIT) { eofDetected = true; }
+            continue;
         }
-        queueUnlock(progInt->threads->sendingQueue);
 
-                    
-        // Exit loop if /exit detected 
-        if(pBlocks.type == cmd_EXIT || pBlocks.type == msg_BYE)
+        // wait for message to be processed (confirmed or replied), sequence
+        // is read before predicate so no notification can be missed
+        Notifier* mainNotifier = &(progInt->threads->mainNotifier);
+        uint64_t seen = notifierSequence(mainNotifier);
+        while(!canProcessInput(progInt))
         {
-            // set state to empty queue, send bye and exit
-            setProgramState(progInt, fsm_EMPTY_Q_BYE);
-            // wake up sender to exit
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
+            debugPrint(stdout, "DEBUG: Main waiting\n");
+            seen = notifierWait(mainNotifier, seen, NULL);
         }
-
-        debugPrint(stdout, "DEBUG: Main waiting\n");
-        // wait for message to be processed/confirmed
-        pthread_cond_wait(progInt->threads->mainCond, progInt->threads->mainMutex);
     }
 }
 
@@ -338,6 +527,9 @@ int main(int argc, char* argv[])
         exit(1);
     }
 
+    // pick implementation of string searching supported by CPU
+    charScanInit();
+
     // initialize Program Interface
     programInterfaceInit(progInt);
     // set global program interface for SIGINT handling
@@ -355,9 +547,7 @@ int main(int argc, char* argv[])
 
     defaultNetworkConfig(progInt->netConfig);
 
-    processArguments(argc, argv, &(progInt->netConfig->protocol), ipAddress, 
-                    &(progInt->netConfig->portNumber), &(progInt->netConfig->udpTimeout), 
-                    &(progInt->netConfig->udpMaxRetries));
+    processArguments(argc, argv, progInt->netConfig, ipAddress);
     if(progInt->netConfig->protocol == prot_ERR)
     { 
         errHandling("Argument protocol (-t udp / tcp) is mandatory!", err_MISING_PROGRAM_ARG);
@@ -367,56 +557,117 @@ int main(int argc, char* argv[])
         errHandling("Server address is (-s address) is mandatory", err_MISING_PROGRAM_ARG); 
     }
 
+    // IDs of received messages are needed only to detect duplicate UDP 
+    // messages, sessions create their own set
+    if(progInt->netConfig->protocol == prot_UDP && progInt->netConfig->sessions == 0)
+    {
+        progInt->cleanUp->confirmedMessages = messageIdSetCreate();
+        if(progInt->cleanUp->confirmedMessages == NULL)
+        {
+            errHandling("Failed to allocate memory for MessageIdSet", err_MEMORY_FAIL);
+        }
+    }
+
     // ------------------------------------------------------------------------
     // Get server information, create socket
     // ------------------------------------------------------------------------
 
-    // open socket for comunication on client side (this)
-    progInt->netConfig->openedSocket = getSocket(progInt->netConfig->protocol);
-    
-    struct sockaddr_in address = findServer(ipAddress->data, progInt->netConfig->portNumber);
+    // server address is resolved in background while batches are created
+    ServerLookup lookup;
+    findServerStart(&lookup, ipAddress->data, progInt->netConfig->portNumber,
+        progInt->netConfig->resolveCache);
 
-    // get server address
-    progInt->netConfig->serverAddress = (struct sockaddr*) &address;
-    progInt->netConfig->serverAddressSize = sizeof(address);
+    // messages are sended in batches if io_uring is available, otherwise
+    // UDP datagrams are sended in batches with sendmmsg()
+    progInt->cleanUp->sendRing = ioRingCreate(false);
+    if(progInt->cleanUp->sendRing == NULL && progInt->netConfig->protocol == prot_UDP)
+    {
+        progInt->cleanUp->sendBatch = datagramBatchCreate();
+    }
 
-    UDP_VARIANT
+    findServerFinish(&lookup, progInt->netConfig);
+    progInt->stats->resolveMillis = lookup.resolveMillis;
+    progInt->stats->resolveCached = lookup.cached;
 
-    TCP_VARIANT
-        const int res = connect( progInt->netConfig->openedSocket, 
-                    progInt->netConfig->serverAddress,
-                    progInt->netConfig->serverAddressSize);
-        if( res != 0 ) {
-            errHandling("Failed to connect to the server", err_NETWORK_INIT);
-        } 
-    END_VARIANTS
+    if(progInt->netConfig->sessions > 0)
+    {
+        // --------------------------------------------------------------------
+        // Loop of communication of multiple sessions in single thread
+        // --------------------------------------------------------------------
 
-    // ------------------------------------------------------------------------
-    // Setup second thread that will handle data receiving
-    // ------------------------------------------------------------------------
+        sessionGroupRun(progInt, progInt->netConfig->sessions);
 
-    pthread_t protReceiver;
-    pthread_create(&protReceiver, NULL, protocolReceiver, progInt);
+        if(progInt->netConfig->printStats) { statisticsPrint(stderr, progInt->stats); }
+        programInterfaceDestroy(progInt);
+        return 0;
+    }
 
-    pthread_t protSender;
-    pthread_create(&protSender, NULL, protocolSender, progInt);
+    // open socket for comunication on client side (this), TCP connection 
+    // is raced across all addresses of server
+    openServerConnection(progInt->netConfig);
 
-    // ------------------------------------------------------------------------
-    // Loop of communication
-    // ------------------------------------------------------------------------
+    if(progInt->netConfig->useEventLoop)
+    {
+        // --------------------------------------------------------------------
+        // Loop of communication in single thread
+        // --------------------------------------------------------------------
 
-    userCommandHandling(progInt);
+        eventLoopRun(progInt);
+    }
+    else
+    {
+        // --------------------------------------------------------------------
+        // Setup second thread that will handle data receiving
+        // --------------------------------------------------------------------
 
-    // ------------------------------------------------------------------------
-    // Clean up resources 
-    // ------------------------------------------------------------------------
+        // receiver blocks on socket and is woken through eventfd when 
+        // program ends
+        progInt->threads->wakeFd = eventfd(0, EFD_CLOEXEC);
+        if(progInt->threads->wakeFd < 0)
+        {
+            errHandling("Failed to create eventfd for receiver", err_INTERNAL_UNEXPECTED_RESULT);
+        }
 
-    pthread_join(protReceiver, NULL);
-    pthread_join(protSender, NULL);
+        // main and receiver submit messages to sender without locking 
+        // sending queue
+        if(progInt->netConfig->useSubmitRing)
+        {
+            progInt->threads->sendingQueue->submitRing = submitRingCreate();
+            if(progInt->threads->sendingQueue->submitRing == NULL)
+            {
+                errHandling("Failed to allocate memory for SubmitRing", err_MEMORY_FAIL);
+            }
+        }
+
+        pthread_t protReceiver;
+        pthread_create(&protReceiver, NULL, protocolReceiver, progInt);
+
+        pthread_t protSender;
+        pthread_create(&protSender, NULL, protocolSender, progInt);
+
+        // --------------------------------------------------------------------
+        // Loop of communication
+        // --------------------------------------------------------------------
+
+        userCommandHandling(progInt);
+
+        // --------------------------------------------------------------------
+        // Clean up resources 
+        // --------------------------------------------------------------------
+
+        pthread_join(protReceiver, NULL);
+        pthread_join(protSender, NULL);
+    }
 
     debugPrint(stdout, "DEBUG: Communicaton ended with %u messages\n", 
         ((progInt->comDetails->msgCounter > 0)? 0 : progInt->comDetails->msgCounter - 1));
 
+    statisticsAddRtt(progInt->stats, &(progInt->comDetails->rtt), 
+        progInt->netConfig->udpTimeout);
+    statisticsAddPool(progInt->stats, &(progInt->threads->sendingQueue->pool));
+    statisticsAddIdSet(progInt->stats, progInt->cleanUp->confirmedMessages);
+    if(progInt->netConfig->printStats) { statisticsPrint(stderr, progInt->stats); }
+
     // close socket
     shutdown(progInt->netConfig->openedSocket, SHUT_RDWR);
     // destroy program interface
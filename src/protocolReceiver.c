@@ -11,6 +11,7 @@
 
 #include "protocolReceiver.h"
 #include "sys/time.h"
+#include "poll.h"
 
 /**
  * @brief Prints incoming message (MSG/ERR) in correct format and 
@@ -72,7 +73,34 @@ void printIncomingMessage(ProgramInterface* progInt, ProtocolBlocks* pBlocks)
 }
 
 /**
- * @brief Create confirm protocol
+ * @brief Adds message to the sending queue, caller must not hold lock of 
+ * sending queue. If submit ring of queue is full, sender is woken up and 
+ * message is submitted again until there is room or until program ends.
+ * 
+ * @param progInt Pointer to Program Interface
+ * @param buffer Contents of message
+ * @param flags Flags to be added to the message
+ * @param msgType Type of message
+ * @param control Message is added to the control lane and sended before 
+ * other messages in queue
+ */
+void submitMessage(ProgramInterface* progInt, Buffer* buffer, msg_flags flags, 
+    unsigned char msgType, bool control)
+{
+    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
+    while(!queueSubmitMessage(sendingQueue, buffer, flags, msgType, control))
+    {
+        // sender ended, nobody would send message anyway
+        if(getProgramState(progInt) == fsm_END) { return; }
+
+        notifierNotify(&(progInt->threads->senderNotifier));
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Create confirm protocol and adds it to the sending queue, caller 
+ * must not hold lock of sending queue
  * 
  * @param serverResponse Buffer from which will referenceID be taken
  * @param receiverSendMsgs Buffer to which should message be stored
@@ -111,11 +139,14 @@ void sendConfirm(Buffer* serverResponse, Buffer* receiverSendMsgs, ProgramInterf
             err_INTERNAL_UNEXPECTED_RESULT);
     }
 
-    queueAddMessagePriority(progInt->threads->sendingQueue, receiverSendMsgs, flags, pBlocks.type);
+    submitMessage(progInt, receiverSendMsgs, flags, pBlocks.type, true);
+    // confirm is sended right away even if sender waits for retransmission
+    notifierNotify(&(progInt->threads->senderNotifier));
 }
 
 /**
- * @brief Creates BYE message and sends it to server
+ * @brief Creates BYE message and sends it to server, caller must not hold 
+ * lock of sending queue
  * 
  * @param progInt Pointer to program interface
  */
@@ -125,25 +156,26 @@ void sendBye(ProgramInterface* progInt)
     resetProtocolBlocks(&pBlocks);
     pBlocks.type = cmd_EXIT;
 
-    queueLock(progInt->threads->sendingQueue);
+    // BYE can be sended by any thread, it has its own buffer
+    Buffer bye;
+    bufferInit(&bye);
 
     // assemble BYE protocol
     if(progInt->netConfig->protocol == prot_UDP) {
-        assembleProtocolUDP(&pBlocks, &progInt->cleanUp->protocolToSendedByMain, progInt);
+        assembleProtocolUDP(&pBlocks, &bye, progInt);
     } else if(progInt->netConfig->protocol == prot_TCP) {
-        assembleProtocolTCP(&pBlocks, &progInt->cleanUp->protocolToSendedByMain, progInt);
+        assembleProtocolTCP(&pBlocks, &bye, progInt);
     }
 
     // add message to the queue
-    queueAddMessage(progInt->threads->sendingQueue, 
-        &progInt->cleanUp->protocolToSendedByMain,
-        msg_flag_BYE, msg_BYE);
+    submitMessage(progInt, &bye, msg_flag_BYE, msg_BYE, false);
 
-    queueUnlock(progInt->threads->sendingQueue);
+    bufferDestroy(&bye);
 }
 
 /**
- * @brief Create err protocol
+ * @brief Create err protocol and adds it to the sending queue, caller must 
+ * not hold lock of sending queue
  * 
  * @param receiverSendMsgs Buffer to which should message be stored
  * @param progInt Pointer to Program Interface
@@ -176,15 +208,12 @@ void sendError(Buffer* receiverSendMsgs, ProgramInterface* progInt, const char*
         res = assembleProtocolTCP(&pBlocks, receiverSendMsgs, progInt);        
     END_VARIANTS
 
-    queueLock(progInt->threads->sendingQueue);
     if(!res)
     {
         errHandling("Assembling of error protocol failed\n", 
             err_INTERNAL_UNEXPECTED_RESULT);
     }
-    queueAddMessage(progInt->threads->sendingQueue, receiverSendMsgs, msg_flag_ERR, cmd_ERR);
-
-    queueUnlock(progInt->threads->sendingQueue);
+    submitMessage(progInt, receiverSendMsgs, msg_flag_ERR, pBlocks.type, false);
 }
 
 /**
@@ -196,17 +225,21 @@ void sendError(Buffer* receiverSendMsgs, ProgramInterface* progInt, const char*
  */
 void handleConfirmUDP(ProgramInterface* progInt, MessageQueue* sendingQueue, u_int16_t msgID)
 {
-    Message* topOfQueue; 
-
     queueLock(sendingQueue);
-    // check if top is not empty
-    if((topOfQueue = queueGetMessage(sendingQueue)) == NULL)
-    { queueUnlock(sendingQueue); return; }
+    // find message in sending window that is being confirmed
+    Message* confirmedMsg = queueFindSendedMessage(sendingQueue, msgID);
 
-    uint16_t queueTopMsgID = queueGetMessageID(sendingQueue);
-    
-    // if first in queue is same as incoming confirm, confirm message
-    if(msgID != queueTopMsgID && topOfQueue->type != msg_AUTH)
+    // confirmation of AUTH message is accepted even with different message id
+    if(confirmedMsg == NULL)
+    {
+        Message* topOfQueue = queueGetMessage(sendingQueue);
+        if(topOfQueue != NULL && topOfQueue->type == msg_AUTH && topOfQueue->sendCount > 0)
+        {
+            confirmedMsg = topOfQueue;
+        }
+    }
+
+    if(confirmedMsg == NULL)
     { 
         queueUnlock(sendingQueue);
         debugPrintSeparator(stdout);
@@ -215,16 +248,24 @@ void handleConfirmUDP(ProgramInterface* progInt, MessageQueue* sendingQueue, u_i
         return;
     }
 
-    // confirm message
-    topOfQueue->confirmed = true;
-    // increase global counter message counter
-    progInt->comDetails->msgCounter = msgID + 1;
+    // measure round trip time only if message was sended once, it is not 
+    // known which transmission was confirmed otherwise (Karn's rule)
+    if(!confirmedMsg->confirmed && confirmedMsg->sendCount == 1)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double sample = (now.tv_sec - confirmedMsg->sentAt.tv_sec) * 1000.0 + 
+            (now.tv_nsec - confirmedMsg->sentAt.tv_nsec) / (1000.0 * 1000.0);
+        rttEstimatorSample(&(progInt->comDetails->rtt), sample);
+    }
 
+    // confirm message
+    confirmedMsg->confirmed = true;
 
     #ifdef DEBUG
         debugPrint(stdout, "DEBUG: Msg sended by sender was "
-            "confirmed, id: %i\n", queueTopMsgID);
-        bufferPrint(topOfQueue->buffer, 9);
+            "confirmed, id: %i\n", msgID);
+        bufferPrint(confirmedMsg->buffer, 9);
     #endif
 
     switch (getProgramState(progInt))
@@ -237,20 +278,21 @@ void handleConfirmUDP(ProgramInterface* progInt, MessageQueue* sendingQueue, u_i
         break;
     // received confirmation of bye
     case fsm_END_W84_CONF: // BYE was send and waiting for confirm
+        // confirmations of other messages in window can still arrive
+        if(uchar2msgType(confirmedMsg->type) != msg_BYE) { break; }
         // change state to end the program
         setProgramState(progInt, fsm_END);
         // signal main to end
-        pthread_cond_signal(progInt->threads->mainCond);
-        break;
-    case fsm_OPEN: // signal main that next message can be processed
-        // client send message and is waiting for confirm
-        pthread_cond_signal(progInt->threads->mainCond);
+        notifierNotify(&(progInt->threads->mainNotifier));
         break;
     default:
         break;
     }
-        
-    pthread_cond_signal(progInt->threads->rec2SenderCond);
+
+    // signal main that next message can be processed, confirmed message 
+    // left sending window
+    notifierNotify(&(progInt->threads->mainNotifier));
+    notifierNotify(&(progInt->threads->senderNotifier));
     queueUnlock(sendingQueue);
     return;
 }
@@ -259,13 +301,12 @@ void handleConfirmUDP(ProgramInterface* progInt, MessageQueue* sendingQueue, u_i
  * @brief Function to handle received UDP replies 
  * 
  * @param progInt Global Program Interface
- * @param msgID ID received message ID
  * @param pBlocks ProtocolBlocks that holds dissasembled data from message
  * @param sendingQueue Pointer to the MessageQueue that will be sended by sender
  * @param serverResponse Buffer that holds server response
  * @param receiverSendMsgs Buffer for sending confirm messages
  */
-void handleReplyUDP( ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlocks, MessageQueue* sendingQueue,
+void handleReplyUDP( ProgramInterface* progInt, ProtocolBlocks* pBlocks, MessageQueue* sendingQueue,
     Buffer* serverResponse, Buffer* receiverSendMsgs)
 {
     // if waiting for authetication reply
@@ -286,16 +327,14 @@ void handleReplyUDP( ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks*
             // set state to OPEN
             setProgramState(progInt, fsm_W84_REPLY_CONF);
 
-            queueLock(sendingQueue);
             // send confirm message
             sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
-            queueUnlock(sendingQueue);
 
             // ping / signal sender
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
-            pthread_cond_signal(progInt->threads->rec2SenderCond);
+            notifierNotify(&(progInt->threads->senderNotifier));
 
-            safePrintStderr("Success: %s\n", pBlocks->msg_reply_MsgContents.start);
+            safePrintStderr("Success: %.*s\n", (int) pBlocks->msg_reply_MsgContents.len, 
+                pBlocks->msg_reply_MsgContents.start);
         }
         else
         {
@@ -313,20 +352,20 @@ void handleReplyUDP( ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks*
             {
                 setProgramState(progInt, fsm_OPEN);
             }
-            
+            queueUnlock(sendingQueue);
+
             // send confirm message
             sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_NOK_REPLY);
-            queueUnlock(sendingQueue);
 
             // signal sender that new message has been added
+            notifierNotify(&(progInt->threads->senderNotifier));
 
-            safePrintStderr("Failure: %s\n", pBlocks->msg_reply_MsgContents.start);
+            safePrintStderr("Failure: %.*s\n", (int) pBlocks->msg_reply_MsgContents.len, 
+                pBlocks->msg_reply_MsgContents.start);
 
             // signal main that it can start working again
-            pthread_cond_signal(progInt->threads->mainCond);
+            notifierNotify(&(progInt->threads->mainNotifier));
         }
-        // increase counter of messages no matter the response/reply
-        progInt->comDetails->msgCounter = msgID + 1;
     }
 }
 
@@ -338,12 +377,12 @@ void handleReplyUDP( ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks*
  * @param pBlocks ProtocolBlocks that holds dissasembled data from message
  * @param sendingQueue Pointer to the MessageQueue that will be sended by sender
  * @param serverResponse Buffer that holds server response
- * @param confirmedMsgs Pointer to MessageQueue that holds confirmed messsages
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
  * @param receiverSendMsgs Buffer for sending confirm messages
  * @param noerr Boolean value whenever dissasembling ended sucessful or not
  */
 void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlocks, MessageQueue* sendingQueue,
-    Buffer* serverResponse, MessageQueue* confirmedMsgs, Buffer* receiverSendMsgs)
+    Buffer* serverResponse, MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs)
 {
     bool repetitiveMsg = false;
 
@@ -351,24 +390,16 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
     // Filter out resend messages
     // ------------------------------------------------------------------------
     UDP_VARIANT
-        queueLock(confirmedMsgs);
-        queueLock(sendingQueue);
-
-        Message incomingMessage;
-        incomingMessage.buffer = serverResponse;
-        incomingMessage.type = pBlocks->type;
-
-        // if message id queue contains received message add it to it and prerform action
-        if(!queueContainsMessageId(confirmedMsgs, &incomingMessage))
+        // confirms are never resended by server, their ID refers to our message
+        if(uchar2msgType(pBlocks->type) != msg_CONF)
         {
-            queueAddMessageOnlyID(confirmedMsgs, serverResponse, pBlocks->type);
-        }
-        else // message was already received once, do nothing
-        {
-            repetitiveMsg = true;
+            // server gives up resending after its last retry times out
+            uint32_t horizon = (uint32_t) progInt->netConfig->udpTimeout * 
+                (progInt->netConfig->udpMaxRetries + 1) + MESSAGE_ID_SET_MARGIN;
+
+            // message was already received once, do nothing
+            repetitiveMsg = !messageIdSetInsert(confirmedMsgs, pBlocks->type, msgID, horizon);
         }
-        queueUnlock(sendingQueue);
-        queueUnlock(confirmedMsgs);
     END_VARIANTS
 
     // ------------------------------------------------------------------------
@@ -391,14 +422,12 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
                 // if it is repetitive message send confirm and do nothing
                 if(repetitiveMsg)
                 {
-                    queueLock(sendingQueue);
                     sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
-                    queueUnlock(sendingQueue);
                     debugPrint(stdout, "Repetetive reply received\n");
                     return;
                 }
 
-                handleReplyUDP(progInt, msgID, pBlocks, sendingQueue, serverResponse, receiverSendMsgs);
+                handleReplyUDP(progInt, pBlocks, sendingQueue, serverResponse, receiverSendMsgs);
             TCP_VARIANT
                 switch (getProgramState(progInt))
                 {
@@ -408,13 +437,15 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
                     // if result is ok, print success to STDERR and change state to OPEN
                     if(pBlocks->msg_reply_result_bool == true)
                     {
-                        safePrintStderr("Success: %s\n", pBlocks->msg_reply_MsgContents.start);
+                        safePrintStderr("Success: %.*s\n", (int) pBlocks->msg_reply_MsgContents.len, 
+                            pBlocks->msg_reply_MsgContents.start);
                         setProgramState(progInt, fsm_OPEN);
                     }
                     else
                     {
                         // if result is not ok, print failure to STDERR and change state
-                        safePrintStderr("Failure: %s\n", pBlocks->msg_reply_MsgContents.start);
+                        safePrintStderr("Failure: %.*s\n", (int) pBlocks->msg_reply_MsgContents.len, 
+                            pBlocks->msg_reply_MsgContents.start);
                         if(getProgramState(progInt) == fsm_JOIN_ATEMPT)
                         {
                             setProgramState(progInt, fsm_OPEN);
@@ -430,17 +461,17 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
                     break;
                 }
 
-                // signal main that it can start working again
-                pthread_cond_signal(progInt->threads->mainCond);
+                // signal main that it can start working again and sender 
+                // that messages held until reply can be sended
+                notifierNotify(&(progInt->threads->mainNotifier));
+                notifierNotify(&(progInt->threads->senderNotifier));
             END_VARIANTS
            
             break;
         // --------------------------------------------------------------------
         case msg_MSG: // BYE was received
             UDP_VARIANT
-                queueLock(sendingQueue);
                 sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
-                queueUnlock(sendingQueue);
                 
                 // if it is repetitive message send confirm and do nothing
                 if(repetitiveMsg)
@@ -450,8 +481,7 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
                 }
                 
                 // ping / signal sender
-                pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
-                pthread_cond_signal(progInt->threads->rec2SenderCond);
+                notifierNotify(&(progInt->threads->senderNotifier));
             END_VARIANTS
 
 
@@ -461,15 +491,13 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
         case msg_BYE: // BYE was received
             UDP_VARIANT
                 // send confirm message
-                queueLock(sendingQueue);
                 sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
-                queueUnlock(sendingQueue);
             END_VARIANTS
 
             // set staye to END
             setProgramState(progInt, fsm_END);
             // signal main to stop waiting
-            pthread_cond_signal(progInt->threads->mainCond);
+            notifierNotify(&(progInt->threads->mainNotifier));
             break;
         // --------------------------------------------------------------------
         case msg_ERR:
@@ -477,26 +505,27 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
 
             // delete all messages
             queuePopAllMessages(sendingQueue);
+            queueUnlock(sendingQueue);
+
             UDP_VARIANT
                 // send confirm message
                 sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
             END_VARIANTS
 
-            queueUnlock(sendingQueue);
+            // set state to ERR before BYE is queued, sender ends program 
+            // only if BYE was sended in this state
+            setProgramState(progInt, fsm_ERR);
 
             // send bye to the server
             sendBye(progInt);
             // singal other threads to wake up if suspended
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
-            pthread_cond_signal(progInt->threads->rec2SenderCond);
+            notifierNotify(&(progInt->threads->senderNotifier));
 
-            // set state to ERR
-            setProgramState(progInt, fsm_ERR);
             printIncomingMessage(progInt, pBlocks);
 
             // signal main to awake
             debugPrint(stdout, "2\n");
-            pthread_cond_signal(progInt->threads->mainCond);
+            notifierNotify(&(progInt->threads->mainNotifier));
             break;
         default:
             setProgramState(progInt, fsm_ERR);
@@ -511,20 +540,274 @@ void receiverFSM(ProgramInterface* progInt, uint16_t msgID, ProtocolBlocks* pBlo
             UDP_VARIANT
                 sendConfirm(serverResponse, receiverSendMsgs, progInt, msg_flag_CONFIRM);
             END_VARIANTS
-            sendError(receiverSendMsgs, progInt, "Unknown message format");
+            if(pBlocks->parseError != NULL)
+            {
+                // tell server what exactly was wrong with its message
+                char reason[128];
+                snprintf(reason, sizeof(reason), "Malformed message: %s at byte %zu", 
+                    pBlocks->parseError, pBlocks->parseErrorAt);
+                sendError(receiverSendMsgs, progInt, reason);
+                safePrintStderr("ERR: Received malformed message from server (%s at byte %zu). "
+                    "Ending program\n", pBlocks->parseError, pBlocks->parseErrorAt);
+            }
+            else
+            {
+                sendError(receiverSendMsgs, progInt, "Unknown message format");
+                safePrintStderr("ERR: Received unknown message from server. Ending program\n");
+            }
             sendBye(progInt);
 
             // singal other threads to wake up if suspended
-            pthread_cond_signal(progInt->threads->senderEmptyQueueCond);
-            pthread_cond_signal(progInt->threads->rec2SenderCond);
-        
-            safePrintStderr("ERR: Received unknown message from server. Ending program\n");
+            notifierNotify(&(progInt->threads->senderNotifier));
+
             // signal main to awake
-            pthread_cond_signal(progInt->threads->mainCond);
+            notifierNotify(&(progInt->threads->mainNotifier));
             break;
     }
 }
 
+/**
+ * @brief Disassembles one message received from server and performs 
+ * action based on its type and current state of program
+ * 
+ * @param progInt Global Program Interface
+ * @param message Buffer containing exactly one message
+ * @param pBlocks ProtocolBlocks to which message will be dissasembled
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
+ * @param receiverSendMsgs Buffer for sending confirm messages
+ */
+void processServerMessage(ProgramInterface* progInt, Buffer* message, ProtocolBlocks* pBlocks,
+    MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs)
+{
+    uint16_t msgID = 0; // message id incoming
+
+    UDP_VARIANT
+        disassebleProtocolUDP(message, pBlocks, &msgID);
+    TCP_VARIANT
+        disassebleProtocolTCP(message, pBlocks);
+    END_VARIANTS
+
+    #ifdef DEBUG
+        debugPrint(stdout, "DEBUG: Receiver:");
+        bufferPrint(message, 1);
+        debugPrintSeparator(stdout);
+    #endif
+
+    // if in fsm_AUTH state and incoming msg is not REPLY do nothing
+    if(getProgramState(progInt) == fsm_START && pBlocks->type != msg_REPLY && pBlocks->type != msg_CONF)
+    {
+        debugPrint(stdout, "DEBUG: Receiver thrown away a message because"
+            "program is in START state and message is not CONFIRM or REPLY");
+        return;
+    }
+
+    receiverFSM(progInt, msgID, pBlocks, progInt->threads->sendingQueue, 
+        message, confirmedMsgs, receiverSendMsgs);
+}
+
+/**
+ * @brief Waits without timeout until socket is readable or until receiver 
+ * is woken because program ended
+ * 
+ * @param progInt Global Program Interface
+ * @return true Socket is readable (or closed)
+ * @return false Receiver was woken or waiting was interrupted, state of 
+ * program must be checked
+ */
+bool waitForServer(ProgramInterface* progInt)
+{
+    struct pollfd fds[2];
+    fds[0].fd = progInt->netConfig->openedSocket;
+    fds[0].events = POLLIN;
+    fds[1].fd = progInt->threads->wakeFd; // negative descriptor is ignored
+    fds[1].events = POLLIN;
+
+    if(poll(fds, 2, -1) <= 0) { return false; }
+    if(fds[1].revents != 0) { return false; }
+
+    return fds[0].revents != 0;
+}
+
+/**
+ * @brief Reads bytes from TCP stream into ring buffer and processes all 
+ * complete messages, incomplete message at the end is kept for next read
+ * 
+ * @param progInt Global Program Interface
+ * @param pBlocks ProtocolBlocks to which messages will be dissasembled
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
+ * @param receiverSendMsgs Buffer for sending confirm messages
+ * @return ssize_t Number of received bytes, 0 if server closed connection
+ * and negative value if nothing was received (receiver was woken)
+ */
+ssize_t receiveStreamTCP(ProgramInterface* progInt, ProtocolBlocks* pBlocks,
+    MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs)
+{
+    RingBuffer* stream = &(progInt->cleanUp->serverStream);
+    Buffer* scratch = &(progInt->cleanUp->serverResponse);
+
+    struct iovec iov[2];
+    ssize_t bytesRx;
+    IoRing* ring = progInt->cleanUp->recvRing;
+
+    if(ring != NULL)
+    {
+        // received bytes are in provided buffer, copy them behind 
+        // unprocessed part of stream
+        char* received;
+        bytesRx = ioRingReceive(ring, progInt->netConfig->openedSocket, &received, 
+            NULL, NULL, progInt->threads->wakeFd);
+        if(bytesRx > 0)
+        {
+            int iovCount = ringBufferGetFreeSpace(stream, bytesRx, iov);
+            size_t firstPart = bytesRx < (ssize_t) iov[0].iov_len ? (size_t) bytesRx : iov[0].iov_len;
+            memcpy(iov[0].iov_base, received, firstPart);
+            // rest of message wraps around to the start of ring buffer
+            if(iovCount == 2)
+            {
+                memcpy(iov[1].iov_base, received + firstPart, bytesRx - firstPart);
+            }
+        }
+        ioRingReleaseReceived(ring);
+    }
+    else
+    {
+        if(!waitForServer(progInt)) { return -1; }
+
+        int iovCount = ringBufferGetFreeSpace(stream, TCP_READ_SIZE, iov);
+        bytesRx = readv(progInt->netConfig->openedSocket, iov, iovCount);
+    }
+
+    // receiver was woken or connection was closed
+    if(bytesRx <= 0) { return bytesRx; }
+
+    ringBufferCommit(stream, bytesRx);
+
+    // process every complete message from the stream
+    Buffer view;
+    Buffer* message;
+    while((message = ringBufferGetLine(stream, &view, scratch)) != NULL)
+    {
+        size_t messageLen = message->used;
+        processServerMessage(progInt, message, pBlocks, confirmedMsgs, receiverSendMsgs);
+        ringBufferDiscard(stream, messageLen);
+    }
+
+    // message without ending is too long, process it as it is (it will be 
+    // recognized as invalid message)
+    if(ringBufferLength(stream) > TCP_MAX_MESSAGE_LEN)
+    {
+        message = ringBufferGetAll(stream, scratch);
+        size_t messageLen = message->used;
+        processServerMessage(progInt, message, pBlocks, confirmedMsgs, receiverSendMsgs);
+        ringBufferDiscard(stream, messageLen);
+    }
+
+    return bytesRx;
+}
+
+/**
+ * @brief Receives datagram(s) from server and processes them, all datagrams 
+ * waiting on socket are received at once if batching is used
+ * 
+ * @param progInt Global Program Interface
+ * @param pBlocks ProtocolBlocks to which message will be dissasembled
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
+ * @param receiverSendMsgs Buffer for sending confirm messages
+ * @return ssize_t Number of received bytes, negative value if nothing 
+ * was received (receiver was woken)
+ */
+ssize_t receiveDatagramUDP(ProgramInterface* progInt, ProtocolBlocks* pBlocks,
+    MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs)
+{
+    Buffer* serverResponse = &(progInt->cleanUp->serverResponse);
+    IoRing* ring = progInt->cleanUp->recvRing;
+
+    if(ring != NULL)
+    {
+        // message is processed directly in provided buffer 
+        Buffer received;
+        ssize_t bytesRx = ioRingReceive(ring, progInt->netConfig->openedSocket, 
+            &(received.data), progInt->netConfig->serverAddress, 
+            &(progInt->netConfig->serverAddressSize), progInt->threads->wakeFd);
+        if(bytesRx > 0)
+        {
+            received.used = bytesRx;
+            received.allocated = bytesRx;
+            processServerMessage(progInt, &received, pBlocks, confirmedMsgs, receiverSendMsgs);
+        }
+        ioRingReleaseReceived(ring);
+
+        return bytesRx;
+    }
+
+    if(!waitForServer(progInt)) { return -1; }
+
+    DatagramBatch* batch = progInt->cleanUp->recvBatch;
+    if(batch != NULL)
+    {
+        // receive all waiting datagrams and process them one by one
+        int received = datagramBatchReceive(batch, progInt->netConfig->openedSocket);
+        if(received <= 0) { return -1; }
+
+        ssize_t bytesRx = 0;
+        for(int i = 0; i < received; i++)
+        {
+            Buffer datagram;
+            datagram.data = datagramBatchGetReceived(batch, i, &(datagram.used),
+                progInt->netConfig->serverAddress, &(progInt->netConfig->serverAddressSize));
+            datagram.allocated = datagram.used;
+            if(datagram.used == 0) { continue; }
+
+            bytesRx += datagram.used;
+            processServerMessage(progInt, &datagram, pBlocks, confirmedMsgs, receiverSendMsgs);
+        }
+
+        return bytesRx;
+    }
+
+    ssize_t bytesRx = recvfrom(progInt->netConfig->openedSocket, serverResponse->data,
+                            serverResponse->allocated, 0, 
+                            progInt->netConfig->serverAddress, 
+                            &(progInt->netConfig->serverAddressSize));
+    if(bytesRx <= 0) { return bytesRx; }
+
+    serverResponse->used = bytesRx; //set buffer length (activly used) bytes
+
+    processServerMessage(progInt, serverResponse, pBlocks, confirmedMsgs, receiverSendMsgs);
+
+    return bytesRx;
+}
+
+/**
+ * @brief Ends program after server closed TCP connection, closing is 
+ * expected only after ERR or BYE was exchanged
+ * 
+ * @param progInt Global Program Interface
+ */
+void serverClosedConnection(ProgramInterface* progInt)
+{
+    switch(getProgramState(progInt))
+    {
+    // program is ending, server can close connection right after BYE 
+    // before sender changes state to fsm_END
+    case fsm_EMPTY_Q_BYE:
+    case fsm_ERR:
+    case fsm_ERR_W84_CONF:
+    case fsm_SIGINT_BYE:
+    case fsm_END_W84_CONF:
+        break;
+    default:
+        safePrintStderr("ERR: Server closed connection. Ending program\n");
+        break;
+    }
+
+    setProgramState(progInt, fsm_END);
+
+    // singal other threads to wake up if suspended
+    notifierNotify(&(progInt->threads->senderNotifier));
+    notifierNotify(&(progInt->threads->mainNotifier));
+}
+
 /**
  * @brief Initializes protocol receiving functionality 
  * 
@@ -539,72 +822,39 @@ void* protocolReceiver(void *vargp)
     ProgramInterface* progInt = (ProgramInterface*) vargp;
     ProtocolBlocks pBlocks;
 
-    Buffer* serverResponse = &(progInt->cleanUp->serverResponse);
-    bufferResize(serverResponse, 1500); // set max size messages from server
+    // set max size messages from server
+    bufferResize(&(progInt->cleanUp->serverResponse), MAX_SERVER_MESSAGE_LEN);
+
+    // messages are received with multishot receive if io_uring is available,
+    // otherwise UDP datagrams are received in batches with recvmmsg()
+    progInt->cleanUp->recvRing = ioRingCreate(true);
+    if(progInt->cleanUp->recvRing == NULL && progInt->netConfig->protocol == prot_UDP)
+    {
+        progInt->cleanUp->recvBatch = datagramBatchCreate();
+    }
 
     Buffer* receiverSendMsgs = &(progInt->cleanUp->protocolToSendedByReceiver);
     
-    MessageQueue* confirmedMsgs = progInt->cleanUp->confirmedMessages;
-
-    // Await response
-    int flags = 0;
-    uint16_t msgID; // message id incoming
+    MessageIdSet* confirmedMsgs = progInt->cleanUp->confirmedMessages;
 
     // ------------------------------------------------------------------------
-    // Set up epoll to react to the opened socket
-    // ------------------------------------------------------------------------
-
-    struct timeval tv;
-    tv.tv_usec = 0;
-    tv.tv_sec = 1;
-
-    // set timeout for recvfrom in case that program ended and no 
-    // more messages will be sent 
-    if(setsockopt(progInt->netConfig->openedSocket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv)))
-    {
-        errHandling("setsockopt() failed\n", err_COMMUNICATION);
-    }
-
-    // ------------------------------------------------------------------------
-    // Set up variables for receiving messages
+    // Receive messages until program ends, receiver blocks without timeout 
+    // and is woken through wakeFd by setProgramState()
     // ------------------------------------------------------------------------
     while(getProgramState(progInt) != fsm_END)
     {
-        int bytesRx = recvfrom(progInt->netConfig->openedSocket, serverResponse->data,
-                                serverResponse->allocated, flags, 
-                                progInt->netConfig->serverAddress, 
-                                &(progInt->netConfig->serverAddressSize));
-        // receiver timeout expired
-        if(bytesRx <= 0) {continue;}
-
-        serverResponse->used = bytesRx; //set buffer length (activly used) bytes
-        
         UDP_VARIANT
-            disassebleProtocolUDP(serverResponse, &pBlocks, &msgID);
+            receiveDatagramUDP(progInt, &pBlocks, confirmedMsgs, receiverSendMsgs);
         TCP_VARIANT
-            disassebleProtocolTCP(serverResponse, &pBlocks);
+            // server closed connection, nothing more can be received or sended
+            if(receiveStreamTCP(progInt, &pBlocks, confirmedMsgs, receiverSendMsgs) == 0)
+            {
+                serverClosedConnection(progInt);
+            }
         END_VARIANTS
-
-        #ifdef DEBUG
-            debugPrint(stdout, "DEBUG: Receiver:");
-            bufferPrint(serverResponse, 1);
-            debugPrintSeparator(stdout);
-        #endif
-
-        // if in fsm_AUTH state and incoming msg is not REPLY do nothing
-        if(getProgramState(progInt) == fsm_START && pBlocks.type != msg_REPLY && pBlocks.type != msg_CONF)
-        {
-            debugPrint(stdout, "DEBUG: Receiver thrown away a message because"
-                "program is in START state and message is not CONFIRM or REPLY");
-            continue;
-        }
-
-
-        receiverFSM(progInt, msgID, &pBlocks, progInt->threads->sendingQueue, 
-            serverResponse, confirmedMsgs, receiverSendMsgs);
     }
 
     debugPrint(stdout, "DEBUG: Receiver ended\n");
 
     return NULL;
-}
\ No newline at end of file
+}
@@ -17,8 +17,31 @@
 
 #include "libs/ipk24protocol.h"
 
+// minimal number of bytes that can be read from TCP stream at once
+#define TCP_READ_SIZE (16 * 1024)
+// maximal length of message that is not ended with "\r\n"
+#define TCP_MAX_MESSAGE_LEN 1500
+// maximal length of message received from server
+#define MAX_SERVER_MESSAGE_LEN 1500
+
+/**
+ * @brief Adds message to the sending queue, caller must not hold lock of 
+ * sending queue. If submit ring of queue is full, sender is woken up and 
+ * message is submitted again until there is room or until program ends.
+ * 
+ * @param progInt Pointer to Program Interface
+ * @param buffer Contents of message
+ * @param flags Flags to be added to the message
+ * @param msgType Type of message
+ * @param control Message is added to the control lane and sended before 
+ * other messages in queue
+ */
+void submitMessage(ProgramInterface* progInt, Buffer* buffer, msg_flags flags, 
+    unsigned char msgType, bool control);
+
 /**
- * @brief Create err protocol
+ * @brief Create err protocol and adds it to the sending queue, caller must 
+ * not hold lock of sending queue
  * 
  * @param receiverSendMsgs Buffer to which should message be stored
  * @param progInt Pointer to Program Interface
@@ -27,7 +50,8 @@
 void sendError(Buffer* receiverSendMsgs, ProgramInterface* progInt, const char* message);
 
 /**
- * @brief Create confirm protocol
+ * @brief Create confirm protocol and adds it to the sending queue, caller 
+ * must not hold lock of sending queue
  * 
  * @param serverResponse Buffer from which will referenceID be taken
  * @param receiverSendMsgs Buffer to which should message be stored
@@ -37,12 +61,49 @@ void sendError(Buffer* receiverSendMsgs, ProgramInterface* progInt, const char*
 void sendConfirm(Buffer* serverResponse, Buffer* receiverSendMsgs, ProgramInterface* progInt, msg_flags flags);
 
 /**
- * @brief Creates BYE message and sends it to server
+ * @brief Creates BYE message and sends it to server, caller must not hold 
+ * lock of sending queue
  * 
  * @param progInt Pointer to program interface
  */
 void sendBye(ProgramInterface* progInt);
 
+/**
+ * @brief Reads bytes from TCP stream into ring buffer and processes all 
+ * complete messages, incomplete message at the end is kept for next read
+ * 
+ * @param progInt Global Program Interface
+ * @param pBlocks ProtocolBlocks to which messages will be dissasembled
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
+ * @param receiverSendMsgs Buffer for sending confirm messages
+ * @return ssize_t Number of received bytes, 0 if server closed connection
+ * and negative value if nothing was received
+ */
+ssize_t receiveStreamTCP(ProgramInterface* progInt, ProtocolBlocks* pBlocks,
+    MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs);
+
+/**
+ * @brief Receives datagram(s) from server and processes them, all datagrams 
+ * waiting on socket are received at once if batching is used
+ * 
+ * @param progInt Global Program Interface
+ * @param pBlocks ProtocolBlocks to which message will be dissasembled
+ * @param confirmedMsgs Pointer to MessageIdSet that holds IDs of received messsages
+ * @param receiverSendMsgs Buffer for sending confirm messages
+ * @return ssize_t Number of received bytes, negative value if nothing 
+ * was received
+ */
+ssize_t receiveDatagramUDP(ProgramInterface* progInt, ProtocolBlocks* pBlocks,
+    MessageIdSet* confirmedMsgs, Buffer* receiverSendMsgs);
+
+/**
+ * @brief Ends program after server closed TCP connection, closing is 
+ * expected only after ERR or BYE was exchanged
+ * 
+ * @param progInt Global Program Interface
+ */
+void serverClosedConnection(ProgramInterface* progInt);
+
 /**
  * @brief Initializes protocol receiving functionality 
  * 
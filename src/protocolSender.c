@@ -13,30 +13,242 @@
 #include "protocolSender.h"
 #include "sys/time.h"
 
-#define TIMEOUT_CALCULATION(millis)                                             \
+#define TIMEOUT_CALCULATION(micros)                                             \
     gettimeofday(&timeNow, NULL);                                               \
-    timeToWait.tv_sec = timeNow.tv_sec + millis / 1000;                         \
-    timeToWait.tv_nsec = timeNow.tv_usec * 1000 + 1000 * 1000 * (millis % 1000);\
+    timeToWait.tv_sec = timeNow.tv_sec + micros / (1000 * 1000);                \
+    timeToWait.tv_nsec = timeNow.tv_usec * 1000 + 1000 * (micros % (1000 * 1000));\
     timeToWait.tv_sec += timeToWait.tv_nsec / (1000 * 1000 * 1000);             \
     timeToWait.tv_nsec %= (1000 * 1000 * 1000);
 
+/**
+ * @brief Returns true if timeout stored in timespec has already expired
+ */
+#define TIMEOUT_EXPIRED(timeout, now)                                           \
+    ((timeout).tv_sec < (now).tv_sec ||                                         \
+    ((timeout).tv_sec == (now).tv_sec && (timeout).tv_nsec <= (now).tv_usec * 1000))
+
+/**
+ * @brief Returns true if message is never resended and doesn't wait for
+ * confirmation (confirms of the received messages)
+ * 
+ * @param msg Pointer to the message
+ */
+bool isControlMessage(Message* msg)
+{
+    switch (msg->msgFlags)
+    {
+    case msg_flag_DO_NOT_RESEND: /*general do not resend*/
+    case msg_flag_CONFIRM: /*confirm*/
+    case msg_flag_NOK_REPLY: /*confirm to bad reply*/
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Returns true if message changes state of the program (AUTH, JOIN, 
+ * ERR, BYE). These messages are sended only after all messages in sending 
+ * window were confirmed and no other message is sended until they are 
+ * confirmed as well.
+ * 
+ * @param msg Pointer to the message
+ */
+bool isBarrierMessage(Message* msg)
+{
+    if(msg->msgFlags == msg_flag_AUTH || msg->msgFlags == msg_flag_ERR || 
+        msg->msgFlags == msg_flag_BYE)
+    {
+        return true;
+    }
+
+    switch (uchar2msgType(msg->type))
+    {
+    case msg_AUTH:
+    case msg_JOIN:
+    case msg_ERR:
+    case msg_BYE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Sends bytes of message to the server, bytes are copied into batch
+ * if messages are sended in batches
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ * @param data Contents of message
+ * @param len Length of message
+ */
+void sendBytes(ProgramInterface* progInt, const char* data, size_t len)
+{
+    // message will be sended together with other messages by 
+    // flushSendedMessages() 
+    if(progInt->cleanUp->sendRing != NULL && 
+        ioRingPrepareSend(progInt->cleanUp->sendRing, progInt->netConfig->openedSocket,
+            data, len, progInt->netConfig->serverAddress,
+            progInt->netConfig->serverAddressSize))
+    {
+        return;
+    }
+    if(progInt->cleanUp->sendBatch != NULL && 
+        datagramBatchPrepareSend(progInt->cleanUp->sendBatch, progInt->netConfig->openedSocket,
+            data, len, progInt->netConfig->serverAddress,
+            progInt->netConfig->serverAddressSize))
+    {
+        return;
+    }
+
+    int bytesTx; // number of sended bytes
+    // send buffer to the server 
+    bytesTx = sendto(progInt->netConfig->openedSocket, data, len, 0, 
+                    progInt->netConfig->serverAddress, 
+                    progInt->netConfig->serverAddressSize);
+
+    if(bytesTx < 0)
+    {
+        errHandling("Sending bytes was not successful", err_COMMUNICATION);
+    }
+}
+
+/**
+ * @brief Sends message to the server. If other threads submit messages 
+ * through submit ring, message is only copied to the outbox and it is 
+ * sended by flushSendedMessages() after sending queue is unlocked.
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ * @param msg Message to be sended
+ */
+void sendMessage(ProgramInterface* progInt, Message* msg)
+{
+    #ifdef DEBUG
+        debugPrint(stdout, "DEBUG: Sender (queue len: %li): ", progInt->threads->sendingQueue->len);
+        bufferPrint(msg->buffer, 3);
+    #endif
+
+    if(progInt->threads->sendingQueue->submitRing == NULL)
+    {
+        sendBytes(progInt, msg->buffer->data, msg->buffer->used);
+        return;
+    }
+
+    // outbox holds length of every message followed by its contents
+    Buffer* outbox = &(progInt->cleanUp->senderOutbox);
+    size_t len = msg->buffer->used;
+    size_t needed = outbox->used + sizeof(size_t) + len;
+    if(needed > outbox->allocated)
+    {
+        bufferResize(outbox, (needed > 2 * outbox->allocated) ? needed : 2 * outbox->allocated);
+    }
+
+    memcpy(&(outbox->data[outbox->used]), &len, sizeof(size_t));
+    memcpy(&(outbox->data[outbox->used + sizeof(size_t)]), msg->buffer->data, len);
+    outbox->used = needed;
+}
+
+/**
+ * @brief Sends all messages that were prepared by sendMessage() with one 
+ * system call, does nothing if messages are not sended in batches. Messages
+ * copied to the outbox are sended as well, sender calls it after sending 
+ * queue is unlocked.
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ */
+void flushSendedMessages(ProgramInterface* progInt)
+{
+    // messages copied to the outbox by sendMessage()
+    Buffer* outbox = &(progInt->cleanUp->senderOutbox);
+    size_t position = 0;
+    while(position < outbox->used)
+    {
+        size_t len;
+        memcpy(&len, &(outbox->data[position]), sizeof(size_t));
+        sendBytes(progInt, &(outbox->data[position + sizeof(size_t)]), len);
+        position += sizeof(size_t) + len;
+    }
+    outbox->used = 0;
+
+    int res = 0;
+    if(progInt->cleanUp->sendRing != NULL)
+    {
+        res = ioRingFlushSends(progInt->cleanUp->sendRing);
+    }
+    else if(progInt->cleanUp->sendBatch != NULL)
+    {
+        res = datagramBatchFlushSends(progInt->cleanUp->sendBatch, 
+            progInt->netConfig->openedSocket);
+    }
+
+    if(res != 0)
+    {
+        errHandling("Sending bytes was not successful", err_COMMUNICATION);
+    }
+}
+
+/**
+ * @brief Sets time at which message will be resended if it is not confirmed,
+ * timeout is estimated from round trip time and bounded by udpTimeout, 
+ * every retransmission waits for randomly longer time (backoff)
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ * @param msg Message that was sended
+ */
+void setRetransmitTime(ProgramInterface* progInt, Message* msg)
+{
+    struct timespec timeToWait; // time variable for timeout calculation
+    struct timeval timeNow; // time variable for timeout calculation
+
+    double rto = rttEstimatorTimeout(&(progInt->comDetails->rtt), 
+        progInt->netConfig->udpTimeout);
+    double delay = retrySchedulerDelay(&(progInt->comDetails->retry), rto, 
+        progInt->netConfig->udpBackoffCap, msg->sendCount - 1);
+    long micros = (long)(delay * 1000);
+
+    TIMEOUT_CALCULATION(micros);
+    msg->retransmitAt = timeToWait;
+}
+
+/**
+ * @brief Returns true if message cannot be resended anymore, it was resended
+ * maxRetries times and time in which maxRetries retransmissions with maximal
+ * timeout (udpTimeout) would be sended has passed. Retransmission timeout
+ * is usually much shorter than udpTimeout, short stall of server would 
+ * exhaust retries otherwise.
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ * @param msg Message which confirmation timed out
+ * @param maxRetries Maximal number of retransmissions of message
+ * @return true Message timed out
+ */
+bool retriesExhausted(ProgramInterface* progInt, Message* msg, size_t maxRetries)
+{
+    if(msg->sendCount <= maxRetries) { return false; }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (now.tv_sec - msg->sentAt.tv_sec) * 1000.0 + 
+        (now.tv_nsec - msg->sentAt.tv_nsec) / (1000.0 * 1000.0);
+
+    return elapsed >= (double)progInt->netConfig->udpTimeout * (maxRetries + 1);
+}
+
 /**
  * @brief Filters messages to by send by currecnt state of program and by
  * MessageType, also updates current state of program  
  * 
  * @param progInt Pointer to the ProgramInterface 
+ * @param msgToBeSend Message that should be sended
+ * @return true Message can be sended in current state
+ * @return false Message cannot be sended now, sender must wait for receiver
+ * to change state of the program
  */
-void logicFSM(ProgramInterface* progInt)
+bool logicFSM(ProgramInterface* progInt, Message* msgToBeSend)
 {
-    MessageQueue* sendingQueue = progInt->threads->sendingQueue;
-
-    // get msg again in case someone changed first it ... this is primary 
-    // for receiver importing priority messages like CONFIRM
-    Message* msgToBeSend = queueGetMessage(sendingQueue); 
-
-    msg_t msgType = queueGetMessageMsgType(sendingQueue);
+    msg_t msgType = uchar2msgType(msgToBeSend->type);
     
-    msg_flags flags = queueGetMessageFlags(sendingQueue);
+    msg_flags flags = msgToBeSend->msgFlags;
 
     switch (getProgramState(progInt))
     {
@@ -53,19 +265,27 @@ void logicFSM(ProgramInterface* progInt)
             setProgramState(progInt, fsm_AUTH_SENDED);
         }
 
-        // if program is not in open state and message to be send is not auth 
-        if(msgType != msg_AUTH && flags != msg_flag_NOK_REPLY)
+        // messages queued by pipelined input behind AUTH that failed
+        if(getProgramState(progInt) == fsm_START && (msgType == msg_MSG || msgType == msg_JOIN))
+        {
+            safePrintStderr("ERR: You are not connected to server! "
+                "This message will be ignored.\n");
+            // mark message as rejected, it will be deleted from queue
+            msgToBeSend->msgFlags = msg_flag_REJECTED;
+            notifierNotify(&(progInt->threads->mainNotifier));
+            return false;
+        }
+
+        // if program is not in open state and message to be send is not auth,
+        // received messages are confirmed in any state
+        if(msgType != msg_AUTH && !isControlMessage(msgToBeSend))
         {
             #ifdef DEBUG
                 debugPrint(stdout, "DEBUG: Message that is not auth blocked because of FSM state\n");
                 bufferPrint(msgToBeSend->buffer, 9);
             #endif
-            queueUnlock(sendingQueue);
             // wait for receiver to signal that authentication was confirmed
-            pthread_cond_wait(progInt->threads->rec2SenderCond, 
-                progInt->threads->rec2SenderMutex);
-
-            queueLock(sendingQueue);
+            return false;
         }
         // if message is AUTH and was already confirmed, ...
         // wait to prevent repetitive auth sending, and if message wasnt rejected
@@ -75,13 +295,8 @@ void logicFSM(ProgramInterface* progInt)
                 debugPrint(stdout, "DEBUG: AUTH message blocked because of FSM state (state: %i)\n", getProgramState(progInt));
                 bufferPrint(msgToBeSend->buffer, 7);
             #endif
-            queueUnlock(sendingQueue);
             // message was confirmed, wait for receiver to ping me   
-            pthread_cond_wait(progInt->threads->rec2SenderCond, 
-                progInt->threads->rec2SenderMutex);
-            queueLock(sendingQueue);
-            // call filter again
-            logicFSM(progInt);
+            return false;
         }
         break;
     // ------------------------------------------------------------------------
@@ -92,7 +307,20 @@ void logicFSM(ProgramInterface* progInt)
             // change state to open
             setProgramState(progInt, fsm_OPEN);
             // singal main to start processing another input
-            pthread_cond_signal(progInt->threads->mainCond);
+            notifierNotify(&(progInt->threads->mainNotifier));
+        }
+        // messages queued by pipelined input wait for reply to be confirmed
+        else if(msgType == msg_MSG || msgType == msg_JOIN)
+        {
+            return false;
+        }
+        break;
+    // ------------------------------------------------------------------------
+    case fsm_JOIN_ATEMPT:
+        // messages queued by pipelined input wait for reply to JOIN
+        if(msgType == msg_MSG || msgType == msg_JOIN)
+        {
+            return false;
         }
         break;
     // ------------------------------------------------------------------------
@@ -101,8 +329,10 @@ void logicFSM(ProgramInterface* progInt)
         {
             case msg_AUTH:
                 safePrintStderr("ERR: You are already autheticated, this message will be ignored.");
-                queuePopMessage(sendingQueue);
-                break;
+                // mark message as rejected, it will be deleted from queue
+                msgToBeSend->msgFlags = msg_flag_REJECTED;
+                notifierNotify(&(progInt->threads->mainNotifier));
+                return false;
             case msg_JOIN:
                 setProgramState(progInt, fsm_JOIN_ATEMPT);
                 break;
@@ -122,7 +352,7 @@ void logicFSM(ProgramInterface* progInt)
                 TCP_VARIANT
                     // end set state to end
                     setProgramState(progInt, fsm_END);
-                    pthread_cond_signal(progInt->threads->mainCond);
+                    notifierNotify(&(progInt->threads->mainNotifier));
                 END_VARIANTS
             }
             else if(flags == msg_flag_ERR)
@@ -131,7 +361,7 @@ void logicFSM(ProgramInterface* progInt)
                     setProgramState(progInt, fsm_ERR_W84_CONF);
                 END_VARIANTS
             }
-            else if(flags == msg_flag_CONFIRM) {} // if sended is confirm
+            else if(isControlMessage(msgToBeSend)) {} // if sended is confirm
             else
             {
                 errHandling("ERR: Sender send message that is not "
@@ -140,87 +370,266 @@ void logicFSM(ProgramInterface* progInt)
     default:
         break;
     }
+
+    return true;
 }
 
 /**
  * @brief Filters out messages from provided queue that were sent
  *  more than specified times in NetworkConfiguration or that are
- * already confirmed
+ * already confirmed. Messages in sending window which confirmation timed 
+ * out are resended.
  * 
  * @param sendingQueue Pointer to queue from which should messages be filtered 
  * @param progInt Pointer to ProgramInterface
+ * @return true Program state was changed to END, sender loop must be reset
  */
 bool filterResentMessages(MessageQueue* sendingQueue, ProgramInterface* progInt)
 {
-    bool resetLoop = false;
-    Message* msgToBeSend = queueGetMessage(sendingQueue);
-    while(msgToBeSend != NULL)
+    struct timeval timeNow;
+    gettimeofday(&timeNow, NULL);
+
+    Message* msg = queueGetMessage(sendingQueue);
+    while(msg != NULL)
     {
-        // if message was send more than maximum udp retries
-        if( queueGetSendedCounter(sendingQueue) > progInt->netConfig->udpMaxRetries )
+        // store next message, current one might be deleted
+        Message* behindMsg = msg->behindMe;
+
+        if(msg->msgFlags == msg_flag_REJECTED)
         {
-            // if timedout message is ERR pop it and try to send BYE atleast
-            if(getProgramState(progInt) == fsm_ERR_W84_CONF) { }
-            
-            // if timedout message is BYE set program to END and exit, 
-            // confirmation wont come ...
-            else if(getProgramState(progInt) == fsm_END_W84_CONF) 
-            { 
-                setProgramState(progInt, fsm_END);
-                // signal main to end
-                pthread_cond_signal(progInt->threads->mainCond);
-                resetLoop = true; // reset loop to not get stuck
+            #ifdef DEBUG
+                debugPrint(stdout, "Message got rejected, deleting it\n");
+                bufferPrint(msg->buffer, 1);
+            #endif
+            queueRemoveMessage(sendingQueue, msg);
+        }
+        // do not throw away auth messages even if they are confirmed
+        else if(msg->msgFlags == msg_flag_AUTH && msg->confirmed) {}
+        // delete confirmed message
+        else if(msg->confirmed)
+        {
+            queueRemoveMessage(sendingQueue, msg);
+        }
+        // message is in sending window and its confirmation did not arrive in time
+        else if(msg->sendCount > 0 && TIMEOUT_EXPIRED(msg->retransmitAt, timeNow))
+        {
+            // every other resolved address of server gets one more attempt 
+            // of AUTH, the first address that confirms it is used
+            size_t maxRetries = progInt->netConfig->udpMaxRetries;
+            if(msg->msgFlags == msg_flag_AUTH)
+            {
+                maxRetries += progInt->netConfig->serverAddressesCount - 1;
+            }
+
+            // if message was send more than maximum udp retries
+            if(retriesExhausted(progInt, msg, maxRetries))
+            {
+                // if timedout message is ERR pop it and try to send BYE atleast
+                if(getProgramState(progInt) == fsm_ERR_W84_CONF)
+                {
+                    queueRemoveMessage(sendingQueue, msg);
+                }
+                // if timedout message is BYE set program to END and exit, 
+                // confirmation wont come ...
+                else if(getProgramState(progInt) == fsm_END_W84_CONF) 
+                { 
+                    setProgramState(progInt, fsm_END);
+                    // signal main to end
+                    notifierNotify(&(progInt->threads->mainNotifier));
+                    return true; // reset loop to not get stuck
+                }
+                else
+                {
+                    // print error message
+                    safePrintStderr("ERR: Request timed out.\n");
+                    // clear message queue
+                    queuePopAllMessages(sendingQueue);
+                    // set program into error state
+                    setProgramState(progInt, fsm_ERR);
+
+                    queueUnlock(sendingQueue);
+                    // add error message to queue
+                    sendError(&(progInt->cleanUp->protocolToSendedBySender), 
+                        progInt, "Request timed out");
+                    // add bye message to queue
+                    sendBye(progInt);
+
+                    // signal main to end
+                    notifierNotify(&(progInt->threads->mainNotifier));
+
+                    queueLock(sendingQueue);
+                    return false;
+                }
             }
             else
             {
-                // print error message
-                safePrintStderr("ERR: Request timed out.\n");
-                // clear message queue
-                queuePopAllMessages(sendingQueue);
-                // set program into error state
-                setProgramState(progInt, fsm_ERR);
+                // AUTH was not confirmed, server might not be reachable 
+                // through current address
+                if(msg->msgFlags == msg_flag_AUTH)
+                {
+                    nextServerAddress(progInt->netConfig);
+                }
+
+                // try send it again, message id stays the same
+                sendMessage(progInt, msg);
+                // counter must not overflow while message waits for time 
+                // limit of its retries
+                if(msg->sendCount < UINT8_MAX) { msg->sendCount += 1; }
+                progInt->stats->retransmissions += 1;
+                setRetransmitTime(progInt, msg);
+            }
+        }
 
-                queueUnlock(sendingQueue);
-                // add error message to queue
-                sendError(&(progInt->cleanUp->protocolToSendedBySender), 
-                    progInt, "Request timed out");
-                // add bye message to queue
-                sendBye(progInt);
+        // get next message
+        msg = behindMsg;
+    }
 
-                // signal main to end
-                pthread_cond_signal(progInt->threads->mainCond);
+    return false;
+}
+
+/**
+ * @brief Sends all messages from control lane of queue, these are never 
+ * resended and never wait for sending window or for retransmissions. 
+ * Sender calls it before anything else is sended.
+ * 
+ * @param sendingQueue Pointer to queue from which messages will be sended
+ * @param progInt Pointer to ProgramInterface
+ * @return size_t Number of sended messages
+ */
+size_t sendControlMessages(MessageQueue* sendingQueue, ProgramInterface* progInt)
+{
+    size_t sended = 0;
 
-                queueLock(sendingQueue);
+    Message* msg;
+    while((msg = queueGetControlMessage(sendingQueue)) != NULL)
+    {
+        // confirms are never blocked by state, only state is updated
+        logicFSM(progInt, msg);
+        sendMessage(progInt, msg);
+        queuePopControlMessage(sendingQueue);
+        sended += 1;
+    }
+
+    return sended;
+}
+
+/**
+ * @brief Sends messages from data lane of queue that were not sended yet, 
+ * until sending window is full or until message that cannot be sended in 
+ * current state of program is found.
+ * 
+ * @param sendingQueue Pointer to queue from which messages will be sended
+ * @param progInt Pointer to ProgramInterface
+ * @return size_t Number of sended messages
+ */
+size_t fillSendingWindow(MessageQueue* sendingQueue, ProgramInterface* progInt)
+{
+    size_t sended = 0;
+
+    UDP_VARIANT
+    
+    TCP_VARIANT
+        // in tcp variant messages are sended in order and always popped
+        Message* msg;
+        while((msg = queueGetMessage(sendingQueue)) != NULL)
+        {
+            if(!logicFSM(progInt, msg))
+            {
+                if(msg->msgFlags == msg_flag_REJECTED) { queuePopMessage(sendingQueue); continue; }
                 break;
             }
+
+            progInt->comDetails->msgCounter += 1;
+            sendMessage(progInt, msg);
+            sended += 1;
+
+            // ping main to work again, there is room for next message
+            notifierNotify(&(progInt->threads->mainNotifier));
+            queuePopMessage(sendingQueue);
         }
-        else if(msgToBeSend->msgFlags == msg_flag_REJECTED)
+        return sended;
+    END_VARIANTS
+
+    size_t inFlight = 0; // number of unconfirmed messages in window
+    bool barrierInFlight = false; // state changing message was not confirmed 
+    bool dataBlocked = false; // no other message than confirm can be sended
+
+    Message* msg = queueGetMessage(sendingQueue);
+    while(msg != NULL)
+    {
+        // store next message, current one might be deleted
+        Message* behindMsg = msg->behindMe;
+
+        // message is already in sending window
+        if(msg->sendCount > 0)
         {
-            #ifdef DEBUG
-                debugPrint(stdout, "Message got rejected, deleting it\n");
-                bufferPrint(msgToBeSend->buffer, 1);
-            #endif
+            if(!msg->confirmed) { inFlight += 1; }
+            if(isBarrierMessage(msg)) { barrierInFlight = true; }
         }
-        // do not throw away auth messages even if they are confirmed
-        else if(msgToBeSend->msgFlags == msg_flag_AUTH)
+        else if(!dataBlocked)
         {
-            break;
+            // state changing messages must wait for all messages before them,
+            // other messages wait for free room in window
+            if( barrierInFlight || inFlight >= progInt->netConfig->udpWindow || 
+                (isBarrierMessage(msg) && inFlight > 0) )
+            {
+                dataBlocked = true;
+            }
+            else if(!logicFSM(progInt, msg))
+            {
+                // rejected messages are skipped and deleted later
+                if(msg->msgFlags != msg_flag_REJECTED) { dataBlocked = true; }
+            }
+            else
+            {
+                // set correct message id right before sending it
+                queueAssignMessageID(msg, progInt);
+                sendMessage(progInt, msg);
+                msg->sendCount = 1;
+                progInt->stats->transmissions += 1;
+                clock_gettime(CLOCK_MONOTONIC, &(msg->sentAt));
+                setRetransmitTime(progInt, msg);
+
+                sended += 1;
+                inFlight += 1;
+                if(isBarrierMessage(msg)) { barrierInFlight = true; }
+            }
         }
-        // if message wasnt already confirmed
-        else if (msgToBeSend->confirmed == false)
+
+        msg = behindMsg;
+    }
+
+    return sended;
+}
+
+/**
+ * @brief Finds message in sending window that should be resended first
+ * 
+ * @param sendingQueue Pointer to the queue
+ * @param nearest Output time of the nearest retransmission 
+ * @return true Some message is waiting for confirmation
+ * @return false No message is waiting for confirmation
+ */
+bool getNearestRetransmit(MessageQueue* sendingQueue, struct timespec* nearest)
+{
+    bool found = false;
+
+    Message* msg = queueGetMessage(sendingQueue);
+    while(msg != NULL)
+    {
+        if(msg->sendCount > 0 && !msg->confirmed)
         {
-            // try send it again
-            break;
+            if(!found || TIMESPEC_EARLIER(msg->retransmitAt, *nearest))
+            {
+                *nearest = msg->retransmitAt;
+            }
+            found = true;
         }
 
-        // delete confirmed message
-        queuePopMessage(sendingQueue);
-
-        // get new one message
-        msgToBeSend = queueGetMessage(sendingQueue);
+        msg = msg->behindMe;
     }
 
-    return resetLoop;
+    return found;
 }
 
 /**
@@ -233,24 +642,40 @@ void* protocolSender(void* vargp)
 {
     ProgramInterface* progInt = (ProgramInterface*) vargp;
     MessageQueue* sendingQueue = progInt->threads->sendingQueue;
-    int flags = 0;
     
-    struct timespec timeToWait; // time variable for timeout calculation
-    struct timeval timeNow; // time variable for timeout calculation
+    Notifier* senderNotifier = &(progInt->threads->senderNotifier);
+    struct timespec timeToWait; // time of the nearest retransmission
+
+    // sender is the only thread that moves messages from submit ring
+    SubmitRing* submitRing = sendingQueue->submitRing;
+    if(submitRing != NULL) { submitRingSetConsumer(submitRing); }
 
     while( getProgramState(progInt) != fsm_END) 
     {
+        // changes made after this point wake sender up even if they came 
+        // before sender started waiting
+        uint64_t seen = notifierSequence(senderNotifier);
+
+        queueLock(sendingQueue);
+
+        // move messages submitted by other threads to the queue, main might
+        // wait for room in ring or in sending window
+        if(submitRing != NULL && submitRingDrain(submitRing, sendingQueue) > 0)
+        {
+            notifierNotify(&(progInt->threads->mainNotifier));
+        }
+
+        // confirms of received messages go first, before any resending
+        size_t sended = sendControlMessages(sendingQueue, progInt);
+
         // --------------------------------------------------------------------
         // Filter out confirmed messages or messages with too many resends
         // --------------------------------------------------------------------
         UDP_VARIANT
-            queueLock(sendingQueue);
-
             // if BYE was not confirmed and popped, it changed program state 
             // to END, to prevent being stuck resetLopp is set
             bool resetLoop = filterResentMessages(sendingQueue, progInt);
-            if(resetLoop) { continue; }
-        TCP_VARIANT
+            if(resetLoop) { queueUnlock(sendingQueue); flushSendedMessages(progInt); continue; }
         END_VARIANTS
 
         // --------------------------------------------------------------------
@@ -267,98 +692,53 @@ void* protocolSender(void* vargp)
                 // bye was sended, end program
                 setProgramState(progInt, fsm_END);
                 queueUnlock(sendingQueue);
+                flushSendedMessages(progInt);
                 // signal main to end as well
-                pthread_cond_signal(progInt->threads->mainCond);
+                notifierNotify(&(progInt->threads->mainNotifier));
                 continue; // jump to while condition and end
             }
             else // else wait for someone to ping me
             {
-                // use pthread wait for main thread to ping that queue is not 
-                // empty or timeout to expire
+                // wait for main or receiver to add message to the queue
                 debugPrint(stdout, "DEBUG: Sender waiting (queue empty)\n");
                 queueUnlock(sendingQueue);
-                pthread_cond_wait(progInt->threads->senderEmptyQueueCond, 
-                    progInt->threads->senderEmptyQueueMutex);
+                // confirms sended above
+                flushSendedMessages(progInt);
+                notifierWait(senderNotifier, seen, NULL);
                 continue;
             }
         }
-        
-        // make room for someone who is waiting
-        queueUnlock(sendingQueue);
 
         // --------------------------------------------------------------------
-        // Filter messages by current state of program
+        // Send messages that are allowed by current state of program 
         // --------------------------------------------------------------------
 
-        queueLock(sendingQueue);
-
-        logicFSM(progInt);
-
-        Message* msgToBeSend = queueGetMessage(sendingQueue);
-
-        // --------------------------------------------------------------------
-        // Send message
-        // --------------------------------------------------------------------
+        sended += fillSendingWindow(sendingQueue, progInt);
 
-        // in udp variant messages must be label with correct message id
+        bool waitingForConfirm = false;
         UDP_VARIANT
-            // set correct message id right before sending it
-            queueSetMessageID(sendingQueue, progInt);
-        TCP_VARIANT
-            progInt->comDetails->msgCounter += 1;
+            waitingForConfirm = getNearestRetransmit(sendingQueue, &timeToWait);
         END_VARIANTS
 
-        #ifdef DEBUG
-            debugPrint(stdout, "DEBUG: Sender (queue len: %li): ", sendingQueue->len);
-            bufferPrint(msgToBeSend->buffer, 3);
-        #endif
-
-        int bytesTx; // number of sended bytes
-        // send buffer to the server 
-        bytesTx = sendto(progInt->netConfig->openedSocket, msgToBeSend->buffer->data, 
-                        msgToBeSend->buffer->used, flags, progInt->netConfig->serverAddress, 
-                        progInt->netConfig->serverAddressSize);
+        bool queueEmpty = queueIsEmpty(sendingQueue);
+        queueUnlock(sendingQueue);
 
-        // store sended messeges's flags
-        msg_flags sendedMessageFlags = queueGetMessageFlags(sendingQueue);
+        // resended and newly sended messages are sended in one batch, 
+        // after queue was unlocked
+        flushSendedMessages(progInt);
 
-        if(bytesTx < 0)
+        if(waitingForConfirm)
         {
-            errHandling("Sending bytes was not successful", err_COMMUNICATION);
+            // wait until nearest message should be resent, receiver signals
+            // sender when confirmation arrives
+            notifierWait(senderNotifier, seen, &timeToWait);
+        }
+        else if(sended == 0 && !queueEmpty)
+        {
+            // messages in queue cannot be sended in current state, wait for 
+            // receiver to change state of the program
+            notifierWait(senderNotifier, seen, NULL);
         }
-
-        UDP_VARIANT
-            // pop messages that should not be resend again
-            switch (sendedMessageFlags)
-            {
-            case msg_flag_DO_NOT_RESEND: /*general do not resend*/
-            case msg_flag_CONFIRM: /*confirm*/
-            case msg_flag_NOK_REPLY: /*confirm to bad reply*/
-                queuePopMessage(sendingQueue);
-                break;
-            default: /*other: increase sended message counter*/
-                queueMessageSended(sendingQueue);
-                break;
-            }
-        TCP_VARIANT
-            // if it was message, signal main
-            if(msgToBeSend->type == msg_MSG)
-            {
-                // ping main to work again
-                pthread_cond_signal(progInt->threads->mainCond);
-            }
-            // in tcp variant always pop message
-            queuePopMessage(sendingQueue);
-        END_VARIANTS
-
-        queueUnlock(sendingQueue);
-
-        // After message has been sended wait udpTimeout time until 
-        // attempting to resend it / again
-        // only receiver can signal sender from this state
-        TIMEOUT_CALCULATION(progInt->netConfig->udpTimeout);
-        pthread_cond_timedwait(progInt->threads->rec2SenderCond, progInt->threads->rec2SenderMutex, &timeToWait);
-
     }
 
     debugPrint(stdout, "DEBUG: Sender ended\n");
@@ -16,8 +16,79 @@
 #include "pthread.h"
 
 #include "libs/ipk24protocol.h"
+#include "libs/submitRing.h"
 #include "protocolReceiver.h"
 
+/**
+ * @brief Returns true if first timespec is earlier than the second one
+ */
+#define TIMESPEC_EARLIER(a, b)                                                  \
+    ((a).tv_sec < (b).tv_sec || ((a).tv_sec == (b).tv_sec && (a).tv_nsec < (b).tv_nsec))
+
+/**
+ * @brief Returns true if message changes state of the program (AUTH, JOIN, 
+ * ERR, BYE). These messages are sended only after all messages in sending 
+ * window were confirmed and no other message is sended until they are 
+ * confirmed as well.
+ * 
+ * @param msg Pointer to the message
+ */
+bool isBarrierMessage(Message* msg);
+
+/**
+ * @brief Sends all messages that were prepared by sendMessage() with one 
+ * system call, does nothing if messages are not sended in batches. Messages
+ * copied to the outbox are sended as well, sender calls it after sending 
+ * queue is unlocked.
+ * 
+ * @param progInt Pointer to the ProgramInterface
+ */
+void flushSendedMessages(ProgramInterface* progInt);
+
+/**
+ * @brief Filters out messages from provided queue that were sent
+ *  more than specified times in NetworkConfiguration or that are
+ * already confirmed. Messages in sending window which confirmation timed 
+ * out are resended.
+ * 
+ * @param sendingQueue Pointer to queue from which should messages be filtered 
+ * @param progInt Pointer to ProgramInterface
+ * @return true Program state was changed to END, sender loop must be reset
+ */
+bool filterResentMessages(MessageQueue* sendingQueue, ProgramInterface* progInt);
+
+/**
+ * @brief Sends all messages from control lane of queue, these are never 
+ * resended and never wait for sending window or for retransmissions. 
+ * Sender calls it before anything else is sended.
+ * 
+ * @param sendingQueue Pointer to queue from which messages will be sended
+ * @param progInt Pointer to ProgramInterface
+ * @return size_t Number of sended messages
+ */
+size_t sendControlMessages(MessageQueue* sendingQueue, ProgramInterface* progInt);
+
+/**
+ * @brief Sends messages from data lane of queue that were not sended yet, 
+ * until sending window is full or until message that cannot be sended in 
+ * current state of program is found.
+ * 
+ * @param sendingQueue Pointer to queue from which messages will be sended
+ * @param progInt Pointer to ProgramInterface
+ * @return size_t Number of sended messages
+ */
+size_t fillSendingWindow(MessageQueue* sendingQueue, ProgramInterface* progInt);
+
+/**
+ * @brief Finds message in sending window that should be resended first
+ * 
+ * @param sendingQueue Pointer to the queue
+ * @param nearest Output time of the nearest retransmission 
+ * @return true Some message is waiting for confirmation
+ * @return false No message is waiting for confirmation
+ */
+bool getNearestRetransmit(MessageQueue* sendingQueue, struct timespec* nearest);
+
 /**
  * @brief Initializes protocol sending functionality 
  * 
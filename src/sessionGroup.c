@@ -0,0 +1,468 @@
+/**
+ * @file sessionGroup.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Implementation of Session Group, multiple chat sessions driven by
+ * one event loop in one thread (--sessions)
+ *
+ * Sessions are processed by the same functions as single event loop,
+ * however only sessions that were touched by an event (received message,
+ * user input, expired retransmission, SIGINT) are processed in each
+ * iteration, so idle sessions cost nothing. Nearest retransmissions of 
+ * sessions are kept in min-heap, expiration of shared timer touches only 
+ * sessions whose retransmission is due.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+// CLOCK_REALTIME
+#define _DEFAULT_SOURCE
+
+#include "errno.h"
+#include "sys/epoll.h"
+#include "sys/timerfd.h"
+#include "sys/signalfd.h"
+
+#include "sessionGroup.h"
+#include "protocolReceiver.h"
+#include "protocolSender.h"
+#include "libs/cleanUpMaster.h"
+
+// global pointer of ProgramInterface, points to the session that is
+// currently processed so errors are reported by correct session
+extern ProgramInterface* globalProgInt;
+
+// ----------------------------------------------------------------------------
+// Sessions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Creates session with configuration of progInt and connects it
+ * to the server
+ *
+ * @param group Pointer to the session group
+ * @param progInt Pointer to the program interface holding configuration
+ * @param sessionId Index of session in group
+ * @return ProgramInterface* Program interface of created session
+ */
+ProgramInterface* sessionGroupCreateSession(SessionGroup* group, ProgramInterface* progInt, size_t sessionId)
+{
+    ProgramInterface* session = (ProgramInterface*) calloc(1, sizeof(ProgramInterface));
+    if(session == NULL)
+    {
+        errHandling("Failed to allocate memory for session", err_MEMORY_FAIL);
+    }
+
+    programInterfaceInit(session);
+    // UDP server can respond from different port, every session has its
+    // own copy of addresses
+    *(session->netConfig) = *(progInt->netConfig);
+    openServerConnection(session->netConfig);
+
+    // IDs of received messages are needed only to detect duplicate UDP messages
+    if(session->netConfig->protocol == prot_UDP)
+    {
+        session->cleanUp->confirmedMessages = messageIdSetCreate();
+        if(session->cleanUp->confirmedMessages == NULL)
+        {
+            errHandling("Failed to allocate memory for MessageIdSet", err_MEMORY_FAIL);
+        }
+    }
+
+    // batches are shared, they are flushed after each processed session
+    session->cleanUp->sendRing = progInt->cleanUp->sendRing;
+    session->cleanUp->sendBatch = progInt->cleanUp->sendBatch;
+    session->cleanUp->recvBatch = progInt->cleanUp->recvBatch;
+
+    eventLoopInitSession(session, group, group->control, sessionId);
+
+    return session;
+}
+
+/**
+ * @brief Closes socket of session and frees its program interface
+ *
+ * @param session Pointer to the program interface of session
+ */
+void sessionGroupDestroySession(ProgramInterface* session)
+{
+    if(session == NULL) { return; }
+
+    shutdown(session->netConfig->openedSocket, SHUT_RDWR);
+    close(session->netConfig->openedSocket);
+
+    // shared resources are destroyed together with group
+    session->cleanUp->sendRing = NULL;
+    session->cleanUp->sendBatch = NULL;
+    session->cleanUp->recvBatch = NULL;
+
+    programInterfaceDestroy(session);
+}
+
+/**
+ * @brief Marks session to be processed in current iteration
+ *
+ * @param group Pointer to the session group
+ * @param sessionId Index of session in group
+ */
+void sessionGroupTouch(SessionGroup* group, size_t sessionId)
+{
+    if(group->isTouched[sessionId] || group->ended[sessionId]) { return; }
+
+    group->isTouched[sessionId] = true;
+    group->touched[group->touchedCount] = sessionId;
+    group->touchedCount += 1;
+}
+
+/**
+ * @brief Marks all sessions to be processed in current iteration
+ *
+ * @param group Pointer to the session group
+ */
+void sessionGroupTouchAll(SessionGroup* group)
+{
+    for(size_t i = 0; i < group->sessionsCount; i++)
+    {
+        sessionGroupTouch(group, i);
+    }
+}
+
+/**
+ * @brief Sends messages of session and processes its pending user input,
+ * if session reached END state its socket is removed from group
+ *
+ * @param group Pointer to the session group
+ * @param sessionId Index of session in group
+ */
+void sessionGroupProcess(SessionGroup* group, size_t sessionId)
+{
+    ProgramInterface* progInt = group->sessions[sessionId];
+    EventLoop* loop = progInt->cleanUp->eventLoop;
+    globalProgInt = progInt;
+
+    eventLoopSend(progInt);
+    eventLoopHandleInput(progInt, loop);
+    // batch is shared with other sessions, it must be sended through
+    // socket of this session
+    flushSendedMessages(progInt);
+
+    if(getProgramState(progInt) != fsm_END) { return; }
+
+    epoll_ctl(loop->epollFd, EPOLL_CTL_DEL, progInt->netConfig->openedSocket, NULL);
+    loop->waitingForConfirm = false;
+    deadlineHeapRemove(&(group->retransmits), sessionId);
+    group->ended[sessionId] = true;
+    group->activeSessions -= 1;
+}
+
+// ----------------------------------------------------------------------------
+// Retransmission timer
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Arms shared timer to the nearest retransmission of all sessions if 
+ * it is sooner than current timer expiration
+ *
+ * @param group Pointer to the session group
+ */
+void sessionGroupRearmTimer(SessionGroup* group)
+{
+    struct timespec nearest;
+    if(!deadlineHeapPeek(&(group->retransmits), &nearest)) { return; }
+    if(group->timerArmed && !TIMESPEC_EARLIER(nearest, group->timerAt)) { return; }
+
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    timer.it_value = nearest;
+    timerfd_settime(group->control->timerFd, TFD_TIMER_ABSTIME, &timer, NULL);
+
+    group->timerArmed = true;
+    group->timerAt = nearest;
+}
+
+/**
+ * @brief Updates nearest retransmission of session and arms shared 
+ * retransmission timer if it is sooner than current timer expiration
+ *
+ * @param group Pointer to the session group
+ * @param loop Event loop of session that was changed
+ */
+void sessionGroupScheduleRetransmit(SessionGroup* group, EventLoop* loop)
+{
+    if(!loop->waitingForConfirm)
+    {
+        deadlineHeapRemove(&(group->retransmits), loop->sessionId);
+        return;
+    }
+
+    deadlineHeapSet(&(group->retransmits), loop->sessionId, loop->retransmitAt);
+    sessionGroupRearmTimer(group);
+}
+
+/**
+ * @brief Touches sessions whose retransmission time already passed,
+ * called when shared timer expires. Touched sessions schedule their next
+ * retransmission again when they are processed.
+ *
+ * @param group Pointer to the session group
+ */
+void sessionGroupTimerExpired(SessionGroup* group)
+{
+    uint64_t expirations;
+    if(read(group->control->timerFd, &expirations, sizeof(expirations)) < 0) {}
+    group->timerArmed = false;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    size_t sessionId;
+    while(deadlineHeapPopExpired(&(group->retransmits), now, &sessionId))
+    {
+        sessionGroupTouch(group, sessionId);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// User input
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Routes one line of user input to session(s) by its prefix,
+ * "<index> <input>" or "* <input>"
+ *
+ * @param group Pointer to the session group
+ * @param progInt Pointer to the program interface holding configuration
+ * @param line Line of user input
+ */
+void sessionGroupRouteInput(SessionGroup* group, ProgramInterface* progInt, Buffer* line)
+{
+    char* data = line->data;
+    size_t len = line->used;
+
+    // remove new line, it is added back for every session
+    if(len > 0 && data[len - 1] == '\n') { len -= 1; }
+    if(len == 0) { return; }
+
+    bool broadcast = false;
+    size_t sessionId = 0;
+    size_t prefixLen = 0;
+
+    if(data[0] == '*')
+    {
+        broadcast = true;
+        prefixLen = 1;
+    }
+    else
+    {
+        while(prefixLen < len && data[prefixLen] >= '0' && data[prefixLen] <= '9')
+        {
+            sessionId = sessionId * 10 + (data[prefixLen] - '0');
+            prefixLen += 1;
+            // index is too big, stop before it overflows
+            if(sessionId >= group->sessionsCount) { break; }
+        }
+    }
+
+    if(prefixLen == 0 || prefixLen >= len || data[prefixLen] != ' ' ||
+        (!broadcast && sessionId >= group->sessionsCount))
+    {
+        safePrintStderr("ERR: Input must be prefixed by session index or '*' "
+            "(for example \"0 /auth user secret name\").\n");
+        return;
+    }
+
+    // input of session is without prefix and separating space
+    char* input = data + prefixLen + 1;
+    size_t inputLen = len - prefixLen - 1;
+
+    for(size_t i = 0; i < group->sessionsCount; i++)
+    {
+        if(!broadcast) { i = sessionId; }
+
+        if(!group->ended[i])
+        {
+            EventLoop* loop = group->sessions[i]->cleanUp->eventLoop;
+            eventLoopAppendInput(loop, input, inputLen);
+            eventLoopAppendInput(loop, "\n", 1);
+            sessionGroupTouch(group, i);
+        }
+
+        if(!broadcast) { break; }
+    }
+}
+
+/**
+ * @brief Reads user input and routes complete lines to sessions, after
+ * end of input all sessions are told to end
+ *
+ * @param group Pointer to the session group
+ * @param progInt Pointer to the program interface holding configuration
+ */
+void sessionGroupHandleInput(SessionGroup* group, ProgramInterface* progInt)
+{
+    EventLoop* control = group->control;
+    Buffer line;
+
+    while(eventLoopGetLine(control, &line))
+    {
+        sessionGroupRouteInput(group, progInt, &line);
+    }
+
+    if(!control->stdinEof || group->eofPropagated) { return; }
+
+    // level triggered epoll would keep reporting closed stdin
+    if(control->stdinWatched)
+    {
+        epoll_ctl(control->epollFd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+        control->stdinWatched = false;
+    }
+
+    for(size_t i = 0; i < group->sessionsCount; i++)
+    {
+        group->sessions[i]->cleanUp->eventLoop->stdinEof = true;
+    }
+    sessionGroupTouchAll(group);
+    group->eofPropagated = true;
+}
+
+// ----------------------------------------------------------------------------
+// Session group
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Waits for events of all sessions and touches sessions they
+ * belong to
+ *
+ * @param group Pointer to the session group
+ */
+void sessionGroupDispatch(SessionGroup* group)
+{
+    EventLoop* control = group->control;
+    bool readsFile = !control->stdinPolled && !control->stdinEof;
+
+    // regular file on stdin is always readable, only check other events
+    int timeout = readsFile ? 0 : -1;
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int eventsCount = epoll_wait(control->epollFd, events, MAX_EPOLL_EVENTS, timeout);
+    if(eventsCount < 0 && errno != EINTR)
+    {
+        errHandling("epoll_wait() failed", err_COMMUNICATION);
+    }
+
+    bool timerExpired = false;
+    for(int i = 0; i < eventsCount; i++)
+    {
+        size_t sessionId = EVENT_SESSION(events[i].data.u64);
+
+        switch(EVENT_SOURCE(events[i].data.u64))
+        {
+        case evt_STDIN:
+            eventLoopReadStdin(control);
+            break;
+        case evt_SOCKET:
+            if(group->ended[sessionId]) { break; }
+            globalProgInt = group->sessions[sessionId];
+            eventLoopReceive(group->sessions[sessionId]);
+            sessionGroupTouch(group, sessionId);
+            break;
+        case evt_TIMER:
+            sessionGroupTimerExpired(group);
+            timerExpired = true;
+            break;
+        case evt_SIGNAL:;
+            struct signalfd_siginfo info;
+            if(read(control->signalFd, &info, sizeof(info)) != sizeof(info)) { break; }
+            for(size_t j = 0; j < group->sessionsCount; j++)
+            {
+                if(group->ended[j]) { continue; }
+                globalProgInt = group->sessions[j];
+                eventLoopSigintBye(group->sessions[j]);
+                sessionGroupTouch(group, j);
+            }
+            break;
+        }
+    }
+
+    if(readsFile)
+    {
+        eventLoopReadStdin(control);
+    }
+
+    sessionGroupHandleInput(group, group->config);
+
+    for(size_t i = 0; i < group->touchedCount; i++)
+    {
+        size_t sessionId = group->touched[i];
+        group->isTouched[sessionId] = false;
+        sessionGroupProcess(group, sessionId);
+    }
+    group->touchedCount = 0;
+
+    if(timerExpired)
+    {
+        sessionGroupRearmTimer(group);
+    }
+}
+
+/**
+ * @brief Creates sessionsCount sessions with configuration of progInt,
+ * connects them to the server and runs them until all of them reach END
+ * state
+ *
+ * @param progInt Pointer to the program interface holding configuration
+ * @param sessionsCount Number of sessions
+ */
+void sessionGroupRun(ProgramInterface* progInt, size_t sessionsCount)
+{
+    SessionGroup group;
+    memset(&group, 0, sizeof(group));
+
+    group.config = progInt;
+    group.sessionsCount = sessionsCount;
+    group.sessions = (ProgramInterface**) calloc(sessionsCount, sizeof(ProgramInterface*));
+    group.ended = (bool*) calloc(sessionsCount, sizeof(bool));
+    group.isTouched = (bool*) calloc(sessionsCount, sizeof(bool));
+    group.touched = (size_t*) calloc(sessionsCount, sizeof(size_t));
+    if(group.sessions == NULL || group.ended == NULL ||
+        group.isTouched == NULL || group.touched == NULL ||
+        !deadlineHeapInit(&(group.retransmits), sessionsCount))
+    {
+        errHandling("Failed to allocate memory for sessions", err_MEMORY_FAIL);
+    }
+
+    // event loop of configuration holds descriptors shared by sessions,
+    // it has no socket of its own
+    group.control = eventLoopInit(progInt);
+
+    for(size_t i = 0; i < sessionsCount; i++)
+    {
+        group.sessions[i] = sessionGroupCreateSession(&group, progInt, i);
+    }
+    group.activeSessions = sessionsCount;
+
+    while(group.activeSessions > 0)
+    {
+        sessionGroupDispatch(&group);
+    }
+
+    debugPrint(stdout, "DEBUG: Session group ended\n");
+
+    for(size_t i = 0; i < sessionsCount; i++)
+    {
+        statisticsAddRtt(progInt->stats, &(group.sessions[i]->comDetails->rtt), 
+            progInt->netConfig->udpTimeout);
+        progInt->stats->transmissions += group.sessions[i]->stats->transmissions;
+        progInt->stats->retransmissions += group.sessions[i]->stats->retransmissions;
+        statisticsAddPool(progInt->stats, &(group.sessions[i]->threads->sendingQueue->pool));
+        statisticsAddIdSet(progInt->stats, group.sessions[i]->cleanUp->confirmedMessages);
+        sessionGroupDestroySession(group.sessions[i]);
+    }
+    globalProgInt = progInt;
+
+    free(group.sessions);
+    free(group.ended);
+    free(group.isTouched);
+    free(group.touched);
+    deadlineHeapDestroy(&(group.retransmits));
+}
@@ -0,0 +1,64 @@
+/**
+ * @file sessionGroup.h
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Header file for Session Group, multiple chat sessions driven by
+ * one event loop in one thread (--sessions)
+ *
+ * Every session has its own program interface, socket and FSM, however all
+ * sessions share one epoll instance, one retransmission timer and one
+ * SIGINT signalfd. User input is routed to sessions by prefix of line:
+ * "<index> <input>" is processed by one session, "* <input>" by all of them.
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SESSION_GROUP_H
+#define SESSION_GROUP_H 1
+
+#include "eventLoop.h"
+#include "deadlineHeap.h"
+
+/**
+ * @brief Structure holding sessions of group and descriptors they share
+ */
+typedef struct SessionGroup {
+    ProgramInterface* config; // configuration and resources shared by sessions
+    EventLoop* control; // shared descriptors and user input of all sessions
+    ProgramInterface** sessions;
+    size_t sessionsCount;
+    size_t activeSessions; // sessions that didn't reach END state
+    bool* ended; // session reached END state and its socket was closed
+
+    // sessions that have to be processed in current iteration
+    size_t* touched;
+    bool* isTouched;
+    size_t touchedCount;
+
+    // sessions waiting for confirmation ordered by their nearest retransmission
+    DeadlineHeap retransmits;
+    bool timerArmed; // timerAt is valid
+    struct timespec timerAt; // time at which shared timer expires
+    bool eofPropagated; // all sessions were told that there is no more input
+} SessionGroup;
+
+/**
+ * @brief Creates sessionsCount sessions with configuration of progInt,
+ * connects them to the server and runs them until all of them reach END
+ * state
+ *
+ * @param progInt Pointer to the program interface holding configuration
+ * @param sessionsCount Number of sessions
+ */
+void sessionGroupRun(ProgramInterface* progInt, size_t sessionsCount);
+
+/**
+ * @brief Arms shared retransmission timer if retransmission of session is
+ * sooner than current timer expiration
+ *
+ * @param group Pointer to the session group
+ * @param loop Event loop of session that was changed
+ */
+void sessionGroupScheduleRetransmit(SessionGroup* group, EventLoop* loop);
+
+#endif /*SESSION_GROUP_H*/
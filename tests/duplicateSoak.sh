@@ -0,0 +1,39 @@
+#!/bin/bash
+# Soak test of long UDP session, test server sends many messages to the 
+# client (some of them twice) and prints latency of confirmations and memory
+# of client, both should stay flat. Every message must be printed once.
+#
+# usage: ./tests/duplicateSoak.sh [messages] [client options, e.g. --stats]
+# (PAUSE=microseconds between messages, default 0)
+# (run from root of repository after make)
+
+MESSAGES=${1:-1000000}
+shift 1 2>/dev/null
+CLIENT=./ipk24chat-client
+
+SERVER=$(mktemp)
+PIDFILE=$(mktemp)
+OUTPUT=$(mktemp)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; rm -f $SERVER $PIDFILE $OUTPUT' EXIT
+
+gcc -O2 -o $SERVER tests/serverSoak.c || exit 1
+$SERVER $MESSAGES $PIDFILE ${PAUSE:-0} &
+SERVER_PID=$!
+sleep 0.2
+
+# input stays open until server ends session
+(echo "/auth a sec Bot"; while kill -0 $SERVER_PID 2>/dev/null; do sleep 1; done) | \
+    $CLIENT -t udp -s 127.0.0.1 "$@" > $OUTPUT 2>&1 &
+sleep 0.1
+pgrep -n -x ipk24chat-clien > $PIDFILE
+
+wait $SERVER_PID
+SERVER_PID=
+wait
+
+# statistics of client (--stats)
+sed -n '/^Statistics:/,$p' $OUTPUT
+
+PRINTED=$(grep -c "^Soak: " $OUTPUT)
+echo "printed $PRINTED of $MESSAGES messages"
+[ "$PRINTED" -eq "$MESSAGES" ]
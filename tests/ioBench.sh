@@ -0,0 +1,85 @@
+#!/bin/bash
+# Compares system calls and CPU time per message of default build and build
+# with io_uring backend (make IO=uring), both clients send same burst of
+# messages to local test server. Syscalls are counted by tests/syscallCount.c
+# (like "strace -c -f"), CPU time is user + system time of untraced run.
+# Cost of start and authentication is measured by run without messages and
+# subtracted. CPU time is the best of 3 runs. Client runs in event loop by 
+# default, so wakeups of threads are not counted.
+#
+# tests/serverTCP.c answers only one message per read, so TCP variant 
+# measures mainly sending, UDP server sends every message back.
+#
+# usage: ./tests/ioBench.sh [udp|tcp] [messages] [client options]
+# (run from root of repository)
+
+PROTOCOL=${1:-udp}
+MESSAGES=${2:-5000}
+shift $(( $# < 2 ? $# : 2 ))
+OPTIONS=${@:---event-loop -w 64}
+
+DIR=$(mktemp -d)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; rm -rf $DIR' EXIT
+
+# same flags as Makefile
+CFLAGS="-std=c17 -pthread -Isrc/libs"
+gcc $CFLAGS -o $DIR/default src/*.c src/libs/*.c -lm || exit 1
+gcc $CFLAGS -DIO_URING -o $DIR/uring src/*.c src/libs/*.c -lm || exit 1
+gcc -std=c17 -O2 -o $DIR/count tests/syscallCount.c || exit 1
+if [ "$PROTOCOL" = udp ]; then
+    gcc -o $DIR/server tests/serverUDP.c || exit 1
+else
+    gcc -o $DIR/server tests/serverTCP.c || exit 1
+fi
+
+echo "/auth a sec Bot" > $DIR/auth
+cp $DIR/auth $DIR/burst
+for ((m = 0; m < MESSAGES; m++)); do echo "msg $m"; done >> $DIR/burst
+
+# runs client with input against new server, prints number of syscalls (and 
+# keeps their summary) if "count" is given, otherwise CPU time in ms
+# usage: run client input [count]
+run()
+{
+    $DIR/server > /dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 0.2
+
+    if [ "$3" = count ]; then
+        timeout 120 $DIR/count $1 -t $PROTOCOL -s 127.0.0.1 $OPTIONS \
+            < $2 > /dev/null 2> $DIR/summary
+        grep "^syscalls:" $DIR/summary | sed 's/^[^:]*: //'
+    else
+        TIMEFORMAT="%3U %3S"
+        { time timeout 120 $1 -t $PROTOCOL -s 127.0.0.1 $OPTIONS \
+            < $2 > /dev/null 2>&1 ; } 2>&1 | awk '{ print ($1 + $2) * 1000 }'
+    fi
+
+    kill $SERVER_PID 2>/dev/null
+    wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+}
+
+# prints best CPU time (ms) of 3 runs
+# usage: bestCpu client input
+bestCpu()
+{
+    for ((i = 0; i < 3; i++)); do run $1 $2; done | sort -n | head -1
+}
+
+echo "$PROTOCOL, $MESSAGES messages, options: $OPTIONS"
+for BUILD in default uring; do
+    CALLS_AUTH=$(run $DIR/$BUILD $DIR/auth count)
+    CALLS_BURST=$(run $DIR/$BUILD $DIR/burst count)
+    cp $DIR/summary $DIR/summary.burst
+    CPU_AUTH=$(bestCpu $DIR/$BUILD $DIR/auth)
+    CPU_BURST=$(bestCpu $DIR/$BUILD $DIR/burst)
+
+    awk -v build=$BUILD -v n=$MESSAGES -v ca=$CALLS_AUTH -v cb=$CALLS_BURST \
+        -v ta=$CPU_AUTH -v tb=$CPU_BURST 'BEGIN {
+        printf "%-8s %8.2f syscalls/message %8.2f us CPU/message\n",
+            build, (cb - ca) / n, (tb - ta) * 1000 / n }'
+    # syscalls used for communication, other lines are output of client
+    grep "^  " $DIR/summary.burst
+done
+exit 0
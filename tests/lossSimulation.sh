@@ -0,0 +1,41 @@
+#!/bin/bash
+# Simulation of lossy and congested server on loopback, compares number of 
+# UDP retransmissions without backoff (--backoff-cap 0) and with backoff.
+#
+# usage: ./tests/lossSimulation.sh [loss percentage] [service time in us] [sessions]
+# (run from root of repository after make)
+
+LOSS=${1:-5}
+SERVICE=${2:-1000}
+SESSIONS=${3:-50}
+MESSAGES=10
+
+CLIENT=./ipk24chat-client
+SERVER=$(mktemp)
+INPUT=$(mktemp)
+OUTPUT=$(mktemp)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID; rm -f $SERVER $INPUT $OUTPUT' EXIT
+
+gcc -o $SERVER tests/serverUDP.c || exit 1
+
+# every session authenticates and then all sessions send messages at once
+for ((i = 0; i < SESSIONS; i++)); do echo "$i /auth a sec Bot$i"; done > $INPUT
+for ((m = 0; m < MESSAGES; m++)); do echo "* msg $m"; done >> $INPUT
+
+for CAP in 0 2000; do
+    $SERVER $LOSS $SERVICE > /dev/null &
+    SERVER_PID=$!
+    sleep 0.2
+
+    timeout 120 $CLIENT -t udp -s 127.0.0.1 --sessions $SESSIONS --stats \
+        --backoff-cap $CAP < $INPUT > $OUTPUT 2>&1
+
+    DELIVERED=$(grep -c ": msg" $OUTPUT)
+    RETRANSMISSIONS=$(grep "retransmissions:" $OUTPUT | sed 's/^[^:]*: //')
+    echo "backoff cap $CAP ms: delivered $DELIVERED of $((SESSIONS * MESSAGES)), retransmissions $RETRANSMISSIONS"
+
+    kill $SERVER_PID 2>/dev/null
+    wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+done
+exit 0
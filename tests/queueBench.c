@@ -0,0 +1,183 @@
+/**
+ * @file queueBench.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Microbenchmark of MessageQueue, measures cost of adding message to
+ * the queue, sending it (assigning ID and copying contents to the socket 
+ * buffer), scanning sended messages for retransmission and popping them
+ *
+ * Build and run with tests/queueBench.sh
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#include "msgQueue.h"
+
+// protocol messages contain up to 1400 characters, most of them are short
+#define BENCH_MAX_CONTENT 240
+// messages in flight in windowed run (option -w of client)
+#define BENCH_WINDOW 64
+
+/**
+ * @brief Replaces errHandling() of client, benchmark has no program state
+ */
+int errHandling(const char* msg, int errorCode)
+{
+    fprintf(stderr, "ERR: %s\n", msg);
+    exit(errorCode);
+    return 0;
+}
+
+/**
+ * @brief Returns monotonic time in nanoseconds
+ */
+long long benchNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Fills buffer with UDP MSG of given number of characters
+ */
+void benchFillMessage(Buffer* buffer, size_t contentLen)
+{
+    size_t pos = 0;
+    buffer->data[pos++] = msg_MSG;
+    buffer->data[pos++] = 0;
+    buffer->data[pos++] = 0;
+    memcpy(&(buffer->data[pos]), "Bot", 4);
+    pos += 4;
+    memset(&(buffer->data[pos]), 'a' + (contentLen % 26), contentLen);
+    pos += contentLen;
+    buffer->data[pos++] = '\0';
+    buffer->used = pos;
+}
+
+/**
+ * @brief Sends message, assigns ID and copies its contents into socket buffer
+ */
+void benchSend(Message* msg, ProgramInterface* progInt, char* socketBuffer)
+{
+    queueAssignMessageID(msg, progInt);
+    memcpy(socketBuffer, msg->buffer->data, msg->buffer->used);
+    msg->sendCount += 1;
+    msg->sentAt.tv_sec = msg->msgId;
+    msg->retransmitAt.tv_sec = msg->msgId + 1;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 5;
+
+    char data[BENCH_MAX_CONTENT + 16];
+    Buffer buffer = {.data = data, .allocated = sizeof(data), .used = 0};
+    char socketBuffer[sizeof(data)];
+
+    CommunicationDetails comDetails;
+    memset(&comDetails, 0, sizeof(comDetails));
+    ProgramInterface progInt;
+    memset(&progInt, 0, sizeof(progInt));
+    progInt.comDetails = &comDetails;
+
+    // queueDestroy() frees queue
+    MessageQueue* queue = (MessageQueue*) malloc(sizeof(MessageQueue));
+    if(queue == NULL) { errHandling("Failed to allocate queue", 1); }
+    queueInit(queue);
+
+    // best time of all rounds
+    long long best[5] = {-1, -1, -1, -1, -1};
+    long long checksum = 0;
+
+    for(int round = 0; round < rounds; round++)
+    {
+        long long times[5];
+
+        // add all messages to the queue
+        long long start = benchNow();
+        for(size_t i = 0; i < count; i++)
+        {
+            benchFillMessage(&buffer, (i * 37) % BENCH_MAX_CONTENT);
+            queueLock(queue);
+            queueAddMessage(queue, &buffer, msg_flag_NONE, msg_MSG);
+            queueUnlock(queue);
+        }
+        times[0] = benchNow() - start;
+
+        // send all messages
+        start = benchNow();
+        queueLock(queue);
+        for(Message* msg = queueGetMessage(queue); msg != NULL; msg = msg->behindMe)
+        {
+            benchSend(msg, &progInt, socketBuffer);
+        }
+        queueUnlock(queue);
+        times[1] = benchNow() - start;
+
+        // walk sended messages like sender looking for retransmission
+        start = benchNow();
+        queueLock(queue);
+        for(Message* msg = queueGetMessage(queue); msg != NULL; msg = msg->behindMe)
+        {
+            if(msg->msgFlags == msg_flag_NONE && !msg->confirmed &&
+                msg->retransmitAt.tv_sec < msg->sendCount)
+            {
+                checksum += msg->msgId;
+            }
+        }
+        queueUnlock(queue);
+        times[2] = benchNow() - start;
+
+        // pop all messages
+        start = benchNow();
+        for(size_t i = 0; i < count; i++)
+        {
+            queueLock(queue);
+            queuePopMessage(queue);
+            queueUnlock(queue);
+        }
+        times[3] = benchNow() - start;
+
+        // steady state: message is added, sended and oldest one is confirmed
+        start = benchNow();
+        for(size_t i = 0; i < count; i++)
+        {
+            benchFillMessage(&buffer, (i * 37) % BENCH_MAX_CONTENT);
+            queueLock(queue);
+            queueAddMessage(queue, &buffer, msg_flag_NONE, msg_MSG);
+            benchSend(queue->last, &progInt, socketBuffer);
+            if(queueLength(queue) > BENCH_WINDOW)
+            {
+                queuePopMessage(queue);
+            }
+            queueUnlock(queue);
+        }
+        queueLock(queue);
+        queuePopAllMessages(queue);
+        queueUnlock(queue);
+        times[4] = benchNow() - start;
+
+        for(int i = 0; i < 5; i++)
+        {
+            if(best[i] < 0 || times[i] < best[i]) { best[i] = times[i]; }
+        }
+    }
+
+    const char* names[5] = {"enqueue", "send", "scan", "pop", "windowed"};
+    for(int i = 0; i < 5; i++)
+    {
+        printf("%-9s %7.1f ns/msg\n", names[i], (double) best[i] / count);
+    }
+    printf("(%zu messages, best of %d rounds, sizeof(Message) %zu, checksum %lld)\n",
+        count, rounds, sizeof(Message), checksum);
+
+    queueDestroy(queue);
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/bash
+# Builds and runs microbenchmark of MessageQueue (tests/queueBench.c) with 
+# sources of queue from given directory, so layouts of Message from two 
+# revisions can be compared.
+#
+# usage: ./tests/queueBench.sh [messages] [rounds] [source directory]
+# (run from root of repository, source directory defaults to ./src)
+
+COUNT=${1:-100000}
+ROUNDS=${2:-5}
+SRC=${3:-src}
+
+BENCH=$(mktemp)
+trap 'rm -f $BENCH' EXIT
+
+# queue of newer revisions uses submit ring and utils.c uses character 
+# scanner, older revisions do not have them
+OPTIONAL=$(ls $SRC/libs/submitRing.c $SRC/libs/charScan.c 2>/dev/null)
+
+gcc -std=c17 -O2 -pthread -I$SRC/libs -o $BENCH tests/queueBench.c \
+    $SRC/libs/msgQueue.c $SRC/libs/messagePool.c $SRC/libs/buffer.c \
+    $SRC/libs/utils.c $OPTIONAL -lm || exit 1
+
+$BENCH $COUNT $ROUNDS
@@ -0,0 +1,346 @@
+/**
+ * @file scanBench.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Microbenchmark of searching primitives of CharScanner and parsers
+ * of received messages over corpus of realistic messages with 1400
+ * characters of contents and corpus of short chat lines, prints bytes per 
+ * cycle of every implementation
+ *
+ * Before measuring, results of every implementation are compared with
+ * scalar implementation for all alignments and lengths of short strings
+ * and for every message of corpus.
+ *
+ * Build and run with tests/scanBench.sh
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "x86intrin.h"
+
+#include "charScan.h"
+#include "ipk24protocol.h"
+
+// number of messages in corpus
+#define CORPUS_SIZE 256
+// length of contents of message, maximum of protocol
+#define CONTENTS_LEN 1400
+
+/**
+ * @brief Replaces errHandling() of client, benchmark has no program state
+ */
+int errHandling(const char* msg, int errorCode)
+{
+    fprintf(stderr, "ERR: %s\n", msg);
+    exit(errorCode);
+    return 0;
+}
+
+/**
+ * @brief Received messages of both variants with same contents
+ */
+typedef struct Corpus {
+    Buffer tcp[CORPUS_SIZE]; // "MSG FROM {DisplayName} IS {MessageContent}\r\n"
+    Buffer udp[CORPUS_SIZE]; // 0x04, MessageID, DisplayName, 0, MessageContents, 0
+    size_t contentsOffset[CORPUS_SIZE]; // start of contents in tcp message
+    size_t bytes; // number of bytes of tcp messages
+    Buffer chat[CORPUS_SIZE]; // short tcp MSG with some REPLY in between
+    size_t chatBytes; // number of bytes of chat messages
+} Corpus;
+
+/**
+ * @brief Fills contents with CONTENTS_LEN characters of words and spaces
+ */
+void generateContents(char* contents)
+{
+    const char* words[] = {"the", "server", "channel", "message", "is", "a",
+        "reply", "hello", "everyone", "joined", "of", "protocol", "to", "IPK",
+        "datagram", "and", "confirmation", "ok,", "see", "you", "tomorrow."};
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+
+    size_t used = 0;
+    while(used < CONTENTS_LEN)
+    {
+        const char* word = words[rand() % wordCount];
+        for(size_t i = 0; word[i] != '\0' && used < CONTENTS_LEN; i++)
+        {
+            contents[used++] = word[i];
+        }
+        if(used < CONTENTS_LEN) { contents[used++] = ' '; }
+    }
+    // contents cannot end with blank character
+    contents[CONTENTS_LEN - 1] = '.';
+}
+
+/**
+ * @brief Creates corpus of CORPUS_SIZE messages
+ */
+void corpusInit(Corpus* corpus)
+{
+    char contents[CONTENTS_LEN];
+    char name[32];
+    corpus->bytes = 0;
+    corpus->chatBytes = 0;
+
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        generateContents(contents);
+        int nameLen = snprintf(name, sizeof(name), "User_%d", i);
+
+        Buffer* tcp = &(corpus->tcp[i]);
+        bufferInit(tcp);
+        bufferResize(tcp, CONTENTS_LEN + 64);
+        tcp->used = (size_t) snprintf(tcp->data, tcp->allocated, "MSG FROM %s IS %.*s\r\n",
+            name, CONTENTS_LEN, contents);
+        corpus->contentsOffset[i] = sizeof("MSG FROM ") - 1 + (size_t) nameLen + sizeof(" IS ") - 1;
+        corpus->bytes += tcp->used;
+
+        Buffer* udp = &(corpus->udp[i]);
+        bufferInit(udp);
+        bufferResize(udp, CONTENTS_LEN + 64);
+        udp->data[0] = 0x04;
+        udp->data[1] = (char) (i >> 8);
+        udp->data[2] = (char) i;
+        memcpy(&(udp->data[3]), name, (size_t) nameLen + 1);
+        memcpy(&(udp->data[4 + nameLen]), contents, CONTENTS_LEN);
+        udp->data[4 + nameLen + CONTENTS_LEN] = '\0';
+        udp->used = 5 + (size_t) nameLen + CONTENTS_LEN;
+
+        Buffer* chat = &(corpus->chat[i]);
+        bufferInit(chat);
+        bufferResize(chat, CONTENTS_LEN + 64);
+        if(i % 16 == 0)
+        {
+            chat->used = (size_t) snprintf(chat->data, chat->allocated, "REPLY OK IS Joined.\r\n");
+        }
+        else
+        {
+            // chat lines have 20 to 120 characters
+            chat->used = (size_t) snprintf(chat->data, chat->allocated, "MSG FROM %s IS %.*s\r\n",
+                name, 20 + rand() % 100, contents);
+        }
+        corpus->chatBytes += chat->used;
+    }
+}
+
+/**
+ * @brief Compares implementation with scalar one for every alignment and
+ * length of short strings and every message of corpus
+ *
+ * @return int Number of differences
+ */
+int verify(const CharScanner* scanner, Corpus* corpus)
+{
+    const CharScanner* ref = &charScannerScalar;
+    const char alphabet[] = {'a', ' ', '\t', '\0', '\n', '\r', 'Z', (char) 0xC3, 0x7E, 0x7F, 0x1F};
+    char string[160];
+    int errors = 0;
+
+    for(int round = 0; round < 2000; round++)
+    {
+        // mostly one repeated character so matches are far from start
+        char common = alphabet[rand() % sizeof(alphabet)];
+        for(size_t i = 0; i < sizeof(string); i++)
+        {
+            string[i] = (rand() % 32 == 0) ? alphabet[rand() % sizeof(alphabet)] : common;
+        }
+
+        for(size_t start = 0; start < 64; start++)
+        {
+            size_t len = (size_t) rand() % (sizeof(string) - start);
+            const char* s = &(string[start]);
+            errors += scanner->findBlank(s, len) != ref->findBlank(s, len);
+            errors += scanner->findNewLine(s, len) != ref->findNewLine(s, len);
+            errors += scanner->skipBlank(s, len) != ref->skipBlank(s, len);
+            errors += scanner->findZero(s, len) != ref->findZero(s, len);
+            errors += scanner->findNotPrintable(s, len) != ref->findNotPrintable(s, len);
+        }
+    }
+
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        const char* s = corpus->tcp[i].data;
+        size_t len = corpus->tcp[i].used;
+        errors += scanner->findNewLine(s, len) != ref->findNewLine(s, len);
+        errors += scanner->findZero(corpus->udp[i].data + 3, len) !=
+            ref->findZero(corpus->udp[i].data + 3, len);
+    }
+
+    return errors;
+}
+
+/**
+ * @brief Splits every message into words like getWord(), returns number
+ * of words so work cannot be optimized out
+ */
+size_t splitWords(Corpus* corpus)
+{
+    size_t words = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        const char* s = corpus->tcp[i].data;
+        size_t len = corpus->tcp[i].used;
+        size_t index = 0;
+        while(index < len)
+        {
+            index += charScanner.skipBlank(&(s[index]), len - index);
+            size_t word = charScanner.findBlank(&(s[index]), len - index);
+            words += (word != 0);
+            index += (word != 0) ? word : 1;
+        }
+    }
+    return words;
+}
+
+/**
+ * @brief Finds end of contents of every message, returns sum of lengths
+ */
+size_t findLineEnds(Corpus* corpus)
+{
+    size_t sum = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        size_t offset = corpus->contentsOffset[i];
+        sum += charScanner.findNewLine(&(corpus->tcp[i].data[offset]), corpus->tcp[i].used - offset);
+    }
+    return sum;
+}
+
+/**
+ * @brief Validates contents of every message like controlWord() before 
+ * sending, returns sum of lengths of valid parts
+ */
+size_t validateContents(Corpus* corpus)
+{
+    size_t sum = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        size_t offset = corpus->contentsOffset[i];
+        sum += charScanner.findNotPrintable(&(corpus->tcp[i].data[offset]), CONTENTS_LEN);
+    }
+    return sum;
+}
+
+/**
+ * @brief Disassembles every tcp message, returns sum of lengths of contents
+ */
+size_t parseTCP(Corpus* corpus)
+{
+    ProtocolBlocks pBlocks = {0};
+    size_t sum = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        disassebleProtocolTCP(&(corpus->tcp[i]), &pBlocks);
+        sum += pBlocks.msg_msg_MsgContents.len;
+    }
+    return sum;
+}
+
+/**
+ * @brief Disassembles every chat message, returns sum of lengths of contents
+ */
+size_t parseChat(Corpus* corpus)
+{
+    ProtocolBlocks pBlocks = {0};
+    size_t sum = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        disassebleProtocolTCP(&(corpus->chat[i]), &pBlocks);
+        sum += (pBlocks.type == msg_REPLY) ? pBlocks.msg_reply_MsgContents.len : pBlocks.msg_msg_MsgContents.len;
+    }
+    return sum;
+}
+
+/**
+ * @brief Disassembles every udp message, returns sum of lengths of contents
+ */
+size_t parseUDP(Corpus* corpus)
+{
+    ProtocolBlocks pBlocks = {0};
+    uint16_t msgId;
+    size_t sum = 0;
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        disassebleProtocolUDP(&(corpus->udp[i]), &pBlocks, &msgId);
+        sum += pBlocks.msg_msg_MsgContents.len;
+    }
+    return sum;
+}
+
+/**
+ * @brief Runs workload over whole corpus repeatedly and returns best
+ * bytes per cycle of all rounds
+ */
+double measure(size_t (*workload)(Corpus*), Corpus* corpus, size_t bytes, size_t* check)
+{
+    double best = 0;
+    for(int round = 0; round < 1000; round++)
+    {
+        unsigned long long start = __rdtsc();
+        *check += workload(corpus);
+        unsigned long long cycles = __rdtsc() - start;
+
+        double bytesPerCycle = (double) bytes / (double) cycles;
+        if(bytesPerCycle > best) { best = bytesPerCycle; }
+    }
+    return best;
+}
+
+int main()
+{
+    srand(2024);
+
+    static Corpus corpus;
+    corpusInit(&corpus);
+
+    const CharScanner* scanners[] = {&charScannerScalar, &charScannerSse2, &charScannerAvx2};
+    const char* workloads[] = {"split words", "find line end", "validate", "parse TCP", "parse UDP", "parse chat"};
+    size_t (*functions[])(Corpus*) = {splitWords, findLineEnds, validateContents, parseTCP, parseUDP, parseChat};
+    size_t bytes[] = {corpus.bytes, corpus.bytes, corpus.bytes, corpus.bytes, corpus.bytes, corpus.chatBytes};
+    const int workloadCount = sizeof(workloads) / sizeof(workloads[0]);
+
+    printf("corpus: %d messages, %zu bytes (TCP), chat: %zu bytes, rdtsc cycles, best of 1000 rounds\n",
+        CORPUS_SIZE, corpus.bytes, corpus.chatBytes);
+    printf("%-8s", "impl");
+    for(int w = 0; w < workloadCount; w++) { printf("%15s", workloads[w]); }
+    printf("   [bytes/cycle]\n");
+
+    int failed = 0;
+    for(int s = 0; s < 3; s++)
+    {
+        if(!charScanSupported(scanners[s]))
+        {
+            printf("%-8s not supported by CPU\n", scanners[s]->name);
+            continue;
+        }
+
+        int errors = verify(scanners[s], &corpus);
+        if(errors != 0)
+        {
+            printf("%-8s %d results differ from scalar\n", scanners[s]->name, errors);
+            failed = 1;
+            continue;
+        }
+
+        charScanner = *scanners[s];
+        size_t check = 0;
+        printf("%-8s", scanners[s]->name);
+        for(int w = 0; w < workloadCount; w++)
+        {
+            printf("%15.2f", measure(functions[w], &corpus, bytes[w], &check));
+        }
+        printf("   (check %zu)\n", check);
+    }
+
+    for(int i = 0; i < CORPUS_SIZE; i++)
+    {
+        bufferDestroy(&(corpus.tcp[i]));
+        bufferDestroy(&(corpus.udp[i]));
+        bufferDestroy(&(corpus.chat[i]));
+    }
+
+    return failed;
+}
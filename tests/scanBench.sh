@@ -0,0 +1,17 @@
+#!/bin/bash
+# Builds and runs microbenchmark of searching primitives and parsers of
+# received messages (tests/scanBench.c), scalar, SSE2 and AVX2
+# implementations of CharScanner are compared in bytes per cycle.
+#
+# usage: ./tests/scanBench.sh
+# (run from root of repository)
+
+BENCH=$(mktemp)
+trap 'rm -f $BENCH' EXIT
+
+gcc -std=c17 -O2 -pthread -Isrc/libs -o $BENCH tests/scanBench.c \
+    src/libs/charScan.c src/libs/ipk24protocol.c src/libs/msgQueue.c \
+    src/libs/submitRing.c src/libs/messagePool.c src/libs/buffer.c \
+    src/libs/utils.c -lm || exit 1
+
+$BENCH
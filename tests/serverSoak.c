@@ -0,0 +1,175 @@
+/**
+ * @file serverSoak.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Test server for long UDP sessions, authenticates client and sends 
+ * it many messages one by one. Every message waits for confirmation, some
+ * of them are sended twice as if confirmation was lost. Latency of 
+ * confirmations and memory of client are printed for every block of 
+ * messages.
+ * 
+ * usage: ./serverSoak [messages] [client pid file] [pause between messages in us]
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+#include "arpa/inet.h"
+#include "sys/socket.h"
+#include "sys/time.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#define BUFFER_SIZE 512
+// every message with this period is sended once more after confirmation
+#define DUPLICATE_EVERY 10
+// number of messages after which statistics are printed
+#define BLOCK_SIZE 100000
+
+/**
+ * @brief Returns monotonic time in microseconds
+ */
+double soakNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/**
+ * @brief Returns resident memory of process in kB, 0 if it is not known
+ */
+long soakClientRss(const char* pidFile)
+{
+    FILE* file = fopen(pidFile, "r");
+    if(file == NULL) { return 0; }
+    int pid = 0;
+    if(fscanf(file, "%d", &pid) != 1) { pid = 0; }
+    fclose(file);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    file = fopen(path, "r");
+    if(file == NULL) { return 0; }
+
+    char line[256];
+    long rss = 0;
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        if(sscanf(line, "VmRSS: %ld", &rss) == 1) { break; }
+    }
+    fclose(file);
+    return rss;
+}
+
+/**
+ * @brief Sends datagram to the client and waits for its confirmation, 
+ * datagram is resended if confirmation does not come in time
+ */
+void soakSendConfirmed(int serverSocket, struct sockaddr* client, socklen_t clientSize,
+    const char* datagram, int len)
+{
+    char buffer[BUFFER_SIZE];
+    while(1)
+    {
+        sendto(serverSocket, datagram, len, 0, client, clientSize);
+        while(1)
+        {
+            int bytesRx = recv(serverSocket, buffer, BUFFER_SIZE, 0);
+            // timeout, resend
+            if(bytesRx < 0) { break; }
+            if(bytesRx >= 3 && buffer[0] == 0x00 && 
+                buffer[1] == datagram[1] && buffer[2] == datagram[2])
+            {
+                return;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    long messages = (argc > 1) ? atol(argv[1]) : 1000000;
+    const char* pidFile = (argc > 2) ? argv[2] : "";
+    long pauseMicros = (argc > 3) ? atol(argv[3]) : 0;
+
+    int serverSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in serverAddress;
+    memset(&serverAddress, 0, sizeof(serverAddress));
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    serverAddress.sin_port = htons(4567);
+    if(serverSocket < 0 || bind(serverSocket, (struct sockaddr*) &serverAddress, sizeof(serverAddress)) < 0)
+    {
+        fprintf(stderr, "ERROR: Failed to bind\n");
+        exit(1);
+    }
+
+    // wait for AUTH
+    char buffer[BUFFER_SIZE];
+    struct sockaddr_in clientAddress;
+    socklen_t clientSize = sizeof(clientAddress);
+    struct sockaddr* client = (struct sockaddr*) &clientAddress;
+    do
+    {
+        if(recvfrom(serverSocket, buffer, BUFFER_SIZE, 0, client, &clientSize) < 0)
+        {
+            fprintf(stderr, "ERROR: recvfrom\n");
+            exit(1);
+        }
+    } while(buffer[0] != 0x02);
+
+    struct timeval timeout = {1, 0};
+    setsockopt(serverSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // confirm AUTH and reply to it
+    char datagram[BUFFER_SIZE] = {0x00, buffer[1], buffer[2]};
+    sendto(serverSocket, datagram, 3, 0, client, clientSize);
+    char reply[] = {0x01, 0x00, 0x00, 0x01, buffer[1], buffer[2], 'o', 'k', 0};
+    soakSendConfirmed(serverSocket, client, clientSize, reply, sizeof(reply));
+
+    printf("messages   mean latency   max latency   client RSS\n");
+    double sum = 0, max = 0;
+    for(long i = 1; i <= messages; i++)
+    {
+        // message IDs of long session wrap around
+        uint16_t msgId = (uint16_t) i;
+        int len = snprintf(datagram, BUFFER_SIZE, "%c%c%cSoak%cmessage %ld", 
+            0x04, msgId >> 8, msgId & 0xff, 0, i) + 1;
+
+        if(pauseMicros > 0)
+        {
+            struct timespec pause = {pauseMicros / 1000000, (pauseMicros % 1000000) * 1000};
+            nanosleep(&pause, NULL);
+        }
+
+        double start = soakNow();
+        soakSendConfirmed(serverSocket, client, clientSize, datagram, len);
+        double latency = soakNow() - start;
+        sum += latency;
+        if(latency > max) { max = latency; }
+
+        // confirmation was lost, client must not print message again
+        if(i % DUPLICATE_EVERY == 0)
+        {
+            soakSendConfirmed(serverSocket, client, clientSize, datagram, len);
+        }
+
+        if(i % BLOCK_SIZE == 0 || i == messages)
+        {
+            long count = (i % BLOCK_SIZE == 0) ? BLOCK_SIZE : i % BLOCK_SIZE;
+            printf("%8ld   %9.1f us   %8.0f us   %7ld kB\n", i, sum / count, max, 
+                soakClientRss(pidFile));
+            fflush(stdout);
+            sum = 0;
+            max = 0;
+        }
+    }
+
+    // end session, client ends right after BYE is received
+    char bye[] = {(char) 0xFF, 0x00, 0x00};
+    sendto(serverSocket, bye, sizeof(bye), 0, client, clientSize);
+
+    return 0;
+}
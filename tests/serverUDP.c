@@ -14,6 +14,7 @@
 #include "stdlib.h"
 #include "string.h"
 #include "unistd.h"
+#include "time.h"
 
 
 enum errExits {BAD_HOSTNAME = 2, SENDING_FAILED, SOCKET_CREATION_FAIL, BIND_ERROR, RECEIVING_FAILED};
@@ -33,11 +34,22 @@ enum errExits {BAD_HOSTNAME = 2, SENDING_FAILED, SOCKET_CREATION_FAIL, BIND_ERRO
     }\
     printf("\n");
 
-int main()
+int main(int argc, char* argv[])
 {
     typedef enum ServerMode {DO_NOTHING, RESEND_ALL, CONFIRM_ALL, REPLY_AND_CONFIRM_ALL} ServerMode;
     int serverMode = REPLY_AND_CONFIRM_ALL;
 
+    // simulation of lossy link, percentage of received datagrams that will 
+    // be thrown away (usage: ./serverUDP [loss percentage] [service time])
+    int lossPercentage = 0;
+    if(argc > 1) { lossPercentage = atoi(argv[1]); }
+    srand(4567);
+
+    // simulation of congested server, every datagram takes service time 
+    // (in microseconds) to be processed, other datagrams wait in socket
+    long serviceMicros = 0;
+    if(argc > 2) { serviceMicros = atol(argv[2]); }
+
     // ----------------------------------------------------
     // Creating socket
     // ----------------------------------------------------
@@ -92,6 +104,19 @@ int main()
             exit(RECEIVING_FAILED);
         }
 
+        if(serviceMicros > 0)
+        {
+            struct timespec service = {serviceMicros / 1000000, (serviceMicros % 1000000) * 1000};
+            nanosleep(&service, NULL);
+        }
+
+        // simulate lost datagram
+        if(lossPercentage > 0 && (rand() % 100) < lossPercentage)
+        {
+            printf("Datagram dropped (%d bytes)\n", bytes_rx);
+            continue;
+        }
+
         int bytes_tx;
         
         
@@ -232,6 +257,12 @@ int main()
             printf("Bytes sended (%i):\n", bytes_tx);
             print_buffer(bytes_tx);
         }
+        else if(buffer[0] == 0x00) // received CONFIRM
+        {
+            // confirm is never confirmed, its ID could match ID of next 
+            // client message and that message would be confirmed instead
+            continue;
+        }
         else
         {
             if(ignoreClient) {continue;}
@@ -0,0 +1,84 @@
+#!/bin/bash
+# Measures wakeups of idle client (voluntary context switches of all its 
+# threads) and time between end of program request (/exit, SIGINT) and 
+# exit of client.
+#
+# usage: ./tests/shutdownLatency.sh [udp|tcp] [idle seconds] [client options]
+# (run from root of repository after make)
+
+PROTOCOL=${1:-udp}
+IDLE=${2:-10}
+shift $(( $# < 2 ? $# : 2 ))
+CLIENT=./ipk24chat-client
+
+SERVER=$(mktemp)
+FIFO=$(mktemp -u)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; exec 3>&-; rm -f $SERVER $FIFO' EXIT
+
+if [ "$PROTOCOL" = udp ]; then
+    gcc -o $SERVER tests/serverUDP.c || exit 1
+else
+    gcc -o $SERVER tests/serverTCP.c || exit 1
+fi
+
+# sum of voluntary context switches of all threads of process
+wakeups()
+{
+    cat /proc/$1/task/*/status 2>/dev/null | 
+        awk '/^voluntary_ctxt_switches/ { sum += $2 } END { print sum }'
+}
+
+now()
+{
+    date +%s%N
+}
+
+# starts new server (TCP server accepts only one client) and authenticated
+# client reading from fifo (descriptor 3), exits if client is not running
+start_client()
+{
+    [ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null && wait $SERVER_PID 2>/dev/null
+    $SERVER > /dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 0.2
+
+    rm -f $FIFO; mkfifo $FIFO
+    $CLIENT -t $PROTOCOL -s 127.0.0.1 "$@" < $FIFO > /dev/null 2>&1 &
+    CLIENT_PID=$!
+    exec 3> $FIFO
+    echo "/auth a sec Bot" >&3
+    sleep 0.5
+
+    if ! kill -0 $CLIENT_PID 2>/dev/null; then
+        echo "client exited before measurement" >&2
+        exit 1
+    fi
+}
+
+# waits for client and prints time since first argument in milliseconds
+wait_client()
+{
+    wait $CLIENT_PID
+    echo "$(( ($(now) - $1) / 1000000 )) ms"
+}
+
+start_client "$@"
+BEFORE=$(wakeups $CLIENT_PID)
+sleep $IDLE
+AFTER=$(wakeups $CLIENT_PID)
+echo "idle wakeups: $(( (AFTER - BEFORE) * 60 / IDLE )) per minute"
+
+START=$(now)
+echo "/exit" >&3
+echo -n "exit latency after /exit: "
+wait_client $START
+exec 3>&-
+
+start_client "$@"
+START=$(now)
+kill -INT $CLIENT_PID
+echo -n "exit latency after SIGINT: "
+wait_client $START
+exec 3>&-
+
+exit 0
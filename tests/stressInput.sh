@@ -0,0 +1,43 @@
+#!/bin/bash
+# Pipes many lines of input into client connected to local test server and 
+# checks that client ends (without hang) after end of input.
+#
+# usage: ./tests/stressInput.sh [udp|tcp] [lines] [client options]
+# (run from root of repository after make)
+
+PROTOCOL=${1:-udp}
+LINES=${2:-100000}
+shift $(( $# < 2 ? $# : 2 ))
+TIMEOUT=300
+CLIENT=./ipk24chat-client
+
+SERVER=$(mktemp)
+INPUT=$(mktemp)
+OUTPUT=$(mktemp)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; rm -f $SERVER $INPUT $OUTPUT' EXIT
+
+if [ "$PROTOCOL" = udp ]; then
+    gcc -o $SERVER tests/serverUDP.c || exit 1
+else
+    gcc -o $SERVER tests/serverTCP.c || exit 1
+fi
+$SERVER > /dev/null 2>&1 &
+SERVER_PID=$!
+sleep 0.2
+
+echo "/auth a sec Bot" > $INPUT
+seq -f "message %g" 1 $((LINES - 1)) >> $INPUT
+
+START=$(date +%s%N)
+timeout $TIMEOUT $CLIENT -t $PROTOCOL -s 127.0.0.1 "$@" < $INPUT > $OUTPUT 2>&1
+RESULT=$?
+MILLIS=$(( ($(date +%s%N) - START) / 1000000 ))
+
+if [ $RESULT = 124 ]; then
+    echo "client did not end in $TIMEOUT s (hang)"
+    exit 1
+fi
+echo "$LINES lines in $MILLIS ms, exit code $RESULT, $(grep -c "message" $OUTPUT) messages received"
+# statistics printed with --stats
+sed -n '/^Statistics:/,$p' $OUTPUT
+exit $RESULT
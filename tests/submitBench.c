@@ -0,0 +1,257 @@
+/**
+ * @file submitBench.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Benchmark of latency of producers that add messages to the sending
+ * queue while sender sends them, compares locking of queue with submit ring
+ *
+ * Sender of locked variant holds lock of queue while it calls sendto() like
+ * sender of client without submit ring, sender of ring variant moves 
+ * submitted messages to the queue and sends them after it unlocks queue.
+ *
+ * Build and run with tests/submitBench.sh
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+#include "arpa/inet.h"
+#include "sched.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "sys/socket.h"
+#include "time.h"
+#include "unistd.h"
+
+#include "submitRing.h"
+
+/**
+ * @brief Shared state of benchmark threads
+ */
+typedef struct Bench {
+    MessageQueue* queue;
+    bool useRing;
+    size_t messages; // number of messages submitted by one producer
+    int producersRunning; // accessed atomically
+    int socket;
+    struct sockaddr_in sink; // socket to which messages are sended
+} Bench;
+
+/**
+ * @brief Producer and its measured latencies
+ */
+typedef struct Producer {
+    Bench* bench;
+    long long* latencies; // nanoseconds of every submission
+} Producer;
+
+/**
+ * @brief Replaces errHandling() of client, benchmark has no program state
+ */
+int errHandling(const char* msg, int errorCode)
+{
+    fprintf(stderr, "ERR: %s\n", msg);
+    exit(errorCode);
+    return 0;
+}
+
+/**
+ * @brief Returns monotonic time in nanoseconds
+ */
+long long benchNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Submits messages and measures how long every submission took
+ */
+void* benchProducer(void* arg)
+{
+    Producer* producer = (Producer*) arg;
+    Bench* bench = producer->bench;
+
+    char data[64];
+    Buffer buffer = {.data = data, .allocated = sizeof(data), .used = 0};
+    buffer.used = (size_t) snprintf(data, sizeof(data), "xxxBot%cmessage from producer", '\0') + 1;
+    data[0] = msg_MSG;
+
+    for(size_t i = 0; i < bench->messages; i++)
+    {
+        long long start = benchNow();
+        if(bench->useRing)
+        {
+            while(!queueSubmitMessage(bench->queue, &buffer, msg_flag_NONE, msg_MSG, false))
+            {
+                sched_yield();
+            }
+        }
+        else
+        {
+            queueLock(bench->queue);
+            queueAddMessage(bench->queue, &buffer, msg_flag_NONE, msg_MSG);
+            queueUnlock(bench->queue);
+        }
+        producer->latencies[i] = benchNow() - start;
+    }
+
+    __atomic_fetch_sub(&(bench->producersRunning), 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ * @brief Sends datagram to the sink
+ */
+void benchSend(Bench* bench, const char* data, size_t len)
+{
+    if(sendto(bench->socket, data, len, 0, (struct sockaddr*) &(bench->sink), 
+        sizeof(bench->sink)) < 0)
+    {
+        errHandling("sendto() failed", 1);
+    }
+}
+
+/**
+ * @brief Sends and pops all messages until producers end
+ */
+void* benchSender(void* arg)
+{
+    Bench* bench = (Bench*) arg;
+    MessageQueue* queue = bench->queue;
+    if(bench->useRing) { submitRingSetConsumer(queue->submitRing); }
+
+    // messages sended after queue is unlocked
+    char outbox[SUBMIT_RING_CAPACITY][64];
+    size_t outboxLens[SUBMIT_RING_CAPACITY];
+
+    while(true)
+    {
+        bool producersEnded = __atomic_load_n(&(bench->producersRunning), __ATOMIC_ACQUIRE) == 0;
+
+        queueLock(queue);
+        if(bench->useRing) { submitRingDrain(queue->submitRing, queue); }
+
+        size_t staged = 0;
+        Message* msg;
+        while((msg = queueGetMessage(queue)) != NULL && staged < SUBMIT_RING_CAPACITY)
+        {
+            if(bench->useRing)
+            {
+                memcpy(outbox[staged], msg->buffer->data, msg->buffer->used);
+                outboxLens[staged] = msg->buffer->used;
+                staged += 1;
+            }
+            else
+            {
+                benchSend(bench, msg->buffer->data, msg->buffer->used);
+            }
+            queuePopMessage(queue);
+        }
+        bool empty = queueIsEmpty(queue);
+        queueUnlock(queue);
+
+        for(size_t i = 0; i < staged; i++)
+        {
+            benchSend(bench, outbox[i], outboxLens[i]);
+        }
+
+        if(producersEnded && empty) { break; }
+        if(empty) { sched_yield(); }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Compares two latencies for qsort()
+ */
+int benchCompare(const void* a, const void* b)
+{
+    long long x = *(const long long*) a;
+    long long y = *(const long long*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Runs producers and sender and prints percentiles of latency
+ */
+void benchRun(bool useRing, int producers, size_t messages)
+{
+    Bench bench = {.useRing = useRing, .messages = messages, .producersRunning = producers};
+
+    // queueDestroy() frees queue
+    bench.queue = (MessageQueue*) malloc(sizeof(MessageQueue));
+    if(bench.queue == NULL) { errHandling("Failed to allocate queue", 1); }
+    queueInit(bench.queue);
+    if(useRing)
+    {
+        bench.queue->submitRing = submitRingCreate();
+        if(bench.queue->submitRing == NULL) { errHandling("Failed to allocate ring", 1); }
+    }
+
+    // datagrams are sended to socket that never reads them
+    int sink = socket(AF_INET, SOCK_DGRAM, 0);
+    bench.sink.sin_family = AF_INET;
+    bench.sink.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bench.sink.sin_port = 0;
+    socklen_t sinkLen = sizeof(bench.sink);
+    if(sink < 0 || bind(sink, (struct sockaddr*) &(bench.sink), sizeof(bench.sink)) != 0 ||
+        getsockname(sink, (struct sockaddr*) &(bench.sink), &sinkLen) != 0)
+    {
+        errHandling("Failed to create sink socket", 1);
+    }
+    bench.socket = socket(AF_INET, SOCK_DGRAM, 0);
+
+    Producer* producerArgs = (Producer*) malloc(producers * sizeof(Producer));
+    long long* latencies = (long long*) malloc(producers * messages * sizeof(long long));
+    pthread_t* threads = (pthread_t*) malloc((producers + 1) * sizeof(pthread_t));
+    if(producerArgs == NULL || latencies == NULL || threads == NULL)
+    {
+        errHandling("Failed to allocate memory for benchmark", 1);
+    }
+
+    long long start = benchNow();
+    pthread_create(&(threads[producers]), NULL, benchSender, &bench);
+    for(int i = 0; i < producers; i++)
+    {
+        producerArgs[i].bench = &bench;
+        producerArgs[i].latencies = &(latencies[i * messages]);
+        pthread_create(&(threads[i]), NULL, benchProducer, &(producerArgs[i]));
+    }
+    for(int i = 0; i <= producers; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    long long total = benchNow() - start;
+
+    size_t count = producers * messages;
+    long long sum = 0;
+    for(size_t i = 0; i < count; i++) { sum += latencies[i]; }
+    qsort(latencies, count, sizeof(long long), benchCompare);
+
+    printf("%-6s mean %6.0f ns  p50 %6lld ns  p99 %8lld ns  p99.9 %9lld ns  max %9lld ns  total %5lld ms\n",
+        useRing ? "ring" : "lock", (double) sum / count, latencies[count / 2], 
+        latencies[count * 99 / 100], latencies[count * 999 / 1000], latencies[count - 1],
+        total / 1000000);
+
+    close(bench.socket);
+    close(sink);
+    free(threads);
+    free(latencies);
+    free(producerArgs);
+    queueDestroy(bench.queue);
+}
+
+int main(int argc, char* argv[])
+{
+    int producers = (argc > 1) ? atoi(argv[1]) : 2;
+    size_t messages = (argc > 2) ? strtoul(argv[2], NULL, 10) : 200000;
+
+    printf("%d producers, %zu messages each, latency of one submission:\n", producers, messages);
+    benchRun(false, producers, messages);
+    benchRun(true, producers, messages);
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#!/bin/bash
+# Builds and runs benchmark of latency of threads that add messages to the
+# sending queue (tests/submitBench.c), locking of queue is compared with
+# submit ring.
+#
+# usage: ./tests/submitBench.sh [producers] [messages per producer]
+# (run from root of repository)
+
+PRODUCERS=${1:-2}
+COUNT=${2:-200000}
+
+BENCH=$(mktemp)
+trap 'rm -f $BENCH' EXIT
+
+gcc -std=c17 -O2 -pthread -Isrc/libs -o $BENCH tests/submitBench.c \
+    src/libs/submitRing.c src/libs/msgQueue.c src/libs/messagePool.c \
+    src/libs/buffer.c src/libs/utils.c src/libs/charScan.c -lm || exit 1
+
+$BENCH $PRODUCERS $COUNT
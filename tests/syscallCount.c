@@ -0,0 +1,116 @@
+/**
+ * @file syscallCount.c
+ * @author Denis Fekete (xfeket01@vutbr.cz)
+ * @brief Counts system calls made by program and all its threads (like
+ * "strace -c -f"), used by tests/ioBench.sh where strace is not available
+ *
+ * Program is traced with ptrace(), every syscall entry is counted by its
+ * number. Total and syscalls used for communication are printed to stderr.
+ *
+ * usage: ./syscallCount program [arguments]
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "signal.h"
+#include "unistd.h"
+#include "sys/ptrace.h"
+#include "sys/wait.h"
+#include "sys/syscall.h"
+#include "linux/ptrace.h"
+
+// syscalls are counted by number, numbers are smaller on all architectures
+#define MAX_SYSCALL 1024
+
+/**
+ * @brief Syscalls printed separately, they are used for communication
+ */
+typedef struct NamedSyscall {
+    long number;
+    const char* name;
+} NamedSyscall;
+
+const NamedSyscall namedSyscalls[] = {
+    {SYS_read, "read"}, {SYS_write, "write"}, {SYS_readv, "readv"},
+    {SYS_sendto, "sendto"}, {SYS_recvfrom, "recvfrom"},
+    {SYS_sendmmsg, "sendmmsg"}, {SYS_recvmmsg, "recvmmsg"},
+    {SYS_poll, "poll"}, {SYS_epoll_wait, "epoll_wait"}, {SYS_futex, "futex"},
+    {SYS_io_uring_enter, "io_uring_enter"},
+};
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s program [arguments]\n", argv[0]);
+        return 1;
+    }
+
+    pid_t child = fork();
+    if(child == 0)
+    {
+        // stop before exec so tracer can set options
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP);
+        execvp(argv[1], &(argv[1]));
+        perror("execvp");
+        _exit(127);
+    }
+
+    int status;
+    waitpid(child, &status, 0);
+    ptrace(PTRACE_SETOPTIONS, child, NULL, PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE |
+        PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, child, NULL, NULL);
+
+    static unsigned long counts[MAX_SYSCALL];
+    unsigned long total = 0;
+    int exitCode = 1;
+
+    pid_t pid;
+    while((pid = waitpid(-1, &status, __WALL)) > 0)
+    {
+        if(WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            if(pid == child) { exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status); }
+            continue;
+        }
+
+        int signal = WSTOPSIG(status);
+        if(signal == (SIGTRAP | 0x80))
+        {
+            // syscall stop, count only entries
+            struct ptrace_syscall_info info;
+            if(ptrace(PTRACE_GET_SYSCALL_INFO, pid, sizeof(info), &info) > 0 &&
+                info.op == PTRACE_SYSCALL_INFO_ENTRY)
+            {
+                total++;
+                if(info.entry.nr < MAX_SYSCALL) { counts[info.entry.nr]++; }
+            }
+            signal = 0;
+        }
+        else if(signal == SIGTRAP && (status >> 16) != 0)
+        {
+            // clone, fork or exec event
+            signal = 0;
+        }
+        else if(signal == SIGSTOP)
+        {
+            // new threads start stopped
+            signal = 0;
+        }
+        ptrace(PTRACE_SYSCALL, pid, NULL, signal);
+    }
+
+    fprintf(stderr, "syscalls: %lu\n", total);
+    for(size_t i = 0; i < sizeof(namedSyscalls) / sizeof(namedSyscalls[0]); i++)
+    {
+        unsigned long count = counts[namedSyscalls[i].number];
+        if(count > 0) { fprintf(stderr, "  %s: %lu\n", namedSyscalls[i].name, count); }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,47 @@
+#!/bin/bash
+# Benchmark of UDP sliding window over lossy loopback, sends same burst of
+# messages with different window sizes (-w) to server that drops given
+# percentage of datagrams and prints delivered messages per second.
+#
+# usage: ./tests/windowBench.sh [loss percentage] [messages] [window sizes...]
+# (run from root of repository after make)
+
+LOSS=${1:-5}
+MESSAGES=${2:-2000}
+shift $(( $# < 2 ? $# : 2 ))
+WINDOWS=${@:-1 4 16 64}
+
+CLIENT=./ipk24chat-client
+SERVER=$(mktemp)
+INPUT=$(mktemp)
+OUTPUT=$(mktemp)
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID; rm -f $SERVER $INPUT $OUTPUT' EXIT
+
+gcc -o $SERVER tests/serverUDP.c || exit 1
+
+# next message is read while sending window has room, so window is the only
+# limit of sending
+echo "/auth a sec Bot" > $INPUT
+for ((m = 0; m < MESSAGES; m++)); do echo "msg $m"; done >> $INPUT
+
+echo "loss $LOSS %, $MESSAGES messages"
+for WINDOW in $WINDOWS; do
+    $SERVER $LOSS > /dev/null &
+    SERVER_PID=$!
+    sleep 0.2
+
+    START=$(date +%s%N)
+    timeout 120 $CLIENT -t udp -s 127.0.0.1 -d 100 -w $WINDOW \
+        < $INPUT > $OUTPUT 2>&1
+    ELAPSED=$(( ($(date +%s%N) - START) / 1000 ))
+
+    # server sends every message back
+    DELIVERED=$(grep -c ": msg" $OUTPUT)
+    echo "window $WINDOW: delivered $DELIVERED in $((ELAPSED / 1000)) ms," \
+        "$((DELIVERED * 1000000 / ELAPSED)) messages/s"
+
+    kill $SERVER_PID 2>/dev/null
+    wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+done
+exit 0